@@ -0,0 +1,173 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include "CodeGenerator.h"
+#include "Compiler.h"
+#include "ForthDictionary.h"
+#include "Interpreter.h"
+#include "OutputBuffer.h"
+#include "Tokenizer.h"
+#include "WordHeap.h"
+
+extern void cpush(int64_t value);
+extern int64_t cpop();
+
+// Micro benchmarks for the parts of the system that run for every word typed or loaded.
+// ForthJIT_bench --benchmark_format=json, or the bench_json target, gives results to compare between releases.
+
+namespace {
+
+void initialize() {
+    static bool done = false;
+    if (!done) {
+        code_generator_initialize();
+        OutputBuffer::instance().setLineFlush(false);
+        done = true;
+    }
+}
+
+// dictionary lookups with at least words entries
+void grow_dictionary(const int64_t words) {
+    static int64_t added = 0;
+    auto &dict = ForthDictionary::instance();
+    for (; added < words; ++added) {
+        const std::string name = "BENCH-WORD-" + std::to_string(added);
+        dict.addWord(name.c_str(), ForthState::EXECUTABLE, ForthWordType::WORD, "FORTH");
+    }
+}
+
+ForthFunction compiled(const char *name, const char *definition) {
+    auto &dict = ForthDictionary::instance();
+    if (const auto entry = dict.findWord(name)) {
+        return entry->executable;
+    }
+    Interpreter::instance().execute(definition);
+    return dict.findWord(name)->executable;
+}
+
+} // namespace
+
+
+static void BM_FindWordHit(benchmark::State &state) {
+    initialize();
+    grow_dictionary(state.range(0));
+    // an early word, the search walks past the later ones
+    const std::string name = "BENCH-WORD-" + std::to_string(state.range(0) / 10);
+    auto &dict = ForthDictionary::instance();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(dict.findWord(std::string_view(name)));
+    }
+}
+BENCHMARK(BM_FindWordHit)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_FindWordMiss(benchmark::State &state) {
+    initialize();
+    grow_dictionary(state.range(0));
+    auto &dict = ForthDictionary::instance();
+    for (auto _: state) {
+        benchmark::DoNotOptimize(dict.findWord(std::string_view("NO-SUCH-WORD")));
+    }
+}
+BENCHMARK(BM_FindWordMiss)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_Tokenize(benchmark::State &state) {
+    initialize();
+    std::string source;
+    while (source.size() < 64 * 1024) {
+        source += ": SQUARE DUP * ; 10 0 DO I SQUARE . LOOP 3.14 F. $FF 'A' EMIT \n";
+    }
+    TokenStream tokens;
+    for (auto _: state) {
+        tokens.clear();
+        Tokenizer::instance().tokenize_forth(source, tokens);
+        benchmark::DoNotOptimize(tokens.size());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * source.size()));
+}
+BENCHMARK(BM_Tokenize);
+
+static void BM_CompileDefinition(benchmark::State &state) {
+    initialize();
+    for (auto _: state) {
+        Interpreter::instance().execute(": BENCH-DEF 10 0 DO I DUP * DROP LOOP 1 2 + SWAP OVER - DROP ;");
+        // FORGET the definition again so every iteration compiles into the same dictionary
+        state.PauseTiming();
+        Interpreter::instance().execute("FORGET");
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_CompileDefinition);
+
+static void BM_CompileLet(benchmark::State &state) {
+    initialize();
+    for (auto _: state) {
+        Interpreter::instance().execute(
+            ": BENCH-LET LET (r) = FN(a, b) = sqrt( a * a + b * b ) + c WHERE c = a * 0.5 ;");
+        state.PauseTiming();
+        Interpreter::instance().execute("FORGET");
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_CompileLet);
+
+// 1000 DUP SWAP + in a loop, less the loop itself measured by BM_DoLoop
+static void BM_Primitives(benchmark::State &state) {
+    initialize();
+    const auto fn = compiled("BENCH-PRIMS", ": BENCH-PRIMS 1 1000 0 DO DUP SWAP + LOOP DROP ;");
+    for (auto _: state) {
+        fn();
+    }
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_Primitives);
+
+static void BM_DoLoop(benchmark::State &state) {
+    initialize();
+    const auto fn = compiled("BENCH-LOOP", ": BENCH-LOOP 1000 0 DO LOOP ;");
+    for (auto _: state) {
+        fn();
+    }
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_DoLoop);
+
+static void BM_Emit(benchmark::State &state) {
+    initialize();
+    const auto fn = compiled("BENCH-EMIT", ": BENCH-EMIT 1000 0 DO 42 EMIT LOOP ;");
+    auto &out = OutputBuffer::instance();
+    for (auto _: state) {
+        fn();
+        out.pos = 0; // discard rather than write to the terminal
+    }
+    state.SetBytesProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_Emit);
+
+static void BM_Type(benchmark::State &state) {
+    initialize();
+    static const std::string text(1000, '*');
+    const auto type = ForthDictionary::instance().findWord("TYPE")->executable;
+    auto &out = OutputBuffer::instance();
+    for (auto _: state) {
+        cpush(reinterpret_cast<int64_t>(text.data()));
+        cpush(static_cast<int64_t>(text.size()));
+        type();
+        out.pos = 0;
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_Type);
+
+static void BM_WordHeapAllocate(benchmark::State &state) {
+    initialize();
+    auto &heap = WordHeap::instance();
+    const auto size = static_cast<size_t>(state.range(0));
+    uint64_t id = 1ULL << 40; // clear of the ids real words use
+    for (auto _: state) {
+        benchmark::DoNotOptimize(heap.allocate(id, size));
+        heap.deallocate(id);
+        ++id;
+    }
+}
+BENCHMARK(BM_WordHeapAllocate)->Arg(16)->Arg(512)->Arg(64 * 1024);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,15 @@
+\ Fibonacci, recursive calls and a tight iterative loop
+
+: FIB ( n -- fib )
+    DUP 2 < IF EXIT THEN
+    DUP 1 - RECURSE SWAP 2 - RECURSE + ;
+
+: FIB-ITER ( n -- fib )
+    0 1 ROT 0 DO OVER + SWAP LOOP DROP ;
+
+: BENCH-FIB 24 FIB DROP ;
+
+: BENCH-FIB-ITER 1000 0 DO 40 FIB-ITER DROP LOOP ;
+
+20 TIMEIT BENCH-FIB \ code FIB
+50 TIMEIT BENCH-FIB-ITER \ code FIB-ITER
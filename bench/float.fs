@@ -0,0 +1,17 @@
+\ LET kernels, a Mandelbrot iteration inside the set and a distance
+
+: MSTEP LET
+    (re, im) = FN(zr, zi) =
+    nre, nim
+    WHERE nre = (zr * zr) - (zi * zi) - 0.5
+    WHERE nim = (2 * zr * zi) + 0.1 ;
+
+: DIST
+    LET (d) = FN(x1, y1, x2, y2) = sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1)) ;
+
+: BENCH-MANDEL 0.0 0.0 10000 0 DO MSTEP LOOP DROP DROP ;
+
+: BENCH-DIST 10000 0 DO 1.0 2.0 4.0 6.0 DIST DROP LOOP ;
+
+50 TIMEIT BENCH-MANDEL \ code MSTEP
+50 TIMEIT BENCH-DIST \ code DIST
@@ -0,0 +1,24 @@
+\ 32 x 32 integer matrix multiply, C = A B
+
+VARIABLE MA 8192 ALLOT
+VARIABLE MB 8192 ALLOT
+VARIABLE MC 8192 ALLOT
+
+: MINIT 1024 0 DO I 7 MOD I 8 * MA + ! I 5 MOD I 8 * MB + ! LOOP ;
+
+\ I is k, J is j and K is i in the innermost loop
+: MMUL
+    32 0 DO
+        32 0 DO
+            0
+            32 0 DO
+                K 32 * I + 8 * MA + @
+                I 32 * J + 8 * MB + @ * +
+            LOOP
+            J 32 * I + 8 * MC + !
+        LOOP
+    LOOP ;
+
+MINIT
+
+50 TIMEIT MMUL
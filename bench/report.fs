@@ -0,0 +1,9 @@
+\ EMIT heavy report, numbers and rules through the output buffer
+
+: RULE ( n -- ) 0 DO 45 EMIT LOOP ;
+
+: ROW ( n -- ) DUP . DUP DUP * . 124 EMIT 60 RULE CR DROP ;
+
+: REPORT 200 0 DO I ROW LOOP ;
+
+20 TIMEIT REPORT \ code REPORT ROW RULE
@@ -0,0 +1,119 @@
+#!/bin/sh
+# Runs each bench/*.fs program in script mode with the optimizer off and on, collects the
+# TIMEIT JSON lines and compares the median time of each word against baseline.txt.
+#
+#   run.sh <ForthJIT> [results file] [--update]
+#
+# A word more than BENCH_TOLERANCE percent (default 25) slower than its baseline fails the run.
+# Code that has grown is reported but does not fail. --update writes the results as the new baseline.
+#
+# The code size is that of the words named after "\ code" on the TIMEIT line, the kernels a BENCH-
+# word calls, or of the timed word itself without one.
+
+FORTH=$1
+RESULTS=${2:-bench-results.txt}
+UPDATE=$3
+TOLERANCE=${BENCH_TOLERANCE:-25}
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+BASELINE=$BENCH_DIR/baseline.txt
+
+if [ ! -x "$FORTH" ]; then
+    echo "usage: run.sh <ForthJIT> [results file] [--update]" >&2
+    exit 2
+fi
+
+status=0
+: > "$RESULTS"
+for program in "$BENCH_DIR"/*.fs; do
+    name=$(basename "$program" .fs)
+    for optimize in OFF ON; do
+        output=$( { printf 'SET OPTIMIZE %s\nSET TIMEITJSON ON\n' "$optimize"; cat "$program"; echo 'SHOW COMPILER_JSON'; } |
+            "$FORTH" 2>&1 )
+        if [ $? -ne 0 ]; then
+            echo "$name: failed with OPTIMIZE $optimize" >&2
+            echo "$output" | tail -5 >&2
+            status=1
+            continue
+        fi
+        # TIMEIT gives {"word":"SIEVE","runs":50,"warmups":10,"bytes":412,"ns":{"min":..,"median":..
+        # SHOW COMPILER_JSON gives {"word":"SIEVE","ns":{"tokenize":..},"bytes":412,.. for each definition
+        echo "$output" | awk -v prefix="$name:" -v optimize="$optimize" -v program="$program" '
+            function field(line, key,    at, value) {
+                at = index(line, "\"" key "\":")
+                if (at == 0) return ""
+                value = substr(line, at + length(key) + 3)
+                sub(/[^0-9.].*/, "", value)
+                return value
+            }
+            BEGIN {
+                while ((getline line < program) > 0) {
+                    n = split(line, f, " ")
+                    for (i = 1; i < n; ++i) {
+                        if (f[i] != "TIMEIT") continue
+                        code[f[i + 1]] = f[i + 1]
+                        if (f[i + 2] == "\\" && f[i + 3] == "code") {
+                            code[f[i + 1]] = ""
+                            for (j = i + 4; j <= n; ++j) code[f[i + 1]] = code[f[i + 1]] " " f[j]
+                        }
+                    }
+                }
+            }
+            index($0, "{\"word\":\"") == 1 {
+                word = substr($0, 10)
+                sub(/".*/, "", word)
+                if (index($0, "\"ns\":{\"tokenize\"")) {
+                    bytes[word] = field($0, "bytes")
+                } else if (index($0, "\"median\"")) {
+                    timed[++count] = word
+                    ns[count] = field($0, "median")
+                }
+            }
+            END {
+                for (i = 1; i <= count; ++i) {
+                    total = 0
+                    n = split(code[timed[i]] ? code[timed[i]] : timed[i], kernels, " ")
+                    for (j = 1; j <= n; ++j) total += bytes[kernels[j]]
+                    print prefix timed[i] " " optimize " " ns[i] " " total
+                }
+            }
+        ' >> "$RESULTS"
+    done
+done
+
+if [ "$UPDATE" = "--update" ]; then
+    {
+        echo "# bench/run.sh baseline: program:word optimizer median-ns code-bytes"
+        cat "$RESULTS"
+    } > "$BASELINE"
+    echo "Baseline updated, $(wc -l < "$RESULTS" | tr -d ' ') results"
+    exit $status
+fi
+
+# without a baseline every word would pass as "no baseline"
+if [ "$(awk '$0 !~ /^#/ && NF == 4' "$BASELINE" 2>/dev/null | wc -l)" -eq 0 ]; then
+    echo "$BASELINE has no results, record them on this machine with --update (the bench_baseline target)" >&2
+    exit 1
+fi
+
+awk -v tolerance="$TOLERANCE" '
+    FNR == NR {
+        if ($0 !~ /^#/ && NF == 4) { ns[$1 " " $2] = $3; bytes[$1 " " $2] = $4 }
+        next
+    }
+    {
+        key = $1 " " $2
+        printf "%-28s %-4s %14.1f ns %7d bytes", $1, $2, $3, $4
+        if (key in ns && ns[key] > 0) {
+            change = ($3 - ns[key]) * 100 / ns[key]
+            printf " %+7.1f%%", change
+            if (change > tolerance) { printf "  SLOWER"; failed = 1 }
+            if ($4 > bytes[key]) printf "  code grew from %d", bytes[key]
+        } else {
+            printf "  no baseline"
+        }
+        printf "\n"
+    }
+    END { exit failed }
+' "$BASELINE" "$RESULTS" || status=1
+
+exit $status
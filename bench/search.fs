@@ -0,0 +1,25 @@
+\ Naive string search for a pattern near the end of a 4096 character text
+
+VARIABLE TEXT 4104 ALLOT
+VARIABLE PAT
+VARIABLE PATLEN
+
+: MAKE-TEXT TEXT 4096 97 FILL 98 TEXT 4090 + C! ;
+
+: SET-PATTERN S" aaaab" PATLEN ! PAT ! ;
+
+: MATCHES ( addr -- addr flag )
+    -1 PATLEN @ 0 DO
+        OVER I + C@ PAT @ I + C@ = AND
+    LOOP ;
+
+: SEARCH-TEXT ( -- offset )
+    -1 4097 PATLEN @ - 0 DO
+        TEXT I + MATCHES NIP IF DROP I LEAVE THEN
+    LOOP ;
+
+: BENCH-SEARCH SEARCH-TEXT DROP ;
+
+MAKE-TEXT SET-PATTERN
+
+50 TIMEIT BENCH-SEARCH \ code SEARCH-TEXT MATCHES
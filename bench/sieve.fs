@@ -0,0 +1,22 @@
+\ Sieve of Eratosthenes over 8191 flags, the classic BYTE benchmark, 1899 primes
+
+VARIABLE FLAGS 8192 ALLOT
+
+: SIEVE ( -- count )
+    FLAGS 8191 1 FILL
+    0
+    8191 0 DO
+        FLAGS I + C@ IF
+            I 2 * 3 +
+            DUP I +
+            BEGIN DUP 8191 < WHILE
+                0 OVER FLAGS + C!
+                OVER +
+            REPEAT
+            2DROP 1 +
+        THEN
+    LOOP ;
+
+: BENCH-SIEVE SIEVE DROP ;
+
+50 TIMEIT BENCH-SIEVE \ code SIEVE
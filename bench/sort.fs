@@ -0,0 +1,47 @@
+\ Bubble sort and quicksort over an array of 1000 cells
+
+VARIABLE DATA 8008 ALLOT
+VARIABLE SEED
+VARIABLE PIVOT
+VARIABLE STORE-AT
+
+: CELL ( i -- addr ) 8 * DATA + ;
+
+: RANDOM ( -- n ) SEED @ 1103515245 * 12345 + 2147483647 AND DUP SEED ! ;
+
+: FILL-DATA ( n -- ) 12345 SEED ! 0 DO RANDOM 1000 MOD I CELL ! LOOP ;
+
+: EXCHANGE ( a1 a2 -- ) 2DUP @ SWAP @ ROT ! SWAP ! ;
+
+: BUBBLE ( n -- )
+    DUP 1 DO
+        DUP I - 0 DO
+            I CELL @ I 1 + CELL @ 2DUP > IF I CELL ! I 1 + CELL ! ELSE 2DROP THEN
+        LOOP
+    LOOP DROP ;
+
+: PARTITION ( lo hi -- lo hi p )
+    DUP CELL @ PIVOT !
+    OVER STORE-AT !
+    2DUP SWAP DO
+        I CELL @ PIVOT @ < IF
+            I CELL STORE-AT @ CELL EXCHANGE
+            STORE-AT @ 1 + STORE-AT !
+        THEN
+    LOOP
+    DUP CELL STORE-AT @ CELL EXCHANGE
+    STORE-AT @ ;
+
+: QSORT ( lo hi -- )
+    2DUP < IF
+        PARTITION
+        ROT OVER 1 - RECURSE
+        1 + SWAP RECURSE
+    ELSE 2DROP THEN ;
+
+: BENCH-BUBBLE 300 FILL-DATA 300 BUBBLE ;
+
+: BENCH-QSORT 1000 FILL-DATA 0 999 QSORT ;
+
+20 TIMEIT BENCH-BUBBLE \ code BUBBLE CELL
+50 TIMEIT BENCH-QSORT \ code QSORT PARTITION EXCHANGE CELL
@@ -0,0 +1,86 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include "Singleton.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Buffers for BLOCK, BUFFER, UPDATE, SAVE-BUFFERS and FLUSH.
+// The block file is mapped shared, a block is copied into a buffer when it is first used and
+// copied back, with an asynchronous msync, when its buffer is saved or reused.
+// Buffers are replaced with the CLOCK policy when TRACKLRU is on, in turn when it is off.
+class BlockCache : public Singleton<BlockCache> {
+    friend class Singleton<BlockCache>;
+
+public:
+    static constexpr const char *DEFAULT_FILE = "blocks.fb";
+    static constexpr size_t DEFAULT_BUFFERS = 64;
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1024;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t writes = 0;
+    };
+
+    // use a different block file, saving the buffers of the old one
+    bool open(const std::string &path);
+
+    // n buffers of size bytes, 1024 or 4096, saving and dropping the current buffers
+    bool configure(size_t buffers, size_t size);
+
+    // address of the buffer holding block n, read from the file unless readBlock is false
+    char *block(uint64_t n, bool readBlock = true);
+
+    // mark the most recently used buffer as changed
+    void update();
+
+    // write every changed buffer back to the file
+    bool saveBuffers();
+
+    // forget every buffer without saving it
+    void emptyBuffers();
+
+    [[nodiscard]] size_t blockSize() const { return size; }
+    [[nodiscard]] const Stats &stats() const { return counts; }
+    void display() const;
+
+private:
+    BlockCache() = default;
+    ~BlockCache() override;
+
+    static constexpr uint64_t NO_BLOCK = UINT64_MAX;
+
+    struct Buffer {
+        uint64_t block = NO_BLOCK;
+        bool dirty = false;
+        bool referenced = false;
+    };
+
+    bool ensureOpen();
+    bool ensureMapped(uint64_t n);
+    bool writeBack(Buffer &buffer, size_t index);
+    size_t victim();
+    void release();
+
+    std::string path;
+    int fd = -1;
+    char *map = nullptr;
+    size_t mapped = 0; // address space reserved for the file
+    size_t fileSize = 0;
+
+    size_t count = DEFAULT_BUFFERS;
+    size_t size = DEFAULT_BLOCK_SIZE;
+    std::vector<Buffer> buffers;
+    std::unordered_map<uint64_t, size_t> resident; // block number to buffer
+    std::vector<char> memory;
+    size_t hand = 0; // the clock hand
+    size_t current = 0; // buffer returned by the last BLOCK or BUFFER
+    bool hasCurrent = false;
+    Stats counts;
+};
+
+#endif // BLOCK_CACHE_H
@@ -0,0 +1,50 @@
+#ifndef CALL_COUNTERS_H
+#define CALL_COUNTERS_H
+
+#include "Singleton.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+
+// Per word statistics for SET COUNTERS ON and SHOW STATS.
+// Words compiled with counters on count their calls, the highest data stack depth they were called at
+// and, for the outermost call of a recursive word only, the cycles spent inside including the words
+// they call. The generated code updates the record directly, the records never move.
+struct WordStats {
+    uint64_t calls = 0;
+    uint64_t cycles = 0;
+    uint64_t start = 0; // time stamp of the outermost call in progress
+    uint64_t depth = 0; // calls in progress, more than one when recursing
+    uint64_t stackHigh = 0; // in bytes
+};
+
+class CallCounters : public Singleton<CallCounters> {
+    friend class Singleton<CallCounters>;
+
+public:
+    // a record for a function about to be compiled
+    WordStats *add(const std::string &name);
+
+    // the most called word compiled under this name, nullptr if there is none
+    [[nodiscard]] const WordStats *find(const std::string &name) const;
+
+    // an error abandons calls in progress, forget them so timing continues
+    void resetDepths();
+
+    void clear();
+
+    void display(size_t rows = 30) const;
+
+private:
+    CallCounters() = default;
+    ~CallCounters() override = default;
+
+    struct Entry {
+        WordStats stats;
+        std::string name;
+    };
+
+    std::deque<Entry> entries;
+};
+
+#endif // CALL_COUNTERS_H
@@ -16,10 +16,13 @@ bool initialize_assembler(asmjit::x86::Assembler *&assembler);
 
 void code_generator_initialize();
 
-ForthFunction code_generator_build_forth(ForthFunction fn);
+ForthFunction code_generator_build_forth(const std::string &name, ForthFunction fn);
 
 void code_generator_startFunction(const std::string &name);
 
+struct TieredWord;
+void code_generator_startFunction(const std::string &name, const ForthDictionaryEntry *frame, TieredWord *tiered);
+
 void compile_return();
 
 ForthFunction code_generator_finalizeFunction(const std::string &name);
@@ -36,6 +39,8 @@ void compile_call_C(void (*func)());
 
 void compile_call_forth(void (*func)(), const std::string &forth_word);
 
+void compile_call_deferred(const ForthDictionaryEntry *word, const std::string &forth_word);
+
 void compile_call_C_char(void (*func)(char*));
 
 void stack_self();
@@ -0,0 +1,47 @@
+#ifndef CODE_INDEX_H
+#define CODE_INDEX_H
+
+#include "Singleton.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The address range of every function the JIT has finalized, with the name it was compiled under.
+// Used to turn an instruction pointer back into a word, e.g. by the profiler.
+class CodeIndex : public Singleton<CodeIndex> {
+    friend class Singleton<CodeIndex>;
+
+public:
+    struct Range {
+        uintptr_t start;
+        uintptr_t end;
+        std::string name;
+    };
+
+    void add(const void *code, size_t size, const std::string &name);
+
+    // the function at start was released, asmjit will hand its addresses out again
+    void remove(uintptr_t start);
+
+    // the function holding addr, nullptr if it is not JIT code
+    const Range *find(uintptr_t addr);
+
+    // true if addr lies anywhere in JIT code, a quick check before find
+    [[nodiscard]] bool contains(const uintptr_t addr) const {
+        return addr >= lowest && addr < highest;
+    }
+
+    [[nodiscard]] size_t size() const { return ranges.size(); }
+
+private:
+    CodeIndex() = default;
+    ~CodeIndex() override = default;
+
+    std::vector<Range> ranges;
+    bool sorted = true;
+    uintptr_t lowest = UINTPTR_MAX;
+    uintptr_t highest = 0;
+};
+
+#endif // CODE_INDEX_H
@@ -0,0 +1,62 @@
+#ifndef CODE_LISTING_H
+#define CODE_LISTING_H
+
+#include "Singleton.h"
+#include "asmjit/asmjit.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The assembly listing of each function, kept for SEE when SET LISTING ON.
+// asmjit formats the instructions it encodes but cannot decode them again, so the listing is
+// captured through a logger as the code is generated, with the offset of each line.
+struct ListingLine {
+    uint32_t offset; // where the next instruction starts
+    std::string text;
+};
+
+class ListingLogger final : public asmjit::Logger {
+public:
+    // lines logged from now on belong to the function assembler is generating
+    void begin(const asmjit::x86::Assembler *newAssembler) {
+        assembler = newAssembler;
+        lines.clear();
+    }
+
+    // also send everything to the LOGGING output
+    void setForward(asmjit::Logger *logger) { forward = logger; }
+
+    asmjit::Error _log(const char *data, size_t size) noexcept override;
+
+    std::vector<ListingLine> lines;
+
+private:
+    const asmjit::x86::Assembler *assembler = nullptr;
+    asmjit::Logger *forward = nullptr;
+};
+
+class CodeListing : public Singleton<CodeListing> {
+    friend class Singleton<CodeListing>;
+
+public:
+    void add(const void *code, std::vector<ListingLine> lines);
+
+    // the function at code was released, new code at the address must not show its listing
+    void remove(const void *code);
+
+    // the listing of the function starting at code, nullptr if it was compiled without one
+    [[nodiscard]] const std::vector<ListingLine> *find(const void *code) const;
+
+    // the listing, or a hex dump without one, with profile samples against each instruction
+    void display(const void *code, size_t size) const;
+
+private:
+    CodeListing() = default;
+    ~CodeListing() override = default;
+
+    std::unordered_map<uintptr_t, std::vector<ListingLine>> listings;
+};
+
+#endif // CODE_LISTING_H
@@ -0,0 +1,69 @@
+#ifndef COMPILE_STATS_H
+#define COMPILE_STATS_H
+
+#include "Singleton.h"
+#include "Tokenizer.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+
+struct ForthDictionaryEntry;
+
+// Where the time and the code went for one definition, kept for SHOW COMPILER.
+// Tokenize time is the time to tokenize the source the definition arrived in, a line
+// or a definition in a script, and is counted against the first definition in it.
+struct CompileStats {
+    uint64_t tokenizeNs = 0;
+    uint64_t optimizeNs = 0;
+    uint64_t codegenNs = 0;
+    uint64_t finalizeNs = 0;
+    uint64_t codeBytes = 0;
+    uint32_t calls = 0; // calls to other words emitted
+    uint32_t inlined = 0; // words whose code was generated in place
+    uint32_t spills = 0; // LET registers spilled to memory
+    uint32_t rules[static_cast<size_t>(OptOp::COUNT)] = {}; // peephole rules applied, by result
+
+    [[nodiscard]] uint64_t totalNs() const { return tokenizeNs + optimizeNs + codegenNs + finalizeNs; }
+};
+
+class CompilerStats : public Singleton<CompilerStats> {
+    friend class Singleton<CompilerStats>;
+
+public:
+    // the source just tokenized took ns, claimed by the next definition
+    void tokenized(const uint64_t ns) { tokenizeNs = ns; }
+
+    // start recording a new definition
+    CompileStats &begin();
+
+    // the definition being compiled, calls and inlined words are counted here
+    CompileStats &current() { return pending; }
+
+    // keep the record and hang it on the dictionary entry
+    void end(const std::string &name, ForthDictionaryEntry *entry);
+
+    // the latest definition of name, nullptr if it has none
+    [[nodiscard]] const CompileStats *find(const std::string &name) const;
+
+    void display(size_t rows = 30) const;
+
+    void display(const std::string &name) const;
+
+    // one JSON object per line for each definition
+    void dump() const;
+
+private:
+    CompilerStats() = default;
+    ~CompilerStats() override = default;
+
+    struct Entry {
+        CompileStats stats;
+        std::string name;
+    };
+
+    CompileStats pending;
+    uint64_t tokenizeNs = 0;
+    std::deque<Entry> entries;
+};
+
+#endif // COMPILE_STATS_H
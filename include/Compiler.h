@@ -1,10 +1,12 @@
 #ifndef COMPILER_H
 #define COMPILER_H
 
-#include <deque>
 #include <string>
 #include "Singleton.h"
 #include "Tokenizer.h"
+#include "ForthDictionaryEntry.h"
+
+struct TieredWord;
 
 class Compiler : public Singleton<Compiler> {
     // The Singleton template will manage instance creation
@@ -14,7 +16,15 @@ public:
     void compile_let(const std::string &input);
 
     // Main compile entry point
-    void compile_words(std::deque<ForthToken> &input_tokens);
+    void compile_words(TokenStream &input_tokens);
+
+    // compile a tier 0 word with the optimizer, nullptr if it can not be done now
+    ForthFunction recompile(const TieredWord &word);
+
+    [[nodiscard]] bool compiling() const { return busy; }
+
+    // after an error, nothing is being compiled
+    void reset() { busy = false; }
 
 private:
     // Constructor and destructor are private to enforce Singleton behavior
@@ -22,15 +32,21 @@ private:
     ~Compiler() = default;
 
     // Utility and helper methods
-    void validate_compiler_state(std::deque<ForthToken> &tokens);
-    std::string extract_word_name(std::deque<ForthToken> &tokens);
+    void validate_compiler_state(TokenStream &tokens);
+    std::string extract_word_name(TokenStream &tokens);
 
     // Token processing
-    void process_token(const ForthToken &token, std::deque<ForthToken> &tokens, std::string &word_name);
+    void process_token(const ForthToken &token, TokenStream &tokens, std::string &word_name);
     void compile_token_number(const ForthToken &token);
     void compile_token_float(const ForthToken &token);
-    void compile_token_word(const ForthToken &token, std::deque<ForthToken> &tokens, std::string &word_name);
-    void compile_token_optimized(const ForthToken &token, std::deque<ForthToken> &tokens);
+    void compile_token_word(const ForthToken &token, TokenStream &tokens, std::string &word_name);
+    void compile_token_optimized(const ForthToken &token, TokenStream &tokens);
+
+    // optimizer output, reused for each definition
+    TokenStream optimized;
+
+    // compiling a definition, a word that gets hot meanwhile waits
+    bool busy = false;
 };
 
 #endif // COMPILER_H
\ No newline at end of file
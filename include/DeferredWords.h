@@ -0,0 +1,62 @@
+#ifndef DEFERRED_WORDS_H
+#define DEFERRED_WORDS_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Singleton.h"
+
+struct ForthDictionaryEntry;
+typedef void (*ForthFunction)();
+
+// a call rel32 in compiled code, owner is the word it was compiled into, nullptr until that word is added
+struct CallSite {
+    uint8_t *rel32;
+    const ForthDictionaryEntry *owner;
+};
+
+// A DEFER word is called directly, each call site is recorded and IS patches them all to the new action.
+// The thunk jumps through action, it is the word's execution token and the way to an action out of rel32 reach.
+struct DeferredWord {
+    ForthDictionaryEntry *entry = nullptr;
+    ForthFunction action = nullptr;
+    ForthFunction thunk = nullptr;
+    std::vector<CallSite> sites;
+};
+
+class DeferredWords : public Singleton<DeferredWords> {
+    friend class Singleton<DeferredWords>;
+
+public:
+    // the entry stays where it is, the thunk may point into it
+    DeferredWord &add(ForthDictionaryEntry *entry, ForthFunction action);
+
+    [[nodiscard]] DeferredWord *deferred(const ForthDictionaryEntry *entry);
+
+    // the execution token ' and ['] give, the thunk for a deferred word so it follows IS
+    [[nodiscard]] ForthFunction xt(const ForthDictionaryEntry *entry);
+
+    // rel32 is the displacement of a call just compiled, it is patched to the current action
+    void addSite(const ForthDictionaryEntry *word, uint8_t *rel32);
+
+    // owner is the word the sites added since the last claim were compiled into
+    void claimSites(const ForthDictionaryEntry *owner);
+
+    // IS
+    void retarget(ForthDictionaryEntry *entry, ForthFunction action);
+
+    // FORGET entry, drops the call sites in it, true when entry was itself deferred
+    bool forget(const ForthDictionaryEntry *entry);
+
+    void display() const;
+
+private:
+    DeferredWords() = default;
+    ~DeferredWords() override = default;
+
+    static bool patch(uint8_t *rel32, const DeferredWord &word);
+
+    std::unordered_map<const ForthDictionaryEntry *, DeferredWord> words;
+};
+
+#endif // DEFERRED_WORDS_H
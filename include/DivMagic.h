@@ -0,0 +1,35 @@
+#ifndef DIV_MAGIC_H
+#define DIV_MAGIC_H
+
+#include <cstdint>
+
+// Division by a constant as a multiply by its reciprocal, the method of Granlund and Montgomery
+// as given in Hacker's Delight. The code generator uses it for / MOD /MOD U/ UMOD and */ by a number.
+
+// n / d is the high half of multiplier * n, corrected by n when the multiplier's sign is wrong,
+// shifted right by shift, plus one when that is negative
+struct SignedMagic {
+    int64_t multiplier;
+    int shift;
+};
+
+// n / d is the high half of multiplier * n shifted right by shift,
+// when add is set the multiplier needs 65 bits and n is added back in first
+struct UnsignedMagic {
+    uint64_t multiplier;
+    int shift;
+    bool add;
+};
+
+// |d| at least 2
+SignedMagic signed_magic(int64_t d);
+
+// d at least 2
+UnsignedMagic unsigned_magic(uint64_t d);
+
+// the quotient the generated code computes, rounded toward zero as idiv does, d must not be 0
+int64_t signed_quotient(int64_t n, int64_t d);
+
+uint64_t unsigned_quotient(uint64_t n, uint64_t d);
+
+#endif // DIV_MAGIC_H
@@ -0,0 +1,91 @@
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include "Singleton.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/uio.h>
+
+// File words, OPEN-FILE READ-FILE WRITE-FILE etc.
+// A file id is the file descriptor, errors are returned as an ior (errno), 0 for success.
+// Each file keeps its own position, reads and writes use pread/pwrite at that position so an
+// asynchronous read can claim the next chunk of the file as soon as it is submitted.
+// On Linux asynchronous reads go through an io_uring, elsewhere, or when the kernel refuses one,
+// a pair of worker threads run them with pread.
+class FileIO : public Singleton<FileIO> {
+    friend class Singleton<FileIO>;
+
+public:
+    // file access methods for R/O W/O R/W
+    static constexpr int64_t READ_ONLY = 0;
+    static constexpr int64_t WRITE_ONLY = 1;
+    static constexpr int64_t READ_WRITE = 2;
+
+    static constexpr size_t MAX_REQUESTS = 64;
+    static constexpr size_t WORKERS = 2;
+
+    int64_t openFile(const std::string &path, int64_t fam, bool create, int64_t &ior);
+
+    // reads still queued on the file are cancelled and reads in progress waited for before it is closed
+    int64_t closeFile(int64_t fileId);
+
+    int64_t readFile(int64_t fileId, void *buffer, uint64_t len, int64_t &ior);
+
+    int64_t writeFile(int64_t fileId, const void *buffer, uint64_t len);
+
+    int64_t fileSize(int64_t fileId, int64_t &ior);
+
+    // queue a read of the next len bytes, returns a request id, 0 if none are free
+    int64_t readAsync(int64_t fileId, void *buffer, uint64_t len);
+
+    // wait for a request, returns the bytes read or a negative errno
+    int64_t await(int64_t request);
+
+private:
+    FileIO() = default;
+    ~FileIO() override;
+
+    struct Request {
+        int fd = -1;
+        void *buffer = nullptr;
+        uint64_t len = 0;
+        off_t offset = 0;
+        int64_t result = 0;
+        bool busy = false; // submitted and not yet awaited
+        bool done = false;
+        iovec iov{}; // the io_uring reads from this until the read completes
+    };
+
+    // the io_uring, set up on the first asynchronous read
+    struct Ring;
+
+    void startWorkers();
+    void worker();
+
+    bool startRing();
+    void submit(size_t slot);
+    // take the completed reads off the ring, waiting for one if none are there and wait is set
+    void reap(bool wait);
+    // until requests[slot] is done, called with lock held
+    void waitFor(std::unique_lock<std::mutex> &guard, size_t slot);
+
+    std::unordered_map<int, off_t> positions;
+
+    Request requests[MAX_REQUESTS];
+    std::deque<size_t> queue;
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable submitted;
+    std::condition_variable completed;
+    bool stopping = false;
+    Ring *ring = nullptr;
+    bool ringTried = false;
+};
+
+#endif // FILE_IO_H
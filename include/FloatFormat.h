@@ -0,0 +1,24 @@
+#ifndef FLOAT_FORMAT_H
+#define FLOAT_FORMAT_H
+
+#include <cstddef>
+
+// Double to text for F. FE. FS. and (F.)
+// Digits are the shortest that read back as the same double (Grisu2).
+
+enum class FloatStyle {
+    GENERAL,     // F.  fixed point, scientific for very large or small numbers
+    SCIENTIFIC,  // FS. one digit before the point, e.g. 1.5E3
+    ENGINEERING  // FE. exponent a multiple of 3, e.g. 1.5E3 is 1500, 15E-3 is 0.015
+};
+
+// longest text format_float writes
+constexpr size_t FLOAT_TEXT_MAX = 40;
+
+// shortest digits of a finite positive value, value = digits * 10^exponent, returns the digit count
+int float_shortest_digits(double value, char *digits, int &exponent);
+
+// write value to out, with at most precision significant digits when precision > 0
+size_t format_float(double value, FloatStyle style, int precision, char *out);
+
+#endif // FLOAT_FORMAT_H
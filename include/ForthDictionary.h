@@ -3,6 +3,7 @@
 
 #include <memory>      // For std::unique_ptr
 #include <string>      // For std::string
+#include <string_view> // For std::string_view
 #include <vector>      // For std::vector
 #include <unordered_map> // For std::unordered_map
 #include <array>       // For std::array
@@ -52,7 +53,9 @@ public:
     // Find a word in the dictionary using the search order
     ForthDictionaryEntry* findWord(const char* name) const;
 
-    bool isVariable(const char *name) const;
+    ForthDictionaryEntry* findWord(std::string_view name) const;
+
+    bool isVariable(std::string_view name) const;
 
     void execWord(const char *name);
 
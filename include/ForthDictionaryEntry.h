@@ -8,6 +8,7 @@
 #include "WordHeap.h"
 #include "SymbolTable.h"
 #include "Tokenizer.h"
+#include "StackEffect.h"
 #include <iomanip>
 #include <cstddef>
 
@@ -46,8 +47,10 @@ enum class ForthWordType : uint32_t {
 
 // Function pointer types for word execution
 using ForthFunction = void(*)();
-using ImmediateInterpreter = void(*)(std::deque<ForthToken> &tokens);
-using ImmediateCompiler = void(*)(std::deque<ForthToken> &tokens);
+using ImmediateInterpreter = void(*)(TokenStream &tokens);
+using ImmediateCompiler = void(*)(TokenStream &tokens);
+
+struct CompileStats;
 
 
 struct ForthDictionaryEntry {
@@ -77,6 +80,8 @@ struct ForthDictionaryEntry {
     ForthDictionaryEntry *firstWordInVocabulary;
     ImmediateCompiler immediate_compiler;
     ForthWordType type;
+    const CompileStats *compileStats = nullptr; // set for words compiled from source
+    StackEffect effect; // inferred for words compiled from source
 
     // Constructor
     ForthDictionaryEntry(ForthDictionaryEntry *prev, const std::string &wordName,
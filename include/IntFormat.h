@@ -0,0 +1,30 @@
+#ifndef INT_FORMAT_H
+#define INT_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Integer to text in any base from 2 to 36 for U. . D. and the pictured number words.
+// Decimal uses a two digits at a time table, powers of two use shifts and masks.
+
+// longest text, a 128 bit double cell in binary with a sign
+constexpr size_t INT_TEXT_MAX = 130;
+
+// digits of n in base
+int unsigned_length(uint64_t n, unsigned base);
+
+// write the digits of n ending just before end, returns where they start
+char *write_unsigned_back(uint64_t n, unsigned base, char *end);
+
+// as above for the 128 bit unsigned number hi:lo
+char *write_unsigned_double_back(uint64_t lo, uint64_t hi, unsigned base, char *end);
+
+// write n to out, returns the length
+size_t format_unsigned(uint64_t n, unsigned base, char *out);
+
+size_t format_signed(int64_t n, unsigned base, char *out);
+
+// signed double cell number hi:lo
+size_t format_double(uint64_t lo, int64_t hi, unsigned base, char *out);
+
+#endif // INT_FORMAT_H
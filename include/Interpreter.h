@@ -14,20 +14,28 @@ public:
     // Main function to execute Forth code
     void execute(const std::string &input);
 
+    // forget the streams of runs abandoned by an error
+    void reset();
+
 private:
     // Private constructor and destructor (required for singleton)
     Interpreter() = default;
     ~Interpreter() = default;
 
     // Helper methods for token processing
-    void handle_comment(ForthToken &first, std::deque<ForthToken> &tokens);
-    void handle_word(std::deque<ForthToken> &tokens);
-    void handle_compiling(std::deque<ForthToken> &tokens);
-    void handle_number(const ForthToken &first, std::deque<ForthToken> &tokens);
-    void handle_float(const ForthToken &first, std::deque<ForthToken> &tokens);
+    void handle_comment(ForthToken &first, TokenStream &tokens);
+    void handle_word(TokenStream &tokens);
+    void handle_compiling(TokenStream &tokens);
+    void handle_number(const ForthToken &first, TokenStream &tokens);
+    void handle_double(const ForthToken &first, TokenStream &tokens);
+    void handle_float(const ForthToken &first, TokenStream &tokens);
     void handle_unknown(const ForthToken &first);
 
     void raise_error(int code, const std::string &message);
+
+    // token streams are reused, one for each level of nested execution
+    std::deque<TokenStream> streams;
+    size_t depth = 0;
 };
 
 #endif // INTERPRETER_H
\ No newline at end of file
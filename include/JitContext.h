@@ -8,6 +8,9 @@
 #include "asmjit/asmjit.h"
 #include "Singleton.h"
 #include "SignalHandler.h"
+#include "PerfMap.h"
+#include "CodeIndex.h"
+#include "CodeListing.h"
 
 typedef void (*ForthFunction)();
 
@@ -57,9 +60,21 @@ public:
         return true;
     }
 
+    // Keep a listing of each function for SEE, sending it to the LOGGING output as well if asked
+    void enableListing(const bool alsoLog) {
+        if (alsoLog) {
+            enableLogging(true, true);
+        }
+        _listing.setForward(alsoLog ? &_logger : nullptr);
+        _listing.addFlags(asmjit::FormatFlags::kHexImms);
+        _code.setLogger(&_listing);
+        _keepListing = true;
+    }
+
     // Disable logging
     void disableLogging() {
         _code.setLogger(nullptr);
+        _keepListing = false;
         if (_logFile) {
             if (fclose(_logFile) != 0) {
                 std::cerr << "Failed to close log file." << std::endl;
@@ -106,20 +121,53 @@ public:
             SignalHandler::instance().raise(20);
         }
         _assembler = new asmjit::x86::Assembler(&_code);
+        _listing.begin(_assembler);
+    }
 
+    // name given to perf for the function being generated
+    void setFunctionName(const std::string &name) {
+        _functionName = name;
     }
 
     ForthFunction finalize() {
         void *funcPtr = nullptr;
+        const size_t codeSize = _code.codeSize();
         asmjit::Error err = _rt.add(&funcPtr, &_code);
         if (err) {
             std::cerr << "Failed to finalize function: "
                     << asmjit::DebugUtils::errorAsString(err) << std::endl;
             return nullptr;
         }
+        CodeIndex::instance().add(funcPtr, codeSize, _functionName);
+        if (_keepListing) {
+            CodeListing::instance().add(funcPtr, std::move(_listing.lines));
+            _listing.lines.clear();
+        }
+        if (auto &perfMap = PerfMap::instance(); perfMap.enabled()) {
+            perfMap.record(funcPtr, codeSize, _functionName);
+        }
         return reinterpret_cast<ForthFunction>(funcPtr);
     }
 
+    // give finalized code back to asmjit, its addresses are reused so nothing may still describe them
+    template<typename Func>
+    void release(const Func code) {
+        if (!code) return;
+        CodeIndex::instance().remove(reinterpret_cast<uintptr_t>(code));
+        CodeListing::instance().remove(reinterpret_cast<const void *>(code));
+        _rt.release(code);
+    }
+
+    // overwrite bytes of finalized code, asmjit makes the pages writable for the write and flushes the cache
+    bool patch(void *code, const void *bytes, const size_t size) {
+        const asmjit::Error err = _rt.allocator()->write(code, bytes, size);
+        if (err) {
+            std::cerr << "Failed to patch code: " << asmjit::DebugUtils::errorAsString(err) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
 private:
     JitContext() {
         _logger.setFile(stderr); // Default logging to stderr
@@ -128,10 +176,13 @@ private:
 public:
 
     asmjit::FileLogger _logger; // Logs assembly output
+    ListingLogger _listing; // Keeps assembly output for SEE
+    bool _keepListing = false;
     asmjit::JitRuntime _rt; // JIT runtime for executable memory
     asmjit::CodeHolder _code; // Holds JIT-generated code
     asmjit::x86::Assembler *_assembler = nullptr; // Assembler for x86-64 instructions
     FILE *_logFile = nullptr; // File pointer for logging output
+    std::string _functionName; // set by code_generator_startFunction
     std::mutex init_mutex;
 };
 
@@ -0,0 +1,123 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <iostream>
+#include <streambuf>
+#include <unistd.h>
+#include "Singleton.h"
+
+// std::cout is pointed at this, so SHOW, SEE and other reports keep their place among EMIT and TYPE output
+class OutputStreamBuf final : public std::streambuf {
+protected:
+    int_type overflow(int_type c) override;
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+
+    int sync() override;
+};
+
+// Output for EMIT, TYPE, ." etc. is collected here and written in large blocks.
+// The JIT inlines EMIT against buffer and pos, so their addresses must not move.
+class OutputBuffer : public Singleton<OutputBuffer> {
+    friend class Singleton<OutputBuffer>;
+
+public:
+    static constexpr size_t CAPACITY = 256 * 1024;
+
+    alignas(64) char buffer[CAPACITY];
+    size_t pos = 0;
+    // flush on newline, only wanted when a person is watching the terminal
+    bool lineFlush = true;
+
+    void put(const char c) {
+        buffer[pos++] = c;
+        if (pos == CAPACITY || (c == '\n' && lineFlush)) {
+            flush();
+        }
+    }
+
+    void write(const char *str, const size_t len) {
+        if (len > CAPACITY - pos) {
+            flush();
+            // too big to buffer, send it directly
+            if (len >= CAPACITY) {
+                fwrite(str, 1, len, stdout);
+                fflush(stdout);
+                return;
+            }
+        }
+        std::memcpy(buffer + pos, str, len);
+        pos += len;
+        if (pos == CAPACITY || (lineFlush && std::memchr(str, '\n', len))) {
+            flush();
+        }
+    }
+
+    void write(const char *str) {
+        write(str, std::strlen(str));
+    }
+
+    // room to format up to n characters straight into the buffer, then commit them
+    char *reserve(const size_t n) {
+        if (CAPACITY - pos < n) {
+            flush();
+        }
+        return buffer + pos;
+    }
+
+    void commit(const size_t n) {
+        pos += n;
+        if (pos == CAPACITY) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (pos) {
+            fwrite(buffer, 1, pos, stdout);
+            pos = 0;
+        }
+        fflush(stdout);
+    }
+
+    void setLineFlush(const bool on) {
+        lineFlush = on;
+    }
+
+private:
+    OutputBuffer() {
+        lineFlush = isatty(STDOUT_FILENO);
+        previous = std::cout.rdbuf(&stream);
+    }
+
+    ~OutputBuffer() override {
+        flush();
+        std::cout.rdbuf(previous);
+    }
+
+    OutputStreamBuf stream;
+    std::streambuf *previous = nullptr;
+};
+
+inline OutputStreamBuf::int_type OutputStreamBuf::overflow(const int_type c) {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        OutputBuffer::instance().put(traits_type::to_char_type(c));
+    }
+    return traits_type::not_eof(c);
+}
+
+inline std::streamsize OutputStreamBuf::xsputn(const char *s, const std::streamsize n) {
+    OutputBuffer::instance().write(s, static_cast<size_t>(n));
+    return n;
+}
+
+// std::flush and std::endl
+inline int OutputStreamBuf::sync() {
+    OutputBuffer::instance().flush();
+    return 0;
+}
+
+#endif // OUTPUT_BUFFER_H
@@ -0,0 +1,51 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Hardware counters for TIMEIT, read as one group with perf_event_open on Linux, or as smaller groups
+// when the PMU cannot fit them all. Counters the CPU or the kernel will not give us are left out,
+// on other systems there are none.
+class PerfCounters {
+public:
+    PerfCounters() = default;
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    // false if no counter could be opened, reason() says why
+    bool open();
+
+    // count only between start and stop, so setting up each run is not measured
+    void start() const;
+    void stop() const;
+
+    // name and total of each counter, scaled up if the kernel had to share the hardware,
+    // a group that never ran is left out and reason() names its counters
+    [[nodiscard]] std::vector<std::pair<const char *, double>> totals();
+
+    [[nodiscard]] const std::string &reason() const { return why; }
+
+private:
+    struct Counter {
+        const char *name;
+        int fd;
+        uint64_t id;
+        int leader;
+    };
+
+    void openGroup(const std::vector<size_t> &events);
+    [[nodiscard]] std::vector<uint64_t> readGroup(int leader) const;
+    [[nodiscard]] bool scheduled() const;
+    void closeAll();
+
+    std::vector<Counter> counters;
+    std::vector<int> leaders;
+    std::string why;
+};
+
+#endif // PERF_COUNTERS_H
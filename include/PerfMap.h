@@ -0,0 +1,40 @@
+#ifndef PERF_MAP_H
+#define PERF_MAP_H
+
+#include "Singleton.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Names JIT compiled words for perf.
+// SET PERFMAP ON appends "start size name" lines to /tmp/perf-<pid>.map, which perf report and
+// perf top read to symbolize anonymous code. SET JITDUMP ON also writes /tmp/jit-<pid>.dump with
+// the code bytes of each word, for perf inject --jit and annotated disassembly.
+class PerfMap : public Singleton<PerfMap> {
+    friend class Singleton<PerfMap>;
+
+public:
+    bool setMap(bool on);
+    bool setDump(bool on);
+
+    [[nodiscard]] bool enabled() const { return mapFile || dumpFile; }
+
+    // called by JitContext::finalize for each new function
+    void record(const void *code, size_t size, const std::string &name);
+
+private:
+    PerfMap() = default;
+    ~PerfMap() override;
+
+    void writeDumpHeader();
+    void closeDump();
+
+    FILE *mapFile = nullptr;
+    FILE *dumpFile = nullptr;
+    void *dumpMarker = nullptr; // perf finds the dump file through this executable mapping
+    size_t markerSize = 0;
+    uint64_t codeIndex = 0;
+};
+
+#endif // PERF_MAP_H
@@ -0,0 +1,50 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Singleton.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <signal.h>
+
+// Sampling profiler for PROFILE, PROFILE-START, PROFILE-STOP and PROFILE-REPORT.
+// SIGPROF arrives every millisecond of CPU time, the handler records the instruction pointer and the
+// top of the native stack. The report maps these to words through the CodeIndex, a word's self time is
+// where the instruction pointer was, its total time counts the samples with its return addresses on
+// the stack as well.
+class Profiler : public Singleton<Profiler> {
+    friend class Singleton<Profiler>;
+
+public:
+    static constexpr size_t MAX_SAMPLES = 65536;
+    static constexpr size_t STACK_WORDS = 15; // native stack words scanned for return addresses
+    static constexpr int INTERVAL_US = 1000;
+
+    bool start();
+    void stop();
+    void report(size_t rows = 25);
+
+    [[nodiscard]] bool running() const { return active; }
+
+    // samples of the last profile with the instruction pointer in [start, end), by address
+    [[nodiscard]] std::unordered_map<uintptr_t, size_t> samplesIn(uintptr_t start, uintptr_t end) const;
+
+private:
+    Profiler() = default;
+    ~Profiler() override;
+
+    struct Sample {
+        uintptr_t ip;
+        uintptr_t stack[STACK_WORDS];
+    };
+
+    static void handle_sample(int signal, siginfo_t *info, void *context);
+
+    std::vector<Sample> samples;
+    volatile size_t count = 0;
+    size_t dropped = 0;
+    bool active = false;
+};
+
+#endif // PROFILER_H
@@ -1,9 +1,12 @@
 #ifndef QUIT_H
 #define QUIT_H
 #include <csetjmp>
+#include <string>
 
 
 void Quit();  // Declaration of Quit function
+int Script(const std::string &path); // run a file, or stdin when path is empty
+void to_uppercase(std::string &str);
 static jmp_buf jumpBuffer;
 void raise_c(int eno);
 #endif // QUIT_H
\ No newline at end of file
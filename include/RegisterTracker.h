@@ -61,6 +61,7 @@ public:
         // Clear and reinitialize all internal states
         registerMap.clear();
         spillSlots.clear();
+        spills = 0;
         registerUsage.clear();
         freeXmmRegisters.clear();
         reservedXmmRegisters.clear();
@@ -315,6 +316,7 @@ public:
             return;
         }
         assembler->movsd(asmjit::x86::ptr(asmjit::x86::rdi, offset), createXmmFromId(id));
+        ++spills;
         debugMessage("Spill: " + varName + " in: " + xmmRegToStr(id) + " to: " +
                      std::to_string(offset));
     }
@@ -404,6 +406,7 @@ public:
         //assembler->mov(asmjit::x86::rax, spillOffset);
         assembler->movsd(asmjit::x86::ptr(asmjit::x86::rdi, spillOffset), createXmmFromId(spilledReg));
         spillOffset += SPILL_ALIGNMENT; // Ensure 16-byte alignment
+        ++spills;
 
         registerMap.erase(spilledVar);
         freeXmmRegister(spilledReg);
@@ -480,6 +483,11 @@ public:
         return gpCacheUsed;
     }
 
+    // registers stored to spill slots since initialize
+    [[nodiscard]] size_t spillCount() const {
+        return spills;
+    }
+
     void enableGpCache() {
         cacheToGP = true;
     }
@@ -521,6 +529,7 @@ private
     std::vector<int> freeXmmRegisters;
     std::set<int> reservedXmmRegisters; // Reserved XMM register IDs
     u_int64_t spillOffset;
+    size_t spills = 0;
     void *base_slots = nullptr;
     std::unordered_map<std::string, int> freeGpCache;
     std::unordered_set<std::string> constantValues;
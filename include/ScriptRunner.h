@@ -0,0 +1,45 @@
+#ifndef SCRIPT_RUNNER_H
+#define SCRIPT_RUNNER_H
+
+#include "Singleton.h"
+#include <string>
+#include <vector>
+
+// Runs Forth source from files and pipes, without the terminal line reader.
+// Source is read in large chunks and handed to the interpreter a line, or a whole
+// definition, at a time as soon as it is complete.
+class ScriptRunner : public Singleton<ScriptRunner> {
+    friend class Singleton<ScriptRunner>;
+
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    // INCLUDE a file, returns false if it could not be opened
+    bool includeFile(const std::string &path);
+
+    // run all the source read from a file descriptor, e.g. a pipe on stdin
+    void run(int fd);
+
+    // close any files left open when an error abandoned an INCLUDE
+    void reset();
+
+    [[nodiscard]] size_t depth() const { return openFiles.size(); }
+
+private:
+    ScriptRunner() = default;
+    ~ScriptRunner() override = default;
+
+    struct ScanState {
+        size_t scanned = 0; // next character to look at
+        size_t unitStart = 0; // start of the line or definition being collected
+        bool compiling = false; // inside : ... ;
+        bool skipNext = false; // next token is a character for CHAR
+    };
+
+    void scan(std::string &source, ScanState &state, bool atEnd);
+    static void execute(std::string &source, size_t from, size_t to);
+
+    std::vector<int> openFiles;
+};
+
+#endif // SCRIPT_RUNNER_H
@@ -4,6 +4,7 @@
 #include <deque>
 #include "Tokenizer.h"
 #include "CodeGenerator.h"
+#include "PerfMap.h"
 
 inline bool print_stack = false;
 inline bool optimizer;
@@ -13,6 +14,16 @@ inline bool GPCACHE = false;
 inline bool TrackLRU = true;
 inline int corePinned = 0;
 inline bool corePinnedSet = false;
+inline bool mapPopulate = false;
+inline bool mapHugePages = false;
+inline int floatPrecision = 0; // significant digits for F. FE. FS., 0 for the shortest exact form
+inline bool timeitJson = false;
+inline bool hardwareCounters = false; // TIMEIT reads the hardware counters
+inline bool callCounters = false; // words compiled from now on count their calls
+inline bool perfMap = false;
+inline bool jitDump = false;
+inline bool keepListing = false; // words compiled from now on keep their assembly listing for SEE
+inline bool tieredCompilation = false; // words compiled from now on start unoptimized and are recompiled when hot
 
 
 inline void display_settings() {
@@ -23,6 +34,18 @@ inline void display_settings() {
     std::cout << "Debug mode: " << (debug ? "ON" : "OFF") << std::endl;
     std::cout << "GPCACHE: " << (GPCACHE ? "ON" : "OFF") << std::endl;
     std::cout << "Track LRU: " << (TrackLRU ? "ON" : "OFF") << std::endl;
+    std::cout << "Map populate: " << (mapPopulate ? "ON" : "OFF") << std::endl;
+    std::cout << "Map huge pages: " << (mapHugePages ? "ON" : "OFF") << std::endl;
+    std::cout << "TIMEIT JSON: " << (timeitJson ? "ON" : "OFF") << std::endl;
+    std::cout << "TIMEIT hardware counters: " << (hardwareCounters ? "ON" : "OFF") << std::endl;
+    std::cout << "Call counters: " << (callCounters ? "ON" : "OFF") << std::endl;
+    std::cout << "Perf map: " << (perfMap ? "ON" : "OFF") << std::endl;
+    std::cout << "JIT dump: " << (jitDump ? "ON" : "OFF") << std::endl;
+    std::cout << "Listing: " << (keepListing ? "ON" : "OFF") << std::endl;
+    std::cout << "Tiered compilation: " << (tieredCompilation ? "ON" : "OFF") << std::endl;
+    std::cout << "Float precision: ";
+    if (floatPrecision == 0) std::cout << "shortest" << std::endl;
+    else std::cout << floatPrecision << " digits" << std::endl;
     std::cout << "Core pinned: " << (corePinnedSet ? "ON" : "OFF") << std::endl;
     if (corePinnedSet) {
         std::cout << "Core pinned to: " << (corePinned == 0 ? "Core 0" : (corePinned == 1 ? "Core 1" : (corePinned == 2 ? "Core 2" : (corePinned == 3 ? "Core 3" : "Core 4")))) << std::endl;
@@ -39,6 +62,15 @@ std::cout << "Usage: SET <feature> <state>" << std::endl;
     std::cout << "  LOGGING ON/OFF" << std::endl;
     std::cout << "  OPTIMIZE ON/OFF" << std::endl;
     std::cout << "  TRACKLRU ON/OFF" << std::endl;
+    std::cout << "  MAPPOPULATE ON/OFF" << std::endl;
+    std::cout << "  HUGEPAGES ON/OFF" << std::endl;
+    std::cout << "  TIMEITJSON ON/OFF" << std::endl;
+    std::cout << "  HWCOUNTERS ON/OFF" << std::endl;
+    std::cout << "  COUNTERS ON/OFF" << std::endl;
+    std::cout << "  PERFMAP ON/OFF" << std::endl;
+    std::cout << "  JITDUMP ON/OFF" << std::endl;
+    std::cout << "  LISTING ON/OFF" << std::endl;
+    std::cout << "  TIERED ON/OFF" << std::endl;
     std::cout << "  CORE ZERO,ONE,TWO,THREE,FOUR|ANY" << std::endl;
     std::cout << std::endl;
     display_settings();
@@ -47,11 +79,11 @@ std::cout << "Usage: SET <feature> <state>" << std::endl;
 
 
 // SET THING ON,OFF
-inline void runImmediateSET(std::deque<ForthToken> &tokens) {
+inline void runImmediateSET(TokenStream &tokens) {
     // we arrived here from TOKEN SET
 
     const ForthToken second = tokens.front();
-    tokens.erase(tokens.begin()); // Remove the processed token
+    tokens.pop_front(); // Remove the processed token
     if (tokens.empty()) {
         display_set_help();
         return; // Exit early if no tokens to process
@@ -60,7 +92,7 @@ inline void runImmediateSET(std::deque<ForthToken> &tokens) {
     auto feature = second.value;
 
     const ForthToken third = tokens.front();
-    tokens.erase(tokens.begin()); // Remove the processed token
+    tokens.pop_front(); // Remove the processed token
     if (tokens.empty()) return; // Exit early if no tokens to process
     auto state = third.value;
 
@@ -145,6 +177,98 @@ inline void runImmediateSET(std::deque<ForthToken> &tokens) {
         }
     }
 
+    if (feature == "MAPPOPULATE") {
+        if (state == "ON") {
+            mapPopulate = true;
+            std::cout << "MAP-FILE will pre-fault pages" << std::endl;
+        } else if (state == "OFF") {
+            mapPopulate = false;
+            std::cout << "MAP-FILE will fault pages on demand" << std::endl;
+        }
+    }
+
+    if (feature == "HUGEPAGES") {
+        if (state == "ON") {
+            mapHugePages = true;
+            std::cout << "MAP-FILE will request huge pages" << std::endl;
+        } else if (state == "OFF") {
+            mapHugePages = false;
+            std::cout << "MAP-FILE huge pages off" << std::endl;
+        }
+    }
+
+    if (feature == "TIMEITJSON") {
+        if (state == "ON") {
+            timeitJson = true;
+            std::cout << "TIMEIT will print JSON" << std::endl;
+        } else if (state == "OFF") {
+            timeitJson = false;
+            std::cout << "TIMEIT will print a table" << std::endl;
+        }
+    }
+
+    if (feature == "HWCOUNTERS") {
+        if (state == "ON") {
+            hardwareCounters = true;
+            std::cout << "TIMEIT will read hardware counters" << std::endl;
+        } else if (state == "OFF") {
+            hardwareCounters = false;
+            std::cout << "TIMEIT hardware counters off" << std::endl;
+        }
+    }
+
+    if (feature == "COUNTERS") {
+        if (state == "ON") {
+            callCounters = true;
+            std::cout << "Words compiled from now on will count their calls" << std::endl;
+        } else if (state == "OFF") {
+            callCounters = false;
+            std::cout << "Call counters off for new words" << std::endl;
+        }
+    }
+
+    if (feature == "PERFMAP") {
+        if (state == "ON") {
+            perfMap = PerfMap::instance().setMap(true);
+            if (perfMap) std::cout << "New words will be listed in /tmp/perf-<pid>.map" << std::endl;
+        } else if (state == "OFF") {
+            perfMap = false;
+            PerfMap::instance().setMap(false);
+            std::cout << "Perf map off" << std::endl;
+        }
+    }
+
+    if (feature == "JITDUMP") {
+        if (state == "ON") {
+            jitDump = PerfMap::instance().setDump(true);
+            if (jitDump) std::cout << "New words will be written to /tmp/jit-<pid>.dump" << std::endl;
+        } else if (state == "OFF") {
+            jitDump = false;
+            PerfMap::instance().setDump(false);
+            std::cout << "JIT dump off" << std::endl;
+        }
+    }
+
+    if (feature == "LISTING") {
+        if (state == "ON") {
+            keepListing = true;
+            std::cout << "Listing on" << std::endl;
+        } else if (state == "OFF") {
+            keepListing = false;
+            std::cout << "Listing off" << std::endl;
+        }
+    }
+
+    if (feature == "TIERED") {
+        if (state == "ON") {
+            tieredCompilation = true;
+            std::cout << "Tiered compilation on" << std::endl;
+        } else if (state == "OFF") {
+            tieredCompilation = false;
+            std::cout << "Tiered compilation off" << std::endl;
+        }
+    }
+
     if (feature == "OPTIMIZE") {
         if (state == "ON") {
             optimizer = true;
@@ -51,7 +51,12 @@ private:
         "LET statement generator error." , // 22
         "LET statement Lexer error.", // 23
         "LET statement Parser error.", // 24
-        "Register Tracker error" // 25
+        "Register Tracker error", // 25
+        "End of input.", // 26, KEY at the end of stdin, the messages are indexed by number
+        "File could not be mapped.", // 27
+        "File could not be opened.", // 28
+        "Block could not be read or written.", // 29
+        "Number out of range." // 30
     };
 
     // Jump buffer for longjmp
@@ -0,0 +1,45 @@
+#ifndef STACK_EFFECT_H
+#define STACK_EFFECT_H
+
+#include <cstdint>
+#include <string>
+#include "Singleton.h"
+
+class TokenStream;
+struct ForthToken;
+
+// ( in -- out ) cells a word takes from and leaves on the data stack.
+// A word whose effect depends on its data, such as ?DUP PICK or EXEC, has no known effect.
+struct StackEffect {
+    int16_t in = -1;
+    int16_t out = -1;
+
+    [[nodiscard]] bool known() const { return in >= 0; }
+
+    [[nodiscard]] std::string text() const {
+        if (!known()) return "( ? )";
+        return "( " + std::to_string(in) + " -- " + std::to_string(out) + " )";
+    }
+
+    bool operator==(const StackEffect &other) const { return in == other.in && out == other.out; }
+};
+
+// Works out the stack effect of a definition from the effects of the words it uses.
+// IF and ELSE branches must leave the stack at the same depth, and loop bodies must leave it as they found it.
+class StackEffects : public Singleton<StackEffects> {
+    friend class Singleton<StackEffects>;
+
+public:
+    // effect of the tokens after : name up to ;
+    // problem is set when the branches or a loop do not balance, not when a word's effect is unknown
+    StackEffect infer(const TokenStream &tokens, std::string &problem) const;
+
+    // effect of a primitive or of a compiled word
+    [[nodiscard]] StackEffect lookup(const ForthToken &token) const;
+
+private:
+    StackEffects() = default;
+    ~StackEffects() override = default;
+};
+
+#endif // STACK_EFFECT_H
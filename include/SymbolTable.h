@@ -3,6 +3,7 @@
 
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <cstdint>
 
@@ -14,19 +15,19 @@ public:
     }
 
     // Adds a new word or returns the existing ID if already present
-    uint32_t addSymbol(const std::string& name) {
-        auto it = symbols.find(name);
+    uint32_t addSymbol(const std::string_view name) {
+        auto it = symbols.find(key(name));
         if (it != symbols.end()) {
             return it->second;
         }
         uint32_t id = next_id++;
-        symbols[name] = id;
-        reverse_lookup[id] = name;
+        symbols[lookupKey] = id;
+        reverse_lookup[id] = lookupKey;
         return id;
     }
 
-    uint32_t findSymbol(const std::string& name) {
-        auto it = symbols.find(name);
+    uint32_t findSymbol(const std::string_view name) {
+        auto it = symbols.find(key(name));
         if (it != symbols.end()) {
             return it->second;
         }
@@ -48,8 +49,8 @@ public:
     }
 
 
-    uint32_t definedSymbol(const std::string& name) {
-        auto it = symbols.find(name);
+    uint32_t definedSymbol(const std::string_view name) {
+        auto it = symbols.find(key(name));
         if (it != symbols.end()) {
             return it->second;
         }
@@ -74,6 +75,14 @@ public:
 
 private:
     SymbolTable() = default;
+
+    // tokens are views into the source, look them up through one reused string
+    const std::string& key(const std::string_view name) {
+        lookupKey.assign(name.data(), name.size());
+        return lookupKey;
+    }
+
+    std::string lookupKey;
     std::unordered_map<std::string, uint32_t> symbols;
     std::unordered_map<uint32_t, std::string> reverse_lookup;
     uint32_t next_id = 1; // Start from 1 (0 can be used as NULL_ID)
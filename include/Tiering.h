@@ -0,0 +1,55 @@
+#ifndef TIERING_H
+#define TIERING_H
+
+#include "Singleton.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+struct ForthDictionaryEntry;
+typedef void (*ForthFunction)();
+
+// SET TIERED ON compiles colon definitions quickly, without the optimizer, as tier 0.
+// A tier 0 word counts its calls on entry and carries on through target, which starts as its own body.
+// On the HOT_CALLS call it is compiled again from its source with the optimizer, then target and the
+// dictionary entry are switched to the new code, so callers compiled against the tier 0 code get there too.
+struct TieredWord {
+    uint64_t calls = 0;
+    void *target = nullptr;
+    ForthFunction code = nullptr; // the tier 0 function, target starts inside it
+    ForthDictionaryEntry *entry = nullptr;
+    const ForthDictionaryEntry *frame = nullptr; // the entry RBP was set to
+    std::string name;
+    std::string source; // from : to ;
+    int64_t base = 10; // BASE the source was read in
+    // the word each name in the source referred to, a redefinition since stops the recompile
+    std::vector<const ForthDictionaryEntry *> bindings;
+    bool promoted = false;
+    bool forgotten = false;
+};
+
+class Tiering : public Singleton<Tiering> {
+    friend class Singleton<Tiering>;
+
+public:
+    static constexpr uint64_t HOT_CALLS = 1000;
+
+    TieredWord *add(TieredWord word);
+
+    // called by tier 0 code on its HOT_CALLS call
+    static void promote(TieredWord *word);
+
+    // FORGET entry, releases its tier 0 and tier 1 code, true when entry was tiered
+    bool forget(ForthDictionaryEntry *entry);
+
+    void display() const;
+
+private:
+    Tiering() = default;
+    ~Tiering() override = default;
+
+    std::deque<TieredWord> words;
+};
+
+#endif // TIERING_H
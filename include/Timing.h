@@ -0,0 +1,71 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <time.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+// Clocks and statistics for TIMEIT.
+// Runs are timed with the time stamp counter, which is converted to nanoseconds with a ratio
+// measured once against the monotonic clock.
+
+inline uint64_t clock_ns() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// read the counter before the measured code, the fence keeps earlier work out of the measurement
+inline uint64_t cycles_start() {
+#if defined(__x86_64__)
+    _mm_lfence();
+    return __rdtsc();
+#else
+    return clock_ns();
+#endif
+}
+
+// rdtscp waits for the measured code to finish, the fence keeps later work out
+inline uint64_t cycles_end() {
+#if defined(__x86_64__)
+    unsigned int aux;
+    const uint64_t t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+#else
+    return clock_ns();
+#endif
+}
+
+// time stamp counter ticks per nanosecond, measured on first use
+double cycles_per_ns();
+
+// the cost of an empty measurement, subtracted from each run
+uint64_t timing_overhead();
+
+struct TimingSummary {
+    size_t runs = 0;
+    size_t warmups = 0;
+    // cycles per run
+    double min = 0;
+    double median = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double mean = 0;
+    // machine code in the timed word itself, 0 if it is not JIT code
+    size_t codeBytes = 0;
+    // hardware counters per run, when TIMEIT was asked for them
+    std::vector<std::pair<const char *, double>> counters;
+};
+
+// sorts the samples
+TimingSummary summarize_timings(std::vector<uint64_t> &samples);
+
+void print_timings(const std::string &name, const TimingSummary &summary, bool json);
+
+#endif // TIMING_H
@@ -1,7 +1,11 @@
 #ifndef TOKENIZER_H
 #define TOKENIZER_H
 
-#include <deque>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 #include "Singleton.h"
 #include <string>
 
@@ -11,10 +15,11 @@
 #define MAX_TOKEN_LENGTH 1024
 #define MAX_TOKENS 1024
 
-typedef enum {
+typedef enum : uint8_t {
     TOKEN_WORD,         // Normal Forth word
     TOKEN_NUMBER,       // Integer numbers
     TOKEN_FLOAT,        // Floating-point numbers
+    TOKEN_DOUBLE,       // Double cell integers written with a trailing .
     TOKEN_STRING,       // Strings
     TOKEN_VARIABLE,     // Variable with data pointer
     TOKEN_UNKNOWN,      // Unidentified tokens
@@ -34,70 +39,141 @@ typedef enum {
     TOKEN_CALL          // Optimized function calls (Tail call)
 } TokenType;
 
-// Token structure with all necessary constructors
+// Operations the optimizer replaces token sequences with
+enum class OptOp : uint8_t {
+    NONE,
+    ADD_IMM,
+    SUB_IMM,
+    MUL_IMM,
+    DIV_IMM,
+    SHL_IMM,
+    SHR_IMM,
+    CMP_LT_IMM,
+    CMP_GT_IMM,
+    CMP_EQ_IMM,
+    INC_R,
+    DEC_R,
+    LIT_VAR_STORE,
+    R_AT_CSTORE,
+    R_AT_STORE,
+    VAR_AT,
+    VAR_STORE,
+    VAR_TOR,
+    CAT_EMIT,
+    LEA_TOS,
+    MOV_TOS_1,
+    TUCK,
+    DUP,
+    IF_CMP,
+    IF_CMP_IMM,
+    UNTIL_CMP,
+    UNTIL_CMP_IMM,
+    WHILE_CMP,
+    WHILE_CMP_IMM,
+    MOD_IMM,
+    DIVMOD_IMM,
+    UDIV_IMM,
+    UMOD_IMM,
+    SCALE_IMM,
+    VAR_AT_ADD,
+    VAR_PLUS_STORE,
+    LIT_VAR_PLUS_STORE,
+    VAR_AT_IF,
+    SELECT,
+    CALL_XT,
+    COUNT
+};
+
+// the dictionary word that generates the code for each optimized operation
+inline const char *opt_op_name(const OptOp op) {
+    static constexpr const char *names[] = {
+        "", "ADD_IMM", "SUB_IMM", "MUL_IMM", "DIV_IMM", "SHL_IMM", "SHR_IMM",
+        "CMP_LT_IMM", "CMP_GT_IMM", "CMP_EQ_IMM", "INC_R@", "DEC_R@", "LIT_VAR_!",
+        "R@_C!", "R@_!", "VAR_@", "VAR_!", "VAR_TOR", "C@_EMIT", "LEA_TOS",
+        "NIP", "TUCK", "DUP", "IF_CMP", "IF_CMP_IMM", "UNTIL_CMP", "UNTIL_CMP_IMM",
+        "WHILE_CMP", "WHILE_CMP_IMM", "MOD_IMM", "DIVMOD_IMM", "UDIV_IMM", "UMOD_IMM",
+        "SCALE_IMM", "VAR_@_+", "VAR_+!", "LIT_VAR_+!", "VAR_@_IF",
+        "SELECT", "[']_EXEC"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(OptOp::COUNT));
+    return names[static_cast<size_t>(op)];
+}
+
+// A token is a view of its text in the source plus a small payload.
+// The source must outlive the tokens, they are only kept while a line is run.
 struct ForthToken {
+    std::string_view value;
+    union {
+        uint64_t int_value = 0;
+        double float_value;
+    };
+    uint32_t word_id = 0;
     TokenType type = TOKEN_UNKNOWN;
-    uint64_t int_value = 0;
-    double float_value = 0.0;
-    std::string value;
-
-    // Optimization-specific fields
-    bool is_optimized = false;
-    bool is_immediate = false;
-    bool in_comment = false;
-    int64_t opt_value = 0;
-    TokenType original_type = TOKEN_UNKNOWN;
-    std::string optimized_op;
-    uint32_t word_id;
-    uint32_t word_len;
-
-    // ✅ Default Constructor
+    OptOp op = OptOp::NONE;
+
     ForthToken() = default;
 
-    // ✅ Constructor for regular tokens
-    ForthToken(TokenType t, std::string v = "", int i_val = 0, double f_val = 0.0)
-        : type(t), int_value(i_val), float_value(f_val), value(std::move(v)),
-          is_optimized(false), opt_value(0), original_type(t), optimized_op("") {}
-
-    // ✅ Constructor for optimized tokens
-    ForthToken(TokenType t, std::string op, int64_t opt_val)
-        : type(t), int_value(0), float_value(0.0), value(""),
-          is_optimized(true), opt_value(opt_val), original_type(t), optimized_op(std::move(op)) {}
-
-    ForthToken(TokenType t, int i_val)
-     : type(t), int_value(i_val), float_value(0.0), value(""),
-       is_optimized(false), opt_value(0), original_type(t), optimized_op("") {}
-
-    // Constructor for TokenType and std::string
-    ForthToken(TokenType t, const std::string& str_val)
-        : type(t), int_value(0), float_value(0.0), value(str_val),
-          is_optimized(false), opt_value(0), original_type(t), optimized_op("") {}
-
-
-
-    // ✅ Copy and move constructors
-    ForthToken(const ForthToken&) = default;
-    ForthToken(ForthToken&&) noexcept = default;
-    ForthToken& operator=(const ForthToken&) = default;
-    ForthToken& operator=(ForthToken&&) noexcept = default;
-
-
-    // ✅ Reset method
-    void reset() {
-        type = TOKEN_UNKNOWN;
-        int_value = 0;
-        float_value = 0.0;
-        value.clear();
-        in_comment = false;
-        is_optimized = false;
-        opt_value = 0;
-        original_type = TOKEN_UNKNOWN;
-        optimized_op.clear();
-    }
+    ForthToken(const TokenType t, const std::string_view v = {}, const int64_t i_val = 0)
+        : value(v), int_value(i_val), type(t) {}
+
+    ForthToken(const TokenType t, const int i_val)
+        : int_value(i_val), type(t) {}
+
+    // optimized operation with its constant
+    ForthToken(const OptOp o, const int64_t i_val)
+        : int_value(i_val), type(TOKEN_OPTIMIZED), op(o) {}
 };
 
+static_assert(sizeof(ForthToken) <= 32, "tokens are copied around freely, keep them small");
+static_assert(std::is_trivially_copyable_v<ForthToken>);
+
+
+// The tokens of a line, read from the front as words consume them.
+// The storage is kept when cleared, so a stream that is reused stops allocating.
+class TokenStream {
+public:
+    using iterator = std::vector<ForthToken>::iterator;
+    using const_iterator = std::vector<ForthToken>::const_iterator;
+
+    TokenStream() = default;
+
+    TokenStream(const std::initializer_list<ForthToken> init) : items(init) {}
+
+    [[nodiscard]] bool empty() const { return head == items.size(); }
+    [[nodiscard]] size_t size() const { return items.size() - head; }
+
+    ForthToken &front() { return items[head]; }
+    [[nodiscard]] const ForthToken &front() const { return items[head]; }
+    ForthToken &back() { return items.back(); }
 
+    ForthToken &operator[](const size_t i) { return items[head + i]; }
+    const ForthToken &operator[](const size_t i) const { return items[head + i]; }
 
+    void pop_front() { ++head; }
+    void push_back(const ForthToken &token) { items.push_back(token); }
+
+    template<typename... Args>
+    ForthToken &emplace_back(Args &&... args) { return items.emplace_back(std::forward<Args>(args)...); }
+
+    void clear() {
+        items.clear();
+        head = 0;
+    }
+
+    void reserve(const size_t n) { items.reserve(n); }
+
+    // BASE when the numbers in the stream were converted
+    int64_t base = 10;
+
+    iterator begin() { return items.begin() + static_cast<std::ptrdiff_t>(head); }
+    iterator end() { return items.end(); }
+    [[nodiscard]] const_iterator begin() const { return items.begin() + static_cast<std::ptrdiff_t>(head); }
+    [[nodiscard]] const_iterator end() const { return items.end(); }
+
+private:
+    std::vector<ForthToken> items;
+    size_t head = 0;
+};
 
 
 class Tokenizer : public Singleton<Tokenizer> {
@@ -105,19 +181,31 @@ class Tokenizer : public Singleton<Tokenizer> {
 
 private:
     bool inComment = false;
+    int64_t base = 10; // BASE for the line being tokenized
+    int64_t *baseAddress = nullptr;
+    bool nameNext = false; // the next token names a new word and is never a number
 
 public:
 
     void print_token(const ForthToken &token);
 
-    void print_token_list(const std::deque<ForthToken> &tokens);
+    void print_token_list(const TokenStream &tokens);
 
 
-    int optimize_constant_operations(const std::deque<ForthToken> &tokens, std::deque<ForthToken> &optimized_tokens);
+    int optimize_constant_operations(const TokenStream &tokens, TokenStream &optimized_tokens);
 
     ForthToken get_next_token(const char **input);
 
-    int tokenize_forth(const std::string &input, std::deque<ForthToken> &tokens);
+    // convert the text of a token to a number in base, or mark it unknown
+    static void classify_number(ForthToken &token, int64_t base);
+
+    // read BASE, finding the variable again as the dictionary may have changed
+    int64_t current_base();
+
+    // reconvert the numbers left in a stream when BASE has changed, e.g. HEX FF
+    void rebase(TokenStream &tokens);
+
+    int tokenize_forth(const std::string &input, TokenStream &tokens);
 
 
     Tokenizer() = default;
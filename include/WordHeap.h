@@ -9,6 +9,12 @@
 #include "SymbolTable.h"
 #include <iomanip>
 #include <cctype>
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 
@@ -19,7 +25,8 @@ enum class WordDataType {
     INT, // Single integer
     FLOAT, // Single float
     FLOAT_ARRAY, // Array of floats
-    STRING // Null-terminated string
+    STRING, // Null-terminated string
+    MAPPED_FILE // File mapped into memory with mmap
 };
 
 // Represents a word's allocated memory and type metadata
@@ -32,6 +39,7 @@ public:
         size_t size; // Size of the allocation in bytes
         size_t index; // index for array
         WordDataType dataType; // Type of data (default: raw bytes)
+        bool writable = true; // false for read only file mappings
     };
 
     // Allocate memory for a word using a 64-bit `id`
@@ -75,7 +83,7 @@ public:
             std::free(tempData);
 
             // Update allocation metadata
-            it->second = {newPtr, size, 0, type}; // Update size and type
+            it->second = {newPtr, size, 0, type, true}; // Update size and type
             std::cout << "WordHeap: Reallocation succeeded for word ID: " << std::hex << wordId
                     << " Name: " << SymbolTable::instance().getSymbol(wordId)
                     << std::dec << ", new size: " << size << " bytes." << std::endl;
@@ -93,7 +101,7 @@ public:
         }
 
         // Store the allocation along with type metadata
-        allocations[wordId] = {ptr, size, 0, type};
+        allocations[wordId] = {ptr, size, 0, type, true};
         // std::cout << "WordHeap: Successfully allocated "
         //         << size << " bytes for word ID: "
         //         << std::hex << wordId << " Name: " << SymbolTable::instance().getSymbol(wordId)
@@ -105,12 +113,81 @@ public:
     void deallocate(uint64_t wordId) {
         auto it = allocations.find(wordId);
         if (it != allocations.end()) {
-            std::free(it->second.dataPtr);
+            release(it->second);
             allocations.erase(it);
-            std::cout << "WordHeap: Memory deallocated for word ID: " << wordId << "." << std::endl;
+            // std::cout << "WordHeap: Memory deallocated for word ID: " << wordId << "." << std::endl;
         }
     }
 
+    // Map a file into memory, the mapping is listed under the file name.
+    // Mappings are kept by address, apart from word allocations, so a file can be mapped more than once.
+    // populate pre-faults the pages, hugePages asks for transparent huge pages where supported.
+    void *mapFile(const std::string &path, size_t &length, bool writable,
+                  bool populate = false, bool hugePages = false) {
+        length = 0;
+        const int fd = open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "WordHeap: Unable to open " << path << ": " << std::strerror(errno) << std::endl;
+            return nullptr;
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            std::cerr << "WordHeap: Unable to map empty or unreadable file " << path << std::endl;
+            close(fd);
+            return nullptr;
+        }
+
+        int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+        if (populate) flags |= MAP_POPULATE;
+#endif
+        const int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void *ptr = mmap(nullptr, static_cast<size_t>(st.st_size), prot, flags, fd, 0);
+        // the mapping keeps its own reference to the file
+        close(fd);
+        if (ptr == MAP_FAILED) {
+            std::cerr << "WordHeap: mmap failed for " << path << ": " << std::strerror(errno) << std::endl;
+            return nullptr;
+        }
+
+        length = static_cast<size_t>(st.st_size);
+#ifndef MAP_POPULATE
+        // no MAP_POPULATE on macOS, ask for read ahead instead
+        if (populate) madvise(ptr, length, MADV_WILLNEED);
+#endif
+#ifdef MADV_HUGEPAGE
+        if (hugePages) madvise(ptr, length, MADV_HUGEPAGE);
+#else
+        (void) hugePages; // macOS only offers superpages for anonymous memory
+#endif
+
+        mappings[ptr] = {{ptr, length, 0, WordDataType::MAPPED_FILE, writable}, path};
+        return ptr;
+    }
+
+    // Unmap a file mapping given its address
+    bool unmapFile(const void *addr) {
+        const auto it = mappings.find(addr);
+        if (it == mappings.end()) return false;
+        release(it->second.allocation);
+        mappings.erase(it);
+        return true;
+    }
+
+    // Find the file mapping that contains an address range
+    WordAllocation *findMapping(const void *addr, size_t len) {
+        const auto start = reinterpret_cast<uintptr_t>(addr);
+        for (auto &[base_address, mapping]: mappings) {
+            WordAllocation &allocation = mapping.allocation;
+            const auto base = reinterpret_cast<uintptr_t>(allocation.dataPtr);
+            if (start >= base && start + len <= base + allocation.size) {
+                return &allocation;
+            }
+        }
+        return nullptr;
+    }
+
     // Retrieve the allocation metadata for a word using its ID
     WordAllocation *getAllocation(uint64_t wordId) {
         auto it = allocations.find(wordId);
@@ -118,11 +195,19 @@ public:
     }
 
     void display_metadata(int wordId, WordAllocation a) const {
+        display_metadata(SymbolTable::instance().getSymbol(wordId), a);
+    }
+
+    void display_metadata(const std::string &name, WordAllocation a) const {
         // Display metadata for the allocation
 
-        std::cout << "Name: " << SymbolTable::instance().getSymbol(wordId) << std::endl;
+        std::cout << "Name: " << name << std::endl;
         std::cout << "Size: " << a.size << " bytes"
-                << ", Type: " << wordDataTypeToString(a.WordAllocation::dataType) << std::endl;
+                << ", Type: " << wordDataTypeToString(a.WordAllocation::dataType);
+        if (a.dataType == WordDataType::MAPPED_FILE) {
+            std::cout << (a.writable ? " (read/write)" : " (read only)");
+        }
+        std::cout << std::endl;
         std::cout << "From: " << a.WordAllocation::dataPtr
                 << ", To: " << reinterpret_cast<void *>(
                     (uint64_t) a.WordAllocation::dataPtr + a.WordAllocation::size - 1)
@@ -131,7 +216,8 @@ public:
 
     void dump_data(WordAllocation allocation) const {
         // FORTH people like to work on raw bytes...
-        if (allocation.WordAllocation::dataType == WordDataType::DEFAULT) {
+        if (allocation.WordAllocation::dataType == WordDataType::DEFAULT ||
+            allocation.WordAllocation::dataType == WordDataType::MAPPED_FILE) {
             // Retrieve pointer to data and calculate the number of bytes to display
             const unsigned char *data = reinterpret_cast<const unsigned char *>(allocation.WordAllocation::dataPtr);
             size_t bytesToDisplay = std::min(size_t(32), allocation.WordAllocation::size); // Show up to 32 bytes
@@ -189,7 +275,7 @@ public:
     }
 
     void listAllocations() const {
-        if (allocations.empty()) {
+        if (allocations.empty() && mappings.empty()) {
             std::cout << "WordHeap: No allotments have been allocated." << std::endl;
             return;
         }
@@ -200,15 +286,32 @@ public:
             display_metadata(wordId, allocation);
             dump_data(allocation);
         }
+        for (const auto &[addr, mapping]: mappings) {
+            display_metadata(mapping.path, mapping.allocation);
+            dump_data(mapping.allocation);
+        }
+    }
+
+    void listMappings() const {
+        if (mappings.empty()) {
+            std::cout << "WordHeap: No files are mapped." << std::endl;
+        }
+        for (const auto &[addr, mapping]: mappings) {
+            display_metadata(mapping.path, mapping.allocation);
+        }
     }
 
 
     // Clear all allocations
     void clear() {
         for (auto &alloc: allocations) {
-            std::free(alloc.second.dataPtr);
+            release(alloc.second);
         }
         allocations.clear();
+        for (auto &mapping: mappings) {
+            release(mapping.second.allocation);
+        }
+        mappings.clear();
         std::cout << "WordHeap: All allocations cleared." << std::endl;
     }
 
@@ -219,6 +322,15 @@ private:
         clear(); // Free all memory upon destruction
     }
 
+    // mapped files are returned to the kernel, everything else came from posix_memalign
+    static void release(const WordAllocation &allocation) {
+        if (allocation.dataType == WordDataType::MAPPED_FILE) {
+            munmap(allocation.dataPtr, allocation.size);
+        } else {
+            std::free(allocation.dataPtr);
+        }
+    }
+
     // Helper to convert WordDataType to string for display
     const char *wordDataTypeToString(WordDataType type) const {
         switch (type) {
@@ -228,11 +340,18 @@ private:
             case WordDataType::FLOAT: return "Float";
             case WordDataType::FLOAT_ARRAY: return "Float Array";
             case WordDataType::STRING: return "String";
+            case WordDataType::MAPPED_FILE: return "Mapped File";
             default: return "Unknown";
         }
     }
 
     std::unordered_map<uint64_t, WordAllocation> allocations; // Tracks memory allocations using 64-bit word IDs
+
+    struct FileMapping {
+        WordAllocation allocation;
+        std::string path;
+    };
+    std::unordered_map<const void *, FileMapping> mappings; // file mappings by address
 };
 
 #endif // WORDHEAP_H
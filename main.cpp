@@ -3,13 +3,14 @@
 #include "ForthSystem.h"
 #include "Quit.h"
 #include <iostream>
+#include <unistd.h>
 #include "ParseLet.h"
 
 void printAST(const ASTNode* root);
 
 
 
-int main() {
+int main(int argc, char *argv[]) {
 
     // std::string input = "LET (x, y) = FN(a, b) = a + b * sqrt(a) WHERE b = 2.0;";
     // auto tokens = tokenize(input);
@@ -47,6 +48,14 @@ int main() {
 
     ForthSystem::initialize();
     code_generator_initialize();
+
+    // ForthJIT file.fs runs a script, so does piping source into stdin
+    if (argc > 1) {
+        return Script(argv[1]);
+    }
+    if (!isatty(STDIN_FILENO)) {
+        return Script("");
+    }
     Quit();
     return 0;
 
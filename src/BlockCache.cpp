@@ -0,0 +1,219 @@
+#include "BlockCache.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Settings.h"
+
+// address space reserved for the block file at a time, the file itself grows a block at a time
+static constexpr size_t MAP_WINDOW = 64 * 1024 * 1024;
+
+
+BlockCache::~BlockCache() {
+    saveBuffers();
+    release();
+}
+
+bool BlockCache::open(const std::string &newPath) {
+    saveBuffers();
+    emptyBuffers();
+    release();
+    path = newPath;
+    return ensureOpen();
+}
+
+bool BlockCache::configure(const size_t newCount, const size_t newSize) {
+    if (newCount == 0 || (newSize != 1024 && newSize != 4096)) {
+        return false;
+    }
+    if (!saveBuffers()) {
+        return false;
+    }
+    emptyBuffers();
+    count = newCount;
+    size = newSize;
+    buffers.clear();
+    memory.clear();
+    memory.shrink_to_fit();
+    return true;
+}
+
+bool BlockCache::ensureOpen() {
+    if (fd >= 0) return true;
+    if (path.empty()) path = DEFAULT_FILE;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "BLOCK: unable to open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st{};
+    fstat(fd, &st);
+    fileSize = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+// the file must hold block n before it can be written, grow it and the mapping if needed
+bool BlockCache::ensureMapped(const uint64_t n) {
+    const size_t end = (n + 1) * size;
+    if (end > fileSize) {
+        if (ftruncate(fd, static_cast<off_t>(end)) != 0) return false;
+        fileSize = end;
+    }
+    if (end > mapped || !map) {
+        // pages past the end of the file are never touched, so the window can be larger than the file
+        const size_t window = std::max(std::max(mapped * 2, MAP_WINDOW), end);
+        if (map) munmap(map, mapped);
+        void *addr = mmap(nullptr, window, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            map = nullptr;
+            mapped = 0;
+            return false;
+        }
+        map = static_cast<char *>(addr);
+        mapped = window;
+    }
+    return true;
+}
+
+void BlockCache::release() {
+    if (map) {
+        munmap(map, mapped);
+        map = nullptr;
+        mapped = 0;
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    fileSize = 0;
+}
+
+char *BlockCache::block(const uint64_t n, const bool readBlock) {
+    // the end of block n must be an offset the file can have, -1 BLOCK would be NO_BLOCK
+    if (n == NO_BLOCK || n >= static_cast<uint64_t>(std::numeric_limits<off_t>::max()) / size) return nullptr;
+
+    if (buffers.empty()) {
+        buffers.resize(count);
+        memory.resize(count * size);
+    }
+
+    // the same block again is the common case
+    if (hasCurrent && buffers[current].block == n) {
+        ++counts.hits;
+        buffers[current].referenced = TrackLRU;
+        return memory.data() + current * size;
+    }
+    if (const auto it = resident.find(n); it != resident.end()) {
+        ++counts.hits;
+        current = it->second;
+        hasCurrent = true;
+        buffers[current].referenced = TrackLRU;
+        return memory.data() + current * size;
+    }
+
+    ++counts.misses;
+    if (!ensureOpen()) return nullptr;
+
+    const size_t index = victim();
+    Buffer &buffer = buffers[index];
+    if (buffer.block != NO_BLOCK) {
+        ++counts.evictions;
+        if (!writeBack(buffer, index)) return nullptr;
+        resident.erase(buffer.block);
+    }
+
+    char *data = memory.data() + index * size;
+    if (readBlock) {
+        const size_t offset = n * size;
+        if (offset + size <= fileSize && ensureMapped(n)) {
+            std::memcpy(data, map + offset, size);
+        } else {
+            // a block that has never been written reads as blanks
+            ssize_t got = 0;
+            if (offset < fileSize) {
+                got = pread(fd, data, size, static_cast<off_t>(offset));
+                if (got < 0) got = 0;
+            }
+            std::memset(data + got, ' ', size - static_cast<size_t>(got));
+        }
+    }
+
+    buffer.block = n;
+    buffer.dirty = false;
+    buffer.referenced = TrackLRU;
+    resident[n] = index;
+    current = index;
+    hasCurrent = true;
+    return data;
+}
+
+// CLOCK, skip recently referenced buffers once, clearing the reference as the hand passes
+size_t BlockCache::victim() {
+    while (true) {
+        const size_t index = hand;
+        hand = (hand + 1) % buffers.size();
+        Buffer &buffer = buffers[index];
+        if (buffer.block == NO_BLOCK || !buffer.referenced || !TrackLRU) {
+            return index;
+        }
+        buffer.referenced = false;
+    }
+}
+
+bool BlockCache::writeBack(Buffer &buffer, const size_t index) {
+    if (!buffer.dirty) return true;
+    if (!ensureMapped(buffer.block)) return false;
+
+    const size_t offset = buffer.block * size;
+    std::memcpy(map + offset, memory.data() + index * size, size);
+    // start the write, the kernel completes it in the background
+    const auto page = static_cast<size_t>(getpagesize());
+    const size_t start = offset & ~(page - 1);
+    msync(map + start, offset + size - start, MS_ASYNC);
+    buffer.dirty = false;
+    ++counts.writes;
+    return true;
+}
+
+void BlockCache::update() {
+    if (hasCurrent) {
+        buffers[current].dirty = true;
+    }
+}
+
+bool BlockCache::saveBuffers() {
+    bool ok = true;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        ok = writeBack(buffers[i], i) && ok;
+    }
+    return ok;
+}
+
+void BlockCache::emptyBuffers() {
+    for (auto &buffer: buffers) {
+        buffer = Buffer{};
+    }
+    resident.clear();
+    hasCurrent = false;
+    hand = 0;
+}
+
+void BlockCache::display() const {
+    const uint64_t lookups = counts.hits + counts.misses;
+    std::cout << "Block file: " << (path.empty() ? DEFAULT_FILE : path.c_str()) << std::endl;
+    std::cout << "Buffers: " << count << " of " << size << " bytes, "
+            << (TrackLRU ? "CLOCK" : "in turn") << " replacement" << std::endl;
+    std::cout << "Resident: " << resident.size() << std::endl;
+    std::cout << "Hits: " << counts.hits << " Misses: " << counts.misses;
+    if (lookups) {
+        std::cout << " (" << (counts.hits * 100 / lookups) << "% hits)";
+    }
+    std::cout << std::endl;
+    std::cout << "Evictions: " << counts.evictions << " Writes: " << counts.writes << std::endl;
+}
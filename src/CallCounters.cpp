@@ -0,0 +1,58 @@
+#include "CallCounters.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+
+WordStats *CallCounters::add(const std::string &name) {
+    entries.push_back({WordStats{}, name});
+    return &entries.back().stats;
+}
+
+const WordStats *CallCounters::find(const std::string &name) const {
+    const WordStats *best = nullptr;
+    for (const auto &e: entries) {
+        if (e.name == name && (!best || e.stats.calls > best->calls)) {
+            best = &e.stats;
+        }
+    }
+    return best;
+}
+
+void CallCounters::resetDepths() {
+    for (auto &e: entries) {
+        e.stats.depth = 0;
+    }
+}
+
+void CallCounters::clear() {
+    for (auto &e: entries) {
+        e.stats.calls = 0;
+        e.stats.cycles = 0;
+        e.stats.stackHigh = 0;
+    }
+}
+
+void CallCounters::display(const size_t rows) const {
+    std::vector<const Entry *> called;
+    for (const auto &e: entries) {
+        if (e.stats.calls) called.push_back(&e);
+    }
+    if (called.empty()) {
+        std::cout << "No calls counted, SET COUNTERS ON before compiling the words to count" << std::endl;
+        return;
+    }
+    std::sort(called.begin(), called.end(),
+              [](const Entry *a, const Entry *b) { return a->stats.calls > b->stats.calls; });
+
+    std::cout << std::left << std::setw(24) << "word" << std::right
+            << std::setw(14) << "calls" << std::setw(14) << "cycles/call" << std::setw(8) << "stack" << std::endl;
+    for (size_t i = 0; i < called.size() && i < rows; ++i) {
+        const WordStats &s = called[i]->stats;
+        std::cout << std::left << std::setw(24) << called[i]->name << std::right
+                << std::setw(14) << s.calls
+                << std::setw(14) << s.cycles / s.calls
+                << std::setw(8) << s.stackHigh / 8 << std::endl;
+    }
+}
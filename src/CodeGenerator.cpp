@@ -8,7 +8,10 @@
 #include "LabelManager.h"
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
 #include <StringsStorage.h>
 #include <unistd.h>
 #include <gtest/gtest-printers.h>
@@ -16,8 +19,22 @@
 #include "Settings.h"
 // MacOS timing functions.
 #include <signal.h>
-#include <mach/mach_time.h>
 #include "Interpreter.h"
+#include "OutputBuffer.h"
+#include "ScriptRunner.h"
+#include "FloatFormat.h"
+#include "IntFormat.h"
+#include "FileIO.h"
+#include "BlockCache.h"
+#include "Timing.h"
+#include "PerfCounters.h"
+#include "Profiler.h"
+#include "CodeIndex.h"
+#include "CompileStats.h"
+#include "CallCounters.h"
+#include "Tiering.h"
+#include "DivMagic.h"
+#include "DeferredWords.h"
 
 void *code_generator_heap_start = nullptr;
 
@@ -116,7 +133,9 @@ void *return_stack_setup() {
 }
 
 void check_logging() {
-    if (jitLogging == true) {
+    if (keepListing) {
+        JitContext::instance().enableListing(jitLogging);
+    } else if (jitLogging == true) {
         JitContext::instance().enableLogging(true, true);
     } else {
         JitContext::instance().disableLogging();
@@ -262,35 +281,6 @@ void code_generator_initialize() {
 
     // compiler has started lets compile some core words.
 
-    Interpreter::instance().execute(
-        R"(
-            : U.
-              0x2020202020202020 PAD !
-              PAD >R
-              R> 1 + >R
-              BEGIN
-                DUP BASE @ MOD
-                DIGIT
-                R@ C!
-                R> 1 + >R
-                BASE @ /
-                DUP 0 =
-              UNTIL
-              DROP
-              R>
-              BEGIN
-                1 -
-                DUP C@ EMIT
-                DUP PAD >
-              WHILE
-              REPEAT
-              C@ EMIT
-                ;
-    )");
-
-    Interpreter::instance().execute(
-        R"( : . .- U. ; )");
-
     Interpreter::instance().execute(
         R"( : DECIMAL 10 BASE ! ;)");
 
@@ -334,19 +324,6 @@ void code_generator_initialize() {
         : INPUT
             TIB DUP 1 + 128 ACCEPT SWAP C! ; )");
 
-
-    //  : type >R BEGIN DUP C@ EMIT R> 1 - >R 1 + R@ 0 > WHILE REPEAT R> 2DROP ;
-    Interpreter::instance().execute(
-        R"(
-        : TYPE
-            >R BEGIN
-                DUP C@ EMIT
-                R> 1 - >R
-                1 +
-                R@ 0 > WHILE
-            REPEAT
-            R> 2DROP ; )");
-
     Interpreter::instance().execute(
         R"(
     : rfact
@@ -364,9 +341,6 @@ void code_generator_initialize() {
     )");
 
 
-    Interpreter::instance().execute(
-        R"( CLS ." MacForth" CR )");
-
 
     // std::cout << "FORTH dictionary created." << std::endl;
 }
@@ -512,6 +486,18 @@ void compile_pushVariableAddress(const int64_t literal, const std::string &name)
     assembler->mov(asmjit::x86::qword_ptr(asmjit::x86::rcx), asmjit::x86::rax);
 }
 
+// +! ( n addr -- ) add n to the cell at addr in place
+[[maybe_unused]] static void plusStoreFromDS() {
+    asmjit::x86::Assembler *assembler;
+    if (initialize_assembler(assembler)) return;
+    assembler->comment("; -- add to memory +!");
+    assembler->add(asmjit::x86::qword_ptr(asmjit::x86::r13), asmjit::x86::r12);
+    // drop the address and the value
+    assembler->mov(asmjit::x86::r13, asmjit::x86::ptr(asmjit::x86::r15));
+    assembler->mov(asmjit::x86::r12, asmjit::x86::ptr(asmjit::x86::r15, 8));
+    assembler->add(asmjit::x86::r15, 16);
+}
+
 [[maybe_unused]] static void cstoreFromDS() {
     asmjit::x86::Assembler *assembler;
     if (initialize_assembler(assembler)) return;
@@ -598,24 +584,310 @@ void compile_pushVariableAddress(const int64_t literal, const std::string &name)
 
 // primitive i/o
 
+// all output goes through the output buffer, FLUSH or a newline (interactive) writes it out.
 [[maybe_unused]] void spit_str(const char *str) {
-    std::cout << str << std::flush;
+    OutputBuffer::instance().write(str);
 }
 
 [[maybe_unused]] static void spit_number(const int64_t n) {
-    std::cout << std::dec << n << ' ';
+    char num_pad[32];
+    const int len = snprintf(num_pad, sizeof(num_pad), "%lld ", static_cast<long long>(n));
+    OutputBuffer::instance().write(num_pad, len);
 }
 
 [[maybe_unused]] static void spit_number_f(double f) {
-    std::cout << f << ' ';
+    char num_pad[32];
+    const int len = snprintf(num_pad, sizeof(num_pad), "%g ", f);
+    OutputBuffer::instance().write(num_pad, len);
 }
 
 [[maybe_unused]] static void spit_char(const char c) {
-    putchar(c);
+    OutputBuffer::instance().put(c);
+}
+
+// TYPE ( c-addr u -- )
+static void spit_type(const char *str, const int64_t len) {
+    if (len > 0) {
+        OutputBuffer::instance().write(str, static_cast<size_t>(len));
+    }
+}
+
+// FLUSH writes the output buffer and any changed block buffers
+static void spit_flush() {
+    OutputBuffer::instance().flush();
+    if (!BlockCache::instance().saveBuffers()) {
+        SignalHandler::instance().raise(29);
+    }
+}
+
+// number output, BASE is read through this pointer, set when BASE is created
+static int64_t *baseVariable = nullptr;
+
+static unsigned current_base() {
+    const int64_t base = baseVariable ? *baseVariable : 10;
+    return (base < 2 || base > 36) ? 10 : static_cast<unsigned>(base);
+}
+
+// U. . D. format straight into the output buffer, followed by a space
+static void spit_unsigned() {
+    auto &out = OutputBuffer::instance();
+    char *text = out.reserve(INT_TEXT_MAX + 1);
+    size_t len = format_unsigned(static_cast<uint64_t>(cpop()), current_base(), text);
+    text[len++] = ' ';
+    out.commit(len);
+}
+
+static void spit_signed() {
+    auto &out = OutputBuffer::instance();
+    char *text = out.reserve(INT_TEXT_MAX + 1);
+    size_t len = format_signed(cpop(), current_base(), text);
+    text[len++] = ' ';
+    out.commit(len);
+}
+
+static void spit_double() {
+    const int64_t hi = cpop();
+    const auto lo = static_cast<uint64_t>(cpop());
+    auto &out = OutputBuffer::instance();
+    char *text = out.reserve(INT_TEXT_MAX + 1);
+    size_t len = format_double(lo, hi, current_base(), text);
+    text[len++] = ' ';
+    out.commit(len);
+}
+
+// (U.) (.) (D.) ( -- c-addr u ) the text is only good until the next one
+static char numberText[INT_TEXT_MAX];
+
+static void paren_unsigned() {
+    const size_t len = format_unsigned(static_cast<uint64_t>(cpop()), current_base(), numberText);
+    cpush(reinterpret_cast<int64_t>(numberText));
+    cpush(static_cast<int64_t>(len));
+}
+
+static void paren_signed() {
+    const size_t len = format_signed(cpop(), current_base(), numberText);
+    cpush(reinterpret_cast<int64_t>(numberText));
+    cpush(static_cast<int64_t>(len));
+}
+
+static void paren_double() {
+    const int64_t hi = cpop();
+    const auto lo = static_cast<uint64_t>(cpop());
+    const size_t len = format_double(lo, hi, current_base(), numberText);
+    cpush(reinterpret_cast<int64_t>(numberText));
+    cpush(static_cast<int64_t>(len));
+}
+
+// pictured numeric output, <# # #S HOLD SIGN #> build the text right to left in the hold area
+static char holdArea[2 * INT_TEXT_MAX];
+static char *holdPtr = holdArea + sizeof(holdArea);
+
+static void hold_char(const char c) {
+    if (holdPtr == holdArea) {
+        SignalHandler::instance().raise(3);
+        return;
+    }
+    *--holdPtr = c;
+}
+
+// <# ( -- )
+static void hold_start() {
+    holdPtr = holdArea + sizeof(holdArea);
+}
+
+// # ( ud1 -- ud2 ) one digit of ud1, ud2 is ud1 divided by BASE
+static void hold_digit() {
+    __extension__ typedef unsigned __int128 uint128;
+    const auto hi = static_cast<uint64_t>(cpop());
+    const auto lo = static_cast<uint64_t>(cpop());
+    const unsigned base = current_base();
+    const uint128 ud = (static_cast<uint128>(hi) << 64) | lo;
+    const auto digit = static_cast<unsigned>(ud % base);
+    hold_char(static_cast<char>(digit < 10 ? '0' + digit : 'A' + digit - 10));
+    const uint128 rest = ud / base;
+    cpush(static_cast<int64_t>(static_cast<uint64_t>(rest)));
+    cpush(static_cast<int64_t>(static_cast<uint64_t>(rest >> 64)));
+}
+
+// #S ( ud -- 0 0 ) all the remaining digits, at least one
+static void hold_digits() {
+    const auto hi = static_cast<uint64_t>(cpop());
+    const auto lo = static_cast<uint64_t>(cpop());
+    char text[INT_TEXT_MAX];
+    char *end = text + sizeof(text);
+    const char *start = write_unsigned_double_back(lo, hi, current_base(), end);
+    const auto len = end - start;
+    if (holdPtr - holdArea < len) {
+        SignalHandler::instance().raise(3);
+        return;
+    }
+    holdPtr -= len;
+    std::memcpy(holdPtr, start, static_cast<size_t>(len));
+    cpush(0);
+    cpush(0);
+}
+
+// HOLD ( char -- )
+static void hold() {
+    hold_char(static_cast<char>(cpop()));
+}
+
+// SIGN ( n -- ) hold a minus sign if n is negative
+static void hold_sign() {
+    if (cpop() < 0) {
+        hold_char('-');
+    }
+}
+
+// #> ( xd -- c-addr u )
+static void hold_end() {
+    cpop();
+    cpop();
+    cpush(reinterpret_cast<int64_t>(holdPtr));
+    cpush(static_cast<int64_t>(holdArea + sizeof(holdArea) - holdPtr));
+}
+
+// file words, a file id is the descriptor, an ior is 0 or the errno
+static void file_read_only() {
+    cpush(FileIO::READ_ONLY);
+}
+
+static void file_write_only() {
+    cpush(FileIO::WRITE_ONLY);
+}
+
+static void file_read_write() {
+    cpush(FileIO::READ_WRITE);
+}
+
+static void open_or_create_file(const bool create) {
+    const int64_t fam = cpop();
+    const auto len = static_cast<size_t>(cpop());
+    const auto *name = reinterpret_cast<const char *>(cpop());
+    int64_t ior = 0;
+    const int64_t fileId = FileIO::instance().openFile(std::string(name, len), fam, create, ior);
+    cpush(fileId);
+    cpush(ior);
+}
+
+// OPEN-FILE ( c-addr u fam -- fileid ior )
+static void open_file() {
+    open_or_create_file(false);
+}
+
+// CREATE-FILE ( c-addr u fam -- fileid ior ) an existing file is emptied
+static void create_file() {
+    open_or_create_file(true);
+}
+
+// CLOSE-FILE ( fileid -- ior )
+static void close_file() {
+    cpush(FileIO::instance().closeFile(cpop()));
+}
+
+// READ-FILE ( c-addr u1 fileid -- u2 ior )
+static void read_file() {
+    const int64_t fileId = cpop();
+    const auto len = static_cast<uint64_t>(cpop());
+    auto *buffer = reinterpret_cast<void *>(cpop());
+    int64_t ior = 0;
+    cpush(FileIO::instance().readFile(fileId, buffer, len, ior));
+    cpush(ior);
+}
+
+// WRITE-FILE ( c-addr u fileid -- ior )
+static void write_file() {
+    const int64_t fileId = cpop();
+    const auto len = static_cast<uint64_t>(cpop());
+    const auto *buffer = reinterpret_cast<const void *>(cpop());
+    cpush(FileIO::instance().writeFile(fileId, buffer, len));
+}
+
+// FILE-SIZE ( fileid -- ud ior )
+static void file_size() {
+    int64_t ior = 0;
+    cpush(FileIO::instance().fileSize(cpop(), ior));
+    cpush(0);
+    cpush(ior);
+}
+
+// READ-FILE-ASYNC ( c-addr u fileid -- req ) start reading the next u bytes
+static void read_file_async() {
+    const int64_t fileId = cpop();
+    const auto len = static_cast<uint64_t>(cpop());
+    auto *buffer = reinterpret_cast<void *>(cpop());
+    const int64_t request = FileIO::instance().readAsync(fileId, buffer, len);
+    if (request == 0) {
+        SignalHandler::instance().raise(3);
+        return;
+    }
+    cpush(request);
+}
+
+// AWAIT ( req -- n ) bytes read, or a negative errno
+static void await_request() {
+    cpush(FileIO::instance().await(cpop()));
+}
+
+// block words
+static void block_or_buffer(const bool readBlock) {
+    char *addr = BlockCache::instance().block(static_cast<uint64_t>(cpop()), readBlock);
+    if (!addr) {
+        SignalHandler::instance().raise(29);
+        return;
+    }
+    cpush(reinterpret_cast<int64_t>(addr));
+}
+
+// BLOCK ( u -- addr )
+static void get_block() {
+    block_or_buffer(true);
+}
+
+// BUFFER ( u -- addr ) as BLOCK without reading the block from the file
+static void get_buffer() {
+    block_or_buffer(false);
+}
+
+// UPDATE ( -- ) the last block used will be written back
+static void update_block() {
+    BlockCache::instance().update();
+}
+
+// SAVE-BUFFERS ( -- )
+static void save_buffers() {
+    if (!BlockCache::instance().saveBuffers()) {
+        SignalHandler::instance().raise(29);
+    }
+}
+
+// EMPTY-BUFFERS ( -- ) forget all buffers, changed or not
+static void empty_buffers() {
+    BlockCache::instance().emptyBuffers();
+}
+
+// OPEN-BLOCKS ( c-addr u -- ) use another block file
+static void open_blocks() {
+    const auto len = static_cast<size_t>(cpop());
+    const auto *name = reinterpret_cast<const char *>(cpop());
+    if (!BlockCache::instance().open(std::string(name, len))) {
+        SignalHandler::instance().raise(28);
+    }
+}
+
+// BLOCK-BUFFERS ( n u -- ) n buffers of u bytes, 1024 or 4096
+static void block_buffers() {
+    const auto size = static_cast<size_t>(cpop());
+    const auto n = static_cast<size_t>(cpop());
+    if (!BlockCache::instance().configure(n, size)) {
+        SignalHandler::instance().raise(29);
+    }
 }
 
 // unlikely but possible that we might get EOF from stdin
 [[maybe_unused]] static int slurp_char() {
+    // a prompt may be waiting in the buffer
+    OutputBuffer::instance().flush();
     auto c = getchar();
     if (c == EOF) {
         SignalHandler::instance().raise(26); // EOF
@@ -626,26 +898,139 @@ void compile_pushVariableAddress(const int64_t literal, const std::string &name)
 
 
 static void spit_end_line() {
-    putchar('\n');
+    OutputBuffer::instance().put('\n');
 }
 
 static void spit_cls() {
-    std::cout << "\033c";
+    OutputBuffer::instance().write("\033c");
+}
+
+// EMIT fast path, store the character straight into the output buffer.
+// newlines and a nearly full buffer take the slow path through spit_char.
+static void compile_emit_inline(const asmjit::x86::Gp &ch) {
+    asmjit::x86::Assembler *assembler;
+    if (initialize_assembler(assembler)) return;
+    auto &out = OutputBuffer::instance();
+    const asmjit::Label slow = assembler->newLabel();
+    const asmjit::Label done = assembler->newLabel();
+
+    assembler->comment("; -- inline emit to output buffer");
+    assembler->mov(asmjit::x86::rax, asmjit::imm(&out.pos));
+    assembler->mov(asmjit::x86::rcx, asmjit::x86::ptr(asmjit::x86::rax)); // current position
+    assembler->cmp(asmjit::x86::rcx, asmjit::imm(OutputBuffer::CAPACITY - 1));
+    assembler->jae(slow); // buffer full after this char
+    assembler->cmp(ch.r8(), '\n');
+    assembler->je(slow); // newline may need a flush
+    assembler->mov(asmjit::x86::rdx, asmjit::imm(out.buffer));
+    assembler->mov(asmjit::x86::byte_ptr(asmjit::x86::rdx, asmjit::x86::rcx), ch.r8());
+    assembler->add(asmjit::x86::rcx, 1);
+    assembler->mov(asmjit::x86::ptr(asmjit::x86::rax), asmjit::x86::rcx);
+    assembler->jmp(done);
+    assembler->bind(slow);
+    assembler->push(asmjit::x86::rdi);
+    assembler->mov(asmjit::x86::rdi, ch);
+    assembler->call(spit_char);
+    assembler->pop(asmjit::x86::rdi);
+    assembler->bind(done);
+}
+
+// SET COUNTERS ON, the function being compiled updates this record
+static WordStats *countedFunction = nullptr;
+
+// count the call, note the stack depth, and time the outermost call of the word
+static void compile_count_entry(WordStats *stats) {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->comment("; ----- count calls");
+    const asmjit::Label notDeeper = assembler->newLabel();
+    const asmjit::Label nested = assembler->newLabel();
+    assembler->mov(asmjit::x86::rcx, asmjit::imm(stats));
+    assembler->inc(asmjit::x86::qword_ptr(asmjit::x86::rcx, offsetof(WordStats, calls)));
+    assembler->mov(asmjit::x86::rax, asmjit::imm(stack_top));
+    assembler->sub(asmjit::x86::rax, asmjit::x86::r15);
+    assembler->cmp(asmjit::x86::rax, asmjit::x86::qword_ptr(asmjit::x86::rcx, offsetof(WordStats, stackHigh)));
+    assembler->jbe(notDeeper);
+    assembler->mov(asmjit::x86::qword_ptr(asmjit::x86::rcx, offsetof(WordStats, stackHigh)), asmjit::x86::rax);
+    assembler->bind(notDeeper);
+    assembler->cmp(asmjit::x86::qword_ptr(asmjit::x86::rcx, offsetof(WordStats, depth)), 0);
+    assembler->jne(nested);
+    assembler->rdtsc();
+    assembler->shl(asmjit::x86::rdx, 32);
+    assembler->or_(asmjit::x86::rax, asmjit::x86::rdx);
+    assembler->mov(asmjit::x86::qword_ptr(asmjit::x86::rcx, offsetof(WordStats, start)), asmjit::x86::rax);
+    assembler->bind(nested);
+    assembler->inc(asmjit::x86::qword_ptr(asmjit::x86::rcx, offsetof(WordStats, depth)));
+}
+
+// on the way out of the outermost call add the time spent to the word
+static void compile_count_exit(WordStats *stats) {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->comment("; ----- time call");
+    const asmjit::Label nested = assembler->newLabel();
+    assembler->mov(asmjit::x86::rcx, asmjit::imm(stats));
+    assembler->dec(asmjit::x86::qword_ptr(asmjit::x86::rcx, offsetof(WordStats, depth)));
+    assembler->jnz(nested);
+    assembler->rdtsc();
+    assembler->shl(asmjit::x86::rdx, 32);
+    assembler->or_(asmjit::x86::rax, asmjit::x86::rdx);
+    assembler->sub(asmjit::x86::rax, asmjit::x86::qword_ptr(asmjit::x86::rcx, offsetof(WordStats, start)));
+    assembler->add(asmjit::x86::qword_ptr(asmjit::x86::rcx, offsetof(WordStats, cycles)), asmjit::x86::rax);
+    assembler->bind(nested);
+}
+
+// SET TIERED ON, the tier 0 function being compiled and where its body starts
+static TieredWord *tieredFunction = nullptr;
+static asmjit::Label tierBody;
+
+// calls to deferred words in the function being compiled, the label follows the call rel32
+static std::vector<std::pair<const ForthDictionaryEntry *, asmjit::Label> > deferredSites;
+
+// count the call, carry on through target, and on the HOT_CALLS call have the word recompiled first
+static void compile_tier0_entry(TieredWord *word) {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->comment("; ----- tier 0 count calls");
+    const asmjit::Label promote = assembler->newLabel();
+    tierBody = assembler->newLabel();
+    assembler->mov(asmjit::x86::rax, asmjit::imm(&word->calls));
+    assembler->inc(asmjit::x86::qword_ptr(asmjit::x86::rax));
+    assembler->cmp(asmjit::x86::qword_ptr(asmjit::x86::rax), asmjit::imm(Tiering::HOT_CALLS));
+    assembler->je(promote);
+    assembler->mov(asmjit::x86::rax, asmjit::imm(&word->target));
+    assembler->jmp(asmjit::x86::qword_ptr(asmjit::x86::rax));
+    assembler->bind(promote);
+    assembler->push(asmjit::x86::rdi);
+    assembler->mov(asmjit::x86::rdi, asmjit::imm(word));
+    assembler->call(Tiering::promote);
+    assembler->pop(asmjit::x86::rdi);
+    assembler->mov(asmjit::x86::rax, asmjit::imm(&word->target));
+    assembler->jmp(asmjit::x86::qword_ptr(asmjit::x86::rax));
+    assembler->bind(tierBody);
 }
 
 // call at function start
 void code_generator_startFunction(const std::string &name) {
+    code_generator_startFunction(name);
+}
+
+// RBP is set to frame, a tiered function starts with the tier 0 call counter
+void code_generator_startFunction(const std::string &name, const ForthDictionaryEntry *frame, TieredWord *tiered) {
     JitContext::instance().initialize();
+    JitContext::instance().setFunctionName(name);
     asmjit::x86::Assembler *assembler;
     if (initialize_assembler(assembler)) return;
     assembler->align(asmjit::AlignMode::kCode, 16);
     assembler->commentf("; -- enter function: %s ", name.c_str());
+    deferredSites.clear();
+    tieredFunction = tiered;
+    if (tieredFunction) {
+        compile_tier0_entry(tieredFunction);
+    }
     labels.clearLabels();
     labels.createLabel(*assembler, "enter_function");
     labels.bindLabel(*assembler, "enter_function");
     labels.createLabel(*assembler, "exit_label");
-    const ForthDictionary &dict = ForthDictionary::instance();
-    auto entry = dict.getLatestWordAdded();
 
     FunctionEntryExitLabel funcLabels;
     funcLabels.entryLabel = assembler->newLabel();
@@ -657,9 +1042,14 @@ void code_generator_startFunction(const std::string &name) {
     loopStack.push(loopLabel);
 
     assembler->comment("; ----- RBP is set to dictionary entry");
-    assembler->mov(asmjit::x86::rax, asmjit::imm(entry->getAddress()));
+    assembler->mov(asmjit::x86::rax, asmjit::imm(frame->getAddress()));
     // Copy the value from rax into rbp
     assembler->mov(asmjit::x86::rbp, asmjit::x86::rax);
+
+    countedFunction = callCounters ? CallCounters::instance().add(name) : nullptr;
+    if (countedFunction) {
+        compile_count_entry(countedFunction);
+    }
 }
 
 
@@ -677,6 +1067,10 @@ void compile_return() {
     }
     labels.bindLabel(*assembler, "exit_label");
     loopStack.pop();
+    if (countedFunction) {
+        compile_count_exit(countedFunction);
+        countedFunction = nullptr;
+    }
     assembler->ret();
 }
 
@@ -686,7 +1080,23 @@ ForthFunction code_generator_finalizeFunction(const std::string &name) {
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
     assembler->comment(funcName.c_str());
-    return JitContext::instance().finalize();
+    const ForthFunction f = JitContext::instance().finalize();
+    if (f) {
+        for (const auto &[word, label]: deferredSites) {
+            auto *rel32 = reinterpret_cast<uint8_t *>(f) + JitContext::instance().getCode().labelOffset(label) - 4;
+            DeferredWords::instance().addSite(word, rel32);
+        }
+    }
+    deferredSites.clear();
+    if (tieredFunction) {
+        // until the word is hot its calls carry on into its own body
+        if (f) {
+            tieredFunction->code = f;
+            tieredFunction->target = reinterpret_cast<char *>(f) + JitContext::instance().getCode().labelOffset(tierBody);
+        }
+        tieredFunction = nullptr;
+    }
+    return f;
 }
 
 void code_generator_reset() {
@@ -710,6 +1120,22 @@ void compile_call_forth(void (*func)(), const std::string &forth_word) {
     assembler->sub(asmjit::x86::rsp, 8);
     assembler->call(func);
     assembler->add(asmjit::x86::rsp, 8);
+    ++CompilerStats::instance().current().calls;
+}
+
+// a call rel32 patched once the function is finalized, and again by each IS
+void compile_call_deferred(const ForthDictionaryEntry *word, const std::string &forth_word) {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->commentf("; --- call deferred %s", forth_word.c_str());
+    assembler->sub(asmjit::x86::rsp, 8);
+    static constexpr uint8_t call_rel32[] = {0xE8, 0, 0, 0, 0};
+    assembler->embed(call_rel32, sizeof(call_rel32));
+    const asmjit::Label site = assembler->newLabel();
+    assembler->bind(site);
+    assembler->add(asmjit::x86::rsp, 8);
+    deferredSites.emplace_back(word, site);
+    ++CompilerStats::instance().current().calls;
 }
 
 void compile_call_C_char(void (*func)(char *)) {
@@ -814,8 +1240,8 @@ static void compile_NIP() {
     initialize_assembler(assembler);
     // NIP ( x1 x2 -- x2 )
     assembler->comment("; -- NIP ");
-    assembler->add(asmjit::x86::r15, 8); // Discard TOS-1 (move stack pointer up)
-    assembler->mov(asmjit::x86::r12, asmjit::x86::r13); // Move TOS into TOS-1
+    assembler->mov(asmjit::x86::r12, asmjit::x86::ptr(asmjit::x86::r15)); // Move TOS-2 into TOS-1
+    assembler->add(asmjit::x86::r15, 8); // Adjust stack pointer
 }
 
 // R15 full descending stack R13=TOS, R12=TOS-1 [R15]=TOS-2
@@ -1104,6 +1530,107 @@ static void compile_ERASE() {
 }
 
 
+// memory mapped files
+// the result comes back in rax:rdx so the JIT can place it straight into r12:r13
+struct MappedRegion {
+    void *addr;
+    uint64_t len;
+};
+
+static MappedRegion map_file_mode(const char *name, const uint64_t len, const bool writable) {
+    size_t mapped = 0;
+    void *addr = WordHeap::instance().mapFile(std::string(name, len), mapped, writable, mapPopulate, mapHugePages);
+    if (!addr) {
+        SignalHandler::instance().raise(27);
+    }
+    return {addr, mapped};
+}
+
+static MappedRegion map_file_read(const char *name, const uint64_t len) {
+    return map_file_mode(name, len, false);
+}
+
+static MappedRegion map_file_write(const char *name, const uint64_t len) {
+    return map_file_mode(name, len, true);
+}
+
+static void unmap_file(const void *addr, [[maybe_unused]] uint64_t len) {
+    if (!WordHeap::instance().unmapFile(addr)) {
+        SignalHandler::instance().raise(3);
+    }
+}
+
+// advice follows posix_madvise numbering, 0 normal, 1 random, 2 sequential, 3 will need, 4 don't need
+static void madvise_range(void *addr, const uint64_t len, const uint64_t advice) {
+    static constexpr int advice_flags[] = {MADV_NORMAL, MADV_RANDOM, MADV_SEQUENTIAL, MADV_WILLNEED, MADV_DONTNEED};
+    if (advice >= sizeof(advice_flags) / sizeof(advice_flags[0])) {
+        SignalHandler::instance().raise(3);
+        return;
+    }
+    // madvise wants a page aligned start address
+    const auto page = static_cast<uintptr_t>(getpagesize());
+    const auto start = reinterpret_cast<uintptr_t>(addr) & ~(page - 1);
+    const auto length = len + (reinterpret_cast<uintptr_t>(addr) - start);
+    if (madvise(reinterpret_cast<void *>(start), length, advice_flags[advice]) != 0) {
+        SignalHandler::instance().raise(3);
+    }
+}
+
+static void compile_map_file(MappedRegion (*mapper)(const char *, uint64_t)) {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    // MAP-FILE ( c-addr u -- addr len )
+    assembler->push(asmjit::x86::rdi);
+    assembler->mov(asmjit::x86::rdi, asmjit::x86::r12); // file name
+    assembler->mov(asmjit::x86::rsi, asmjit::x86::r13); // file name length
+    assembler->call(mapper);
+    assembler->pop(asmjit::x86::rdi);
+    assembler->mov(asmjit::x86::r12, asmjit::x86::rax); // mapped address
+    assembler->mov(asmjit::x86::r13, asmjit::x86::rdx); // mapped length
+}
+
+static void compile_MAP_FILE() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->comment("; -- MAP-FILE ");
+    compile_map_file(map_file_read);
+}
+
+static void compile_MAP_FILE_RW() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->comment("; -- MAP-FILE-RW ");
+    compile_map_file(map_file_write);
+}
+
+static void compile_UNMAP_FILE() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    // UNMAP-FILE ( addr len -- )
+    assembler->comment("; -- UNMAP-FILE ");
+    assembler->push(asmjit::x86::rdi);
+    assembler->mov(asmjit::x86::rdi, asmjit::x86::r12); // addr
+    assembler->mov(asmjit::x86::rsi, asmjit::x86::r13); // len
+    assembler->call(unmap_file);
+    assembler->pop(asmjit::x86::rdi);
+    compile_2DROP();
+}
+
+static void compile_MADVISE() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    // MADVISE ( addr len advice -- )
+    assembler->comment("; -- MADVISE ");
+    assembler->push(asmjit::x86::rdi);
+    assembler->mov(asmjit::x86::rdi, ptr(asmjit::x86::r15)); // addr
+    assembler->mov(asmjit::x86::rsi, asmjit::x86::r12); // len
+    assembler->mov(asmjit::x86::rdx, asmjit::x86::r13); // advice
+    assembler->call(madvise_range);
+    assembler->pop(asmjit::x86::rdi);
+    compile_2DROP();
+    compile_DROP();
+}
+
 void code_generator_add_memory_words() {
     auto &dict = ForthDictionary::instance();
 
@@ -1111,14 +1638,14 @@ void code_generator_add_memory_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_FILL),
-                     code_generator_build_forth(compile_FILL),
+                     code_generator_build_forth("FILL", compile_FILL),
                      nullptr);
 
     dict.addCodeWord("BLANK", "UNSAFE",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_BLANK),
-                     code_generator_build_forth(compile_BLANK),
+                     code_generator_build_forth("BLANK", compile_BLANK),
                      nullptr);
 
 
@@ -1126,7 +1653,35 @@ void code_generator_add_memory_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_ERASE),
-                     code_generator_build_forth(compile_ERASE),
+                     code_generator_build_forth("ERASE", compile_ERASE),
+                     nullptr);
+
+    dict.addCodeWord("MAP-FILE", "UNSAFE",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&compile_MAP_FILE),
+                     code_generator_build_forth("MAP-FILE", compile_MAP_FILE),
+                     nullptr);
+
+    dict.addCodeWord("MAP-FILE-RW", "UNSAFE",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&compile_MAP_FILE_RW),
+                     code_generator_build_forth("MAP-FILE-RW", compile_MAP_FILE_RW),
+                     nullptr);
+
+    dict.addCodeWord("UNMAP-FILE", "UNSAFE",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&compile_UNMAP_FILE),
+                     code_generator_build_forth("UNMAP-FILE", compile_UNMAP_FILE),
+                     nullptr);
+
+    dict.addCodeWord("MADVISE", "UNSAFE",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&compile_MADVISE),
+                     code_generator_build_forth("MADVISE", compile_MADVISE),
                      nullptr);
 }
 
@@ -1324,11 +1879,10 @@ void *rdepth() {
 
 
 // Used to build a working forth word, that can be executed by the compiler.
-ForthFunction code_generator_build_forth(const ForthFunction fn) {
+// name is the word being added, its entry does not exist yet while the code is built
+ForthFunction code_generator_build_forth(const std::string &name, const ForthFunction fn) {
     // we need to start a new function
-    ForthDictionary &dict = ForthDictionary::instance();
-
-    code_generator_startFunction(dict.getLatestName());
+    code_generator_startFunction(name);
     fn();
     compile_return();
     const auto f = reinterpret_cast<ForthFunction>(JitContext::instance().finalize());
@@ -1346,7 +1900,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_r2Drop),
-                     code_generator_build_forth(Compile_r2Drop),
+                     code_generator_build_forth("2RDROP", Compile_r2Drop),
                      nullptr);
 
 
@@ -1355,7 +1909,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_rDrop),
-                     code_generator_build_forth(Compile_rDrop),
+                     code_generator_build_forth("RDROP", Compile_rDrop),
                      nullptr);
 
 
@@ -1364,7 +1918,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_rSwap),
-                     code_generator_build_forth(Compile_rSwap),
+                     code_generator_build_forth("R>R", Compile_rSwap),
                      nullptr);
 
     dict.addCodeWord("DEPTH", "FORTH",
@@ -1386,21 +1940,28 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&storeFromDS),
-                     code_generator_build_forth(storeFromDS),
+                     code_generator_build_forth("!", storeFromDS),
+                     nullptr);
+
+    dict.addCodeWord("+!", "UNSAFE",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&plusStoreFromDS),
+                     code_generator_build_forth("+!", plusStoreFromDS),
                      nullptr);
 
     dict.addCodeWord("C!", "UNSAFE",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&cstoreFromDS),
-                     code_generator_build_forth(cstoreFromDS),
+                     code_generator_build_forth("C!", cstoreFromDS),
                      nullptr);
 
     dict.addCodeWord("C@", "UNSAFE",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&cfetchFromDS),
-                     code_generator_build_forth(cfetchFromDS),
+                     code_generator_build_forth("C@", cfetchFromDS),
                      nullptr);
 
 
@@ -1408,7 +1969,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&fetchFromDS),
-                     code_generator_build_forth(fetchFromDS),
+                     code_generator_build_forth("@", fetchFromDS),
                      nullptr);
 
     // R@
@@ -1416,14 +1977,14 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_rFetch),
-                     code_generator_build_forth(Compile_rFetch),
+                     code_generator_build_forth("R@", Compile_rFetch),
                      nullptr);
 
     dict.addCodeWord("RP@", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_rpAt),
-                     code_generator_build_forth(Compile_rpAt),
+                     code_generator_build_forth("RP@", Compile_rpAt),
                      nullptr);
 
     // RP!
@@ -1431,7 +1992,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_rpStore),
-                     code_generator_build_forth(Compile_rpStore),
+                     code_generator_build_forth("RP!", Compile_rpStore),
                      nullptr);
 
     // >R
@@ -1439,7 +2000,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_toR),
-                     code_generator_build_forth(Compile_toR),
+                     code_generator_build_forth(">R", Compile_toR),
                      nullptr
     );
 
@@ -1447,7 +2008,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_2toR),
-                     code_generator_build_forth(Compile_2toR),
+                     code_generator_build_forth("2>R", Compile_2toR),
                      nullptr
     );
 
@@ -1456,7 +2017,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_2xtoR),
-                     code_generator_build_forth(Compile_2xtoR),
+                     code_generator_build_forth("2X>R", Compile_2xtoR),
                      nullptr
     );
 
@@ -1465,7 +2026,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_fromR),
-                     code_generator_build_forth(Compile_fromR),
+                     code_generator_build_forth("R>", Compile_fromR),
                      nullptr
     );
 
@@ -1473,7 +2034,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_2fromR),
-                     code_generator_build_forth(Compile_2fromR),
+                     code_generator_build_forth("2R>", Compile_2fromR),
                      nullptr
     );
 
@@ -1482,7 +2043,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&Compile_2xR),
-                     code_generator_build_forth(Compile_2xR),
+                     code_generator_build_forth("2xR>", Compile_2xR),
                      nullptr
     );
 
@@ -1492,7 +2053,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_DUP),
-                     code_generator_build_forth(compile_DUP),
+                     code_generator_build_forth("DUP", compile_DUP),
                      nullptr);
 
 
@@ -1501,7 +2062,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_DROP),
-                     code_generator_build_forth(compile_DROP),
+                     code_generator_build_forth("DROP", compile_DROP),
                      nullptr);
 
     // 2DROP
@@ -1509,7 +2070,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_2DROP),
-                     code_generator_build_forth(compile_2DROP),
+                     code_generator_build_forth("2DROP", compile_2DROP),
                      nullptr);
 
     // SWAP
@@ -1517,7 +2078,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_SWAP),
-                     code_generator_build_forth(compile_SWAP),
+                     code_generator_build_forth("SWAP", compile_SWAP),
                      nullptr);
 
     // OVER
@@ -1525,7 +2086,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_OVER),
-                     code_generator_build_forth(compile_OVER),
+                     code_generator_build_forth("OVER", compile_OVER),
                      nullptr);
 
     // ROT
@@ -1533,7 +2094,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_ROT),
-                     code_generator_build_forth(compile_ROT),
+                     code_generator_build_forth("ROT", compile_ROT),
                      nullptr);
 
     // -ROT
@@ -1541,7 +2102,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_MROT),
-                     code_generator_build_forth(compile_MROT),
+                     code_generator_build_forth("-ROT", compile_MROT),
                      nullptr);
 
     // NIP
@@ -1549,7 +2110,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_NIP),
-                     code_generator_build_forth(compile_NIP),
+                     code_generator_build_forth("NIP", compile_NIP),
                      nullptr);
 
     // TUCK
@@ -1557,7 +2118,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_TUCK),
-                     code_generator_build_forth(compile_TUCK),
+                     code_generator_build_forth("TUCK", compile_TUCK),
                      nullptr);
 
     // PICK
@@ -1565,7 +2126,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_PICK),
-                     code_generator_build_forth(compile_PICK),
+                     code_generator_build_forth("PICK", compile_PICK),
                      nullptr);
 
     // ROLL
@@ -1573,7 +2134,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_ROLL),
-                     code_generator_build_forth(compile_ROLL),
+                     code_generator_build_forth("ROLL", compile_ROLL),
                      nullptr);
 
     // 2DUP
@@ -1581,7 +2142,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_2DUP),
-                     code_generator_build_forth(compile_2DUP),
+                     code_generator_build_forth("2DUP", compile_2DUP),
                      nullptr);
 
     // 2OVER
@@ -1589,7 +2150,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compiler_2OVER),
-                     code_generator_build_forth(compiler_2OVER),
+                     code_generator_build_forth("2OVER", compiler_2OVER),
                      nullptr);
 
     // SP@
@@ -1597,7 +2158,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_AT),
-                     code_generator_build_forth(compile_AT),
+                     code_generator_build_forth("SP@", compile_AT),
                      nullptr);
 
     // SP!
@@ -1605,7 +2166,7 @@ void code_generator_add_stack_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_SP_STORE),
-                     code_generator_build_forth(compile_SP_STORE),
+                     code_generator_build_forth("SP!", compile_SP_STORE),
                      nullptr);
 }
 
@@ -1951,6 +2512,70 @@ static void compile_EQ() {
     assembler->add(asmjit::x86::r15, 8); // Adjust stack pointer
 }
 
+static void compile_ZERO_EQ() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+
+    assembler->comment("; -- 0= (equal to zero)");
+
+    assembler->test(asmjit::x86::r13, asmjit::x86::r13);
+    assembler->sete(asmjit::x86::al);
+    assembler->movzx(asmjit::x86::rax, asmjit::x86::al);
+    assembler->neg(asmjit::x86::rax);
+    assembler->mov(asmjit::x86::r13, asmjit::x86::rax);
+}
+
+static void compile_MIN() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    // MIN ( a b -- min )
+    assembler->comment("; -- MIN");
+    assembler->cmp(asmjit::x86::r12, asmjit::x86::r13);
+    assembler->cmovl(asmjit::x86::r13, asmjit::x86::r12); // TOS = a when a < b
+    assembler->mov(asmjit::x86::r12, asmjit::x86::ptr(asmjit::x86::r15));
+    assembler->add(asmjit::x86::r15, 8);
+}
+
+static void compile_MAX() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    // MAX ( a b -- max )
+    assembler->comment("; -- MAX");
+    assembler->cmp(asmjit::x86::r12, asmjit::x86::r13);
+    assembler->cmovg(asmjit::x86::r13, asmjit::x86::r12); // TOS = a when a > b
+    assembler->mov(asmjit::x86::r12, asmjit::x86::ptr(asmjit::x86::r15));
+    assembler->add(asmjit::x86::r15, 8);
+}
+
+static void compile_CLAMP() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    // CLAMP ( n lo hi -- n' ) n limited to lo..hi
+    assembler->comment("; -- CLAMP");
+    assembler->mov(asmjit::x86::rax, asmjit::x86::ptr(asmjit::x86::r15)); // n is TOS-2
+    assembler->cmp(asmjit::x86::rax, asmjit::x86::r12);
+    assembler->cmovl(asmjit::x86::rax, asmjit::x86::r12); // at least lo
+    assembler->cmp(asmjit::x86::rax, asmjit::x86::r13);
+    assembler->cmovg(asmjit::x86::rax, asmjit::x86::r13); // at most hi
+    assembler->mov(asmjit::x86::r13, asmjit::x86::rax);
+    assembler->mov(asmjit::x86::r12, asmjit::x86::ptr(asmjit::x86::r15, 8));
+    assembler->add(asmjit::x86::r15, 16);
+}
+
+static void compile_WITHIN() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    // WITHIN ( n lo hi -- flag ) true when lo <= n < hi, as one unsigned compare
+    assembler->comment("; -- WITHIN");
+    assembler->mov(asmjit::x86::rax, asmjit::x86::ptr(asmjit::x86::r15)); // n is TOS-2
+    assembler->sub(asmjit::x86::rax, asmjit::x86::r12); // n - lo
+    assembler->sub(asmjit::x86::r13, asmjit::x86::r12); // hi - lo
+    assembler->cmp(asmjit::x86::rax, asmjit::x86::r13);
+    assembler->sbb(asmjit::x86::r13, asmjit::x86::r13); // -1 when below, 0 otherwise
+    assembler->mov(asmjit::x86::r12, asmjit::x86::ptr(asmjit::x86::r15, 8));
+    assembler->add(asmjit::x86::r15, 16);
+}
+
 static void compile_NEQ() {
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
@@ -1975,7 +2600,7 @@ void code_generator_add_operator_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      compile_EXEC,
-                     code_generator_build_forth(compile_EXEC),
+                     code_generator_build_forth("EXEC", compile_EXEC),
                      nullptr);
 
 
@@ -1983,21 +2608,21 @@ void code_generator_add_operator_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_EQ),
-                     code_generator_build_forth(compile_EQ),
+                     code_generator_build_forth("=", compile_EQ),
                      nullptr);
 
     dict.addCodeWord("<>", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_NEQ),
-                     code_generator_build_forth(compile_NEQ),
+                     code_generator_build_forth("<>", compile_NEQ),
                      nullptr);
 
     dict.addCodeWord("<", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_LT),
-                     code_generator_build_forth(compile_LT),
+                     code_generator_build_forth("<", compile_LT),
                      nullptr);
 
 
@@ -2005,7 +2630,7 @@ void code_generator_add_operator_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_GT),
-                     code_generator_build_forth(compile_GT),
+                     code_generator_build_forth(">", compile_GT),
                      nullptr);
 
 
@@ -2013,51 +2638,86 @@ void code_generator_add_operator_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_LE),
-                     code_generator_build_forth(compile_LE),
+                     code_generator_build_forth("<=", compile_LE),
                      nullptr);
 
-    dict.addCodeWord("/MOD", "FORTH",
+    dict.addCodeWord("0=", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
-                     static_cast<ForthFunction>(&compile_DIVMOD),
-                     code_generator_build_forth(compile_DIVMOD),
+                     static_cast<ForthFunction>(&compile_ZERO_EQ),
+                     code_generator_build_forth("0=", compile_ZERO_EQ),
                      nullptr);
 
-    dict.addCodeWord("*/", "FORTH",
+    dict.addCodeWord("MIN", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
-                     nullptr,
-                     code_generator_build_forth(compile_SCALE),
+                     static_cast<ForthFunction>(&compile_MIN),
+                     code_generator_build_forth("MIN", compile_MIN),
                      nullptr);
 
-
-    dict.addCodeWord("*/MOD", "FORTH",
+    dict.addCodeWord("MAX", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
-                     static_cast<ForthFunction>(&compile_SCALEMOD),
-                     code_generator_build_forth(compile_SCALEMOD),
+                     static_cast<ForthFunction>(&compile_MAX),
+                     code_generator_build_forth("MAX", compile_MAX),
                      nullptr);
 
-
-    dict.addCodeWord("SQRT", "FORTH",
+    dict.addCodeWord("CLAMP", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
-                     static_cast<ForthFunction>(&compile_SQRT),
-                     code_generator_build_forth(compile_SQRT),
+                     static_cast<ForthFunction>(&compile_CLAMP),
+                     code_generator_build_forth("CLAMP", compile_CLAMP),
                      nullptr);
 
-    dict.addCodeWord("XOR", "FORTH",
+    dict.addCodeWord("WITHIN", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&compile_WITHIN),
+                     code_generator_build_forth("WITHIN", compile_WITHIN),
+                     nullptr);
+
+    dict.addCodeWord("/MOD", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&compile_DIVMOD),
+                     code_generator_build_forth("/MOD", compile_DIVMOD),
+                     nullptr);
+
+    dict.addCodeWord("*/", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     code_generator_build_forth("*/", compile_SCALE),
+                     nullptr);
+
+
+    dict.addCodeWord("*/MOD", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&compile_SCALEMOD),
+                     code_generator_build_forth("*/MOD", compile_SCALEMOD),
+                     nullptr);
+
+
+    dict.addCodeWord("SQRT", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&compile_SQRT),
+                     code_generator_build_forth("SQRT", compile_SQRT),
+                     nullptr);
+
+    dict.addCodeWord("XOR", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_XOR),
-                     code_generator_build_forth(compile_XOR),
+                     code_generator_build_forth("XOR", compile_XOR),
                      nullptr);
 
     dict.addCodeWord("NOT", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_NOT),
-                     code_generator_build_forth(compile_NOT),
+                     code_generator_build_forth("NOT", compile_NOT),
                      nullptr);
 
 
@@ -2065,14 +2725,14 @@ void code_generator_add_operator_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_ADD),
-                     code_generator_build_forth(compile_ADD),
+                     code_generator_build_forth("+", compile_ADD),
                      nullptr);
 
     dict.addCodeWord("-", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_SUB),
-                     code_generator_build_forth(compile_SUB),
+                     code_generator_build_forth("-", compile_SUB),
                      nullptr
     );
 
@@ -2080,7 +2740,7 @@ void code_generator_add_operator_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_NEG),
-                     code_generator_build_forth(compile_NEG),
+                     code_generator_build_forth("NEGATE", compile_NEG),
                      nullptr
     );
 
@@ -2088,7 +2748,7 @@ void code_generator_add_operator_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_NEG_CHECK),
-                     code_generator_build_forth(compile_NEG_CHECK),
+                     code_generator_build_forth(".-", compile_NEG_CHECK),
                      nullptr
     );
 
@@ -2096,7 +2756,7 @@ void code_generator_add_operator_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_ABS),
-                     code_generator_build_forth(compile_ABS),
+                     code_generator_build_forth("ABS", compile_ABS),
                      nullptr
     );
 
@@ -2105,14 +2765,14 @@ void code_generator_add_operator_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_MUL),
-                     code_generator_build_forth(compile_MUL),
+                     code_generator_build_forth("*", compile_MUL),
                      nullptr);
 
     dict.addCodeWord("/", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_DIV),
-                     code_generator_build_forth(compile_DIV),
+                     code_generator_build_forth("/", compile_DIV),
                      nullptr);
 
 
@@ -2120,21 +2780,21 @@ void code_generator_add_operator_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_UDIV),
-                     code_generator_build_forth(compile_UDIV),
+                     code_generator_build_forth("U/", compile_UDIV),
                      nullptr);
 
     dict.addCodeWord("MOD", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_MOD),
-                     code_generator_build_forth(compile_MOD),
+                     code_generator_build_forth("MOD", compile_MOD),
                      nullptr);
 
     dict.addCodeWord("UMOD", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_UMOD),
-                     code_generator_build_forth(compile_UMOD),
+                     code_generator_build_forth("UMOD", compile_UMOD),
                      nullptr);
 
 
@@ -2142,14 +2802,14 @@ void code_generator_add_operator_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_AND),
-                     code_generator_build_forth(compile_AND),
+                     code_generator_build_forth("AND", compile_AND),
                      nullptr);
 
     dict.addCodeWord("OR", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_OR),
-                     code_generator_build_forth(compile_OR),
+                     code_generator_build_forth("OR", compile_OR),
                      nullptr);
 }
 
@@ -2158,13 +2818,13 @@ void code_generator_add_operator_words() {
 
 
 void code_generator_puts_no_crlf(const char *str) {
-    std::cout << str;
+    OutputBuffer::instance().write(str);
 }
 
 
 // immediate interpreter words
 // ."
-void runImmediateString(std::deque<ForthToken> &tokens) {
+void runImmediateString(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -2173,35 +2833,33 @@ void runImmediateString(std::deque<ForthToken> &tokens) {
         SignalHandler::instance().raise(11);
         return;
     }
-    code_generator_puts_no_crlf(first.value.c_str());
-    tokens.erase(tokens.begin());
+    OutputBuffer::instance().write(first.value.data(), first.value.size());
+    tokens.pop_front();
 }
 
 
-void runImmediateTICK(std::deque<ForthToken> &tokens) {
+void runImmediateTICK(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
     // Get and remove the first token
     const ForthToken first = tokens.front();
     const auto word_name = first.value;
-    tokens.erase(tokens.begin());
+    tokens.pop_front();
     auto &dict = ForthDictionary::instance();
-    auto word = dict.findWord(word_name.c_str());
+    auto word = dict.findWord(word_name);
     if (word == nullptr) {
         SignalHandler::instance().raise(14);
     }
-    cpush(reinterpret_cast<uint64_t>(word->executable));
+    cpush(reinterpret_cast<uint64_t>(DeferredWords::instance().xt(word)));
 }
 
-void compileImmediateTICK(std::deque<ForthToken> &tokens) {
+void compileImmediateTICK(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
-    // Get and remove the first token
-    const ForthToken first = tokens.front();
-
-    tokens.erase(tokens.begin());
+    // Remove ['] and read the word after it
+    tokens.pop_front();
     const ForthToken second = tokens.front();
     const auto word_name = second.value;
     auto &dict = ForthDictionary::instance();
-    auto word = dict.findWord(word_name.c_str());
+    auto word = dict.findWord(word_name);
     if (word == nullptr) {
         SignalHandler::instance().raise(14);
     }
@@ -2209,21 +2867,21 @@ void compileImmediateTICK(std::deque<ForthToken> &tokens) {
     initialize_assembler(assembler);
     assembler->comment("; -- TICK");
     compile_DUP();
-    assembler->mov(asmjit::x86::r13, reinterpret_cast<uint64_t>(word->executable));
+    assembler->mov(asmjit::x86::r13, reinterpret_cast<uint64_t>(DeferredWords::instance().xt(word)));
 }
 
-void runImmediateCHAR(std::deque<ForthToken> &tokens) {
+void runImmediateCHAR(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
     // Get and remove the first token
     const ForthToken first = tokens.front();
-    const int c = static_cast<unsigned char>(first.value[0]);
-    tokens.erase(tokens.begin());
+    const int c = first.value.empty() ? 0 : static_cast<unsigned char>(first.value[0]);
+    tokens.pop_front();
     cpush(c);
 }
 
 
 // CREATE creates a new WORD
-void runImmediateCREATE(std::deque<ForthToken> &tokens) {
+void runImmediateCREATE(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -2238,14 +2896,15 @@ void runImmediateCREATE(std::deque<ForthToken> &tokens) {
 
     // Create the dictionary entry WITHOUT setting the executable first
     auto entry = dict.addCodeWord(
-        first.value,
+        std::string(first.value),
         "FORTH",
         ForthState::EXECUTABLE,
         ForthWordType::WORD,
         nullptr, // Placeholder - executable logic will be set later
         nullptr,
         nullptr);
-    tokens.erase(tokens.begin()); // Remove the processed token
+    tokens.pop_front(); // Remove the processed token
+    entry->effect = StackEffect{0, 1};
 
     const auto address = reinterpret_cast<uintptr_t>(&entry->executable);
     JitContext::instance().initialize();
@@ -2266,7 +2925,7 @@ void runImmediateCREATE(std::deque<ForthToken> &tokens) {
 }
 
 
-void runImmediateVARIABLE(std::deque<ForthToken> &tokens) {
+void runImmediateVARIABLE(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -2276,13 +2935,13 @@ void runImmediateVARIABLE(std::deque<ForthToken> &tokens) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
         return;
     }
-    tokens.erase(tokens.begin()); // Remove the processed token
+    tokens.pop_front(); // Remove the processed token
 
     auto &dict = ForthDictionary::instance();
 
     // Create the dictionary entry WITHOUT setting the executable first
     const auto entry = dict.addCodeWord(
-        first.value,
+        std::string(first.value),
         "FORTH",
         ForthState::EXECUTABLE,
         ForthWordType::VARIABLE,
@@ -2447,12 +3106,12 @@ bool create_variable_allot(const std::string &name, size_t byteCount) {
 }
 
 // shortcut for reading variable e.g base @
-void runImmediateVAR_AT(std::deque<ForthToken> &tokens) {
+void runImmediateVAR_AT(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
     // Get and remove the first token
     const ForthToken &first = tokens.front();
     const auto &dict = ForthDictionary::instance();
-    auto var_word = dict.findWord(first.value.c_str());
+    auto var_word = dict.findWord(first.value);
 
     if (!var_word || var_word->type != ForthWordType::VARIABLE) {
         std::cout << "Error: " << first.value << " is not a variable" << std::endl;
@@ -2462,21 +3121,21 @@ void runImmediateVAR_AT(std::deque<ForthToken> &tokens) {
 
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
-    assembler->commentf("; %s @ ", first.value.c_str());
+    assembler->commentf("; %.*s @ ", static_cast<int>(first.value.size()), first.value.data());
     assembler->mov(asmjit::x86::rax, asmjit::imm(address));
     compile_DUP();
     assembler->mov(asmjit::x86::r13, asmjit::x86::ptr(asmjit::x86::rax));
-    assembler->commentf("; TOS holds [%s]", first.value.c_str());
+    assembler->commentf("; TOS holds [%.*s]", static_cast<int>(first.value.size()), first.value.data());
 }
 
 
 // shortcut for seting variable e.g n base !
-void runImmediateVAR_STORE(std::deque<ForthToken> &tokens) {
+void runImmediateVAR_STORE(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
     // Get and remove the first token
     const ForthToken &first = tokens.front();
     const auto &dict = ForthDictionary::instance();
-    const auto var_word = dict.findWord(first.value.c_str());
+    const auto var_word = dict.findWord(first.value);
 
     if (!var_word || var_word->type != ForthWordType::VARIABLE) {
         std::cout << "Error: " << first.value << " is not a variable" << std::endl;
@@ -2486,30 +3145,29 @@ void runImmediateVAR_STORE(std::deque<ForthToken> &tokens) {
 
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
-    assembler->commentf("; %s ! ", first.value.c_str());
+    assembler->commentf("; %.*s ! ", static_cast<int>(first.value.size()), first.value.data());
     assembler->mov(asmjit::x86::rax, asmjit::imm(address));
     assembler->mov(asmjit::x86::ptr(asmjit::x86::rax), asmjit::x86::r13);
     compile_DROP();
 }
 
 // shortcut for c@ emit
-void runImmediateCAT_EMIT(std::deque<ForthToken> &tokens) {
+void runImmediateCAT_EMIT(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
     // directly spit out the contents of the TOS with EMIT
 
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
     assembler->comment("; -- C@ EMIT");
-    assembler->push(asmjit::x86::rdi);
-    assembler->mov(asmjit::x86::rdi, asmjit::x86::ptr(asmjit::x86::r13));
-    assembler->call(spit_char);
-    assembler->pop(asmjit::x86::rdi);
+    assembler->movzx(asmjit::x86::esi, asmjit::x86::byte_ptr(asmjit::x86::r13));
+    compile_emit_inline(asmjit::x86::rsi);
     compile_DROP();
 }
 
 // this is where predefined variables are created
 void code_generator_add_variables() {
     create_variable("BASE", 10);
+    baseVariable = static_cast<int64_t *>(ForthDictionary::instance().findWord("BASE")->data);
     create_variable(">IN", 0);
     create_variable("SPAN", 0);
     create_variable_allot("PAD", 512);
@@ -2523,7 +3181,7 @@ static void defer_initial() {
 }
 
 // DEFER creates a word with no assigned behaviour.
-void runImmediateDEFER(std::deque<ForthToken> &tokens) {
+void runImmediateDEFER(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -2535,42 +3193,84 @@ void runImmediateDEFER(std::deque<ForthToken> &tokens) {
     }
 
     auto &dict = ForthDictionary::instance();
-
-    // Create the dictionary entry WITHOUT setting the executable first
-    dict.addCodeWord(
-        first.value,
+    const std::string name(first.value);
+    auto entry = dict.addCodeWord(
+        name,
         "FORTH",
         ForthState::EXECUTABLE,
         ForthWordType::WORD,
-        nullptr, // Placeholder - executable logic will be set later
-        reinterpret_cast<ForthFunction>(defer_initial),
+        nullptr,
+        nullptr, // set to the action below
         nullptr);
-    tokens.erase(tokens.begin()); // Remove the processed token
+    tokens.pop_front(); // Remove the processed token
+    if (!entry) {
+        SignalHandler::instance().raise(11);
+        return;
+    }
+
+    DeferredWord &deferred = DeferredWords::instance().add(entry, reinterpret_cast<ForthFunction>(defer_initial));
+
+    // the thunk jumps to whatever the action is now
+    JitContext::instance().initialize();
+    JitContext::instance().setFunctionName(name);
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->commentf("; -- DEFER %s", name.c_str());
+    assembler->mov(asmjit::x86::rax, asmjit::imm(&deferred.action));
+    assembler->jmp(asmjit::x86::qword_ptr(asmjit::x86::rax));
+    deferred.thunk = JitContext::instance().finalize();
+    if (!deferred.thunk) {
+        SignalHandler::instance().raise(12);
+    }
 }
 
+// the deferred word IS names, it must have been made by DEFER
+static ForthDictionaryEntry *deferred_word_named(const std::string_view name) {
+    auto *entry = ForthDictionary::instance().findWord(name);
+    if (!entry || !DeferredWords::instance().deferred(entry)) {
+        std::cerr << "IS: " << name << " is not a deferred word" << std::endl;
+        SignalHandler::instance().raise(14);
+        return nullptr;
+    }
+    return entry;
+}
 
-// IS new_action deferred_word
-void runImmediateIS(std::deque<ForthToken> &tokens) {
+// xt IS deferred_word
+void runImmediateIS(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
-    // Get and remove the first token
-    // The first word is the new action
     const ForthToken first = tokens.front();
-    tokens.erase(tokens.begin()); // Remove the processed token
-    auto word_name = first.value;
-    auto &dict = ForthDictionary::instance();
-    auto second_word = dict.findWord(word_name.c_str());
-    if (!second_word) {
-        SignalHandler::instance().raise(14); // Invalid token - raise an error
+    tokens.pop_front(); // Remove the processed token
+    auto *entry = deferred_word_named(first.value);
+    if (!entry) return;
+    const auto action = reinterpret_cast<ForthFunction>(cpop());
+    DeferredWords::instance().retarget(entry, action);
+}
+
+static void deferred_is(ForthDictionaryEntry *entry, const ForthFunction action) {
+    DeferredWords::instance().retarget(entry, action);
+}
+
+// IS in a definition, the xt comes from the stack when the word runs
+void compileImmediateIS(TokenStream &tokens) {
+    if (tokens.empty()) return; // Exit early if no tokens to process
+    // Remove IS and read the word after it
+    tokens.pop_front();
+    if (tokens.empty()) {
+        SignalHandler::instance().raise(14);
         return;
     }
-    auto ptr = &second_word->executable;
+    auto *entry = deferred_word_named(tokens.front().value);
+    if (!entry) return;
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
     assembler->comment("; -- IS ");
-    assembler->mov(asmjit::x86::rax, reinterpret_cast<uint64_t>(ptr));
-    assembler->mov(asmjit::x86::r13, asmjit::x86::ptr(asmjit::x86::rax));
+    assembler->mov(asmjit::x86::rsi, asmjit::x86::r13);
     compile_DROP();
+    assembler->push(asmjit::x86::rdi);
+    assembler->mov(asmjit::x86::rdi, asmjit::imm(entry));
+    assembler->call(deferred_is);
+    assembler->pop(asmjit::x86::rdi);
 }
 
 // Our Forth allocates data per word
@@ -2584,7 +3284,7 @@ static void latest_word_allot_data() {
 }
 
 // 512 ALLOT> word
-void runImmediateALLOT_TO(std::deque<ForthToken> &tokens) {
+void runImmediateALLOT_TO(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -2594,10 +3294,10 @@ void runImmediateALLOT_TO(std::deque<ForthToken> &tokens) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
         return;
     }
-    tokens.erase(tokens.begin()); // Remove the processed token
+    tokens.pop_front(); // Remove the processed token
 
     const auto &dict = ForthDictionary::instance();
-    const auto first_word = dict.findWord(first.value.c_str());
+    const auto first_word = dict.findWord(first.value);
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -2613,6 +3313,13 @@ void display_show_help() {
     std::cout << " words" << std::endl;
     std::cout << " chain" << std::endl;
     std::cout << " allot" << std::endl;
+    std::cout << " maps" << std::endl;
+    std::cout << " blocks" << std::endl;
+    std::cout << " stats" << std::endl;
+    std::cout << " compiler" << std::endl;
+    std::cout << " compiler_json" << std::endl;
+    std::cout << " tiers" << std::endl;
+    std::cout << " deferred" << std::endl;
     std::cout << " memory" << std::endl;
     std::cout << " usage" << std::endl;
     std::cout << " strings" << std::endl;
@@ -2621,7 +3328,7 @@ void display_show_help() {
 
 
 // SHOW THING
-void runImmediateSHOW(std::deque<ForthToken> &tokens) {
+void runImmediateSHOW(TokenStream &tokens) {
     auto size = tokens.size();
 
 
@@ -2632,7 +3339,7 @@ void runImmediateSHOW(std::deque<ForthToken> &tokens) {
     const ForthToken first = tokens.front();
     const auto thing = first.value;
 
-    tokens.erase(tokens.begin());
+    tokens.pop_front();
     if (thing.empty()) {
         display_show_help();
         return;
@@ -2644,10 +3351,27 @@ void runImmediateSHOW(std::deque<ForthToken> &tokens) {
     } else if (thing == "ALLOT" && size == 3) {
         const ForthToken &next_token = tokens.front();
         auto &dict = ForthDictionary::instance();
-        auto first_word = dict.findWord(next_token.value.c_str());
+        auto first_word = dict.findWord(next_token.value);
         if (!first_word) { return; }
         auto id = first_word->getID();
         WordHeap::instance().listAllocation(id);
+    } else if (thing == "MAPS") {
+        WordHeap::instance().listMappings();
+    } else if (thing == "BLOCKS") {
+        BlockCache::instance().display();
+    } else if (thing == "STATS") {
+        CallCounters::instance().display();
+    } else if (thing == "COMPILER" && size == 2) {
+        CompilerStats::instance().display();
+    } else if (thing == "COMPILER" && size == 3) {
+        CompilerStats::instance().display(std::string(tokens.front().value));
+        tokens.pop_front();
+    } else if (thing == "COMPILER_JSON") {
+        CompilerStats::instance().dump();
+    } else if (thing == "TIERS") {
+        Tiering::instance().display();
+    } else if (thing == "DEFERRED") {
+        DeferredWords::instance().display();
     } else if (thing == "CHAIN") {
         auto &dict = ForthDictionary::instance();
         for (int i = 0; i < 16; i++) {
@@ -2676,50 +3400,143 @@ void runImmediateSHOW(std::deque<ForthToken> &tokens) {
 // time word
 
 
-void initializeTimer() {
-    mach_timebase_info_data_t timebase;
-    kern_return_t kr = mach_timebase_info(&timebase);
-    if (kr != KERN_SUCCESS) {
-        std::cerr << "Failed to initialize timer. Error: " << kr << std::endl;
+// TIMEIT runs a word many times with the same data stack each time
+
+static int64_t stack_depth() {
+    return (stack_top - fetchR15() > 0) ? static_cast<int64_t>((stack_top - fetchR15()) / 8) : 0;
+}
+
+// words may use RBP, keep the frame pointer across the call
+static void run_word(const ForthFunction fn) {
+    asm volatile(
+        "pushq %%rbp"
+        :
+        :
+        : "memory"
+    );
+    fn();
+    asm volatile(
+        "popq %%rbp"
+        :
+        :
+        : "memory"
+    );
+}
+
+// n TIMEIT word, with no n the word is run once
+void runImmediateTIMEIT(TokenStream &tokens) {
+    if (tokens.empty()) return; // Exit early if no tokens to process
+
+    // Get and remove the first token
+    // The first word is the new action
+    const ForthToken first = tokens.front();
+    if (first.type != TokenType::TOKEN_WORD) {
+        SignalHandler::instance().raise(11); // Invalid token - raise an error
+        return;
+    }
+    tokens.pop_front(); // Remove the processed token
+
+    auto &dict = ForthDictionary::instance();
+    auto first_word = dict.findWord(first.value);
+    if (!first_word) {
+        SignalHandler::instance().raise(14); // Invalid token - raise an error
+        return;
+    }
+    if (first_word->executable == nullptr) {
+        std::cout << "Word not executable" << std::endl;
+        return;
+    }
+
+    const int64_t iterations = stack_depth() > 0 ? std::max<int64_t>(cpop(), 1) : 1;
+    const ForthFunction fn = first_word->executable;
+
+    // every run starts from the stack as it is now
+    std::vector<int64_t> saved(static_cast<size_t>(stack_depth()));
+    for (auto it = saved.rbegin(); it != saved.rend(); ++it) {
+        *it = cpop();
+    }
+    const auto restore = [&saved] {
+        while (stack_depth() > 0) cpop();
+        for (const int64_t v: saved) cpush(v);
+    };
+
+    // warm the caches and branch predictors
+    const int64_t warmups = std::min<int64_t>(iterations, 10);
+    for (int64_t i = 0; i < warmups; ++i) {
+        restore();
+        run_word(fn);
+    }
+
+    // SET HWCOUNTERS ON adds hardware counters, counting only while the word runs
+    PerfCounters counters;
+    bool counting = false;
+    if (hardwareCounters) {
+        counting = counters.open();
+        if (!counting) {
+            std::cout << "Hardware counters unavailable, " << counters.reason() << std::endl;
+        }
+    }
+
+    const uint64_t overhead = timing_overhead();
+    std::vector<uint64_t> samples;
+    samples.reserve(static_cast<size_t>(iterations));
+    for (int64_t i = 0; i < iterations; ++i) {
+        restore();
+        if (counting) counters.start();
+        const uint64_t t0 = cycles_start();
+        run_word(fn);
+        const uint64_t t1 = cycles_end();
+        if (counting) counters.stop();
+        samples.push_back(t1 - t0 > overhead ? t1 - t0 - overhead : 0);
+    }
+    // the results of the last run are left on the stack
+
+    TimingSummary summary = summarize_timings(samples);
+    summary.warmups = static_cast<size_t>(warmups);
+    if (const auto *range = CodeIndex::instance().find(reinterpret_cast<uintptr_t>(fn))) {
+        summary.codeBytes = range->end - range->start;
     }
-    // std::cout << "Timebase info: numer = " << timebase.numer << ", denom = " << timebase.denom << std::endl;
-    // If the values are always 1, this indicates we're natively getting nanoseconds.
-    if (timebase.numer == 1 && timebase.denom == 1) {
-        //std::cout << "mach_absolute_time values are already in nanoseconds." << std::endl;
+    for (const auto &[name, total]: counters.totals()) {
+        summary.counters.emplace_back(name, total / static_cast<double>(iterations));
     }
+    if (counting && !counters.reason().empty()) {
+        // the PMU had no room for a group even on its own, the rest are still shown
+        std::cout << "Hardware counters " << counters.reason() << std::endl;
+    }
+    OutputBuffer::instance().flush();
+    print_timings(std::string(first.value), summary, timeitJson);
 }
 
 
-void displayDuration(uint64_t durationNs) {
-    if (durationNs < 1e6) {
-        // Case 1: Less than 1 millisecond
-        std::cout << durationNs << " ns" << std::endl;
-    } else if (durationNs < 1e9) {
-        // Case 2: Between 1 millisecond and 1 second
-        uint64_t ms = durationNs / 1e6; // Whole milliseconds
-        uint64_t ns = durationNs % static_cast<uint64_t>(1e6); // Remaining nanoseconds
-        std::cout << ms << " ms " << ns << " ns" << std::endl;
-    } else {
-        // Case 3: Greater than or equal to 1 second (with fractional milliseconds)
-        double seconds = durationNs / 1e9; // Convert to seconds as a double
-        std::cout << std::fixed << std::setprecision(3) << seconds << " s" << std::endl;
+// sampling profiler
+
+static void profile_start() {
+    if (!Profiler::instance().start()) {
+        std::cout << "PROFILE-START: the profiling timer could not be started" << std::endl;
     }
 }
 
-void runImmediateTIMEIT(std::deque<ForthToken> &tokens) {
+static void profile_stop() {
+    Profiler::instance().stop();
+}
+
+static void profile_report() {
+    OutputBuffer::instance().flush();
+    Profiler::instance().report();
+}
+
+// PROFILE word, run the word under the profiler and report
+void runImmediatePROFILE(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
-    // Get and remove the first token
-    // The first word is the new action
     const ForthToken first = tokens.front();
     if (first.type != TokenType::TOKEN_WORD) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
         return;
     }
-    tokens.erase(tokens.begin()); // Remove the processed token
+    tokens.pop_front(); // Remove the processed token
 
-    auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(first.value.c_str());
+    const auto first_word = ForthDictionary::instance().findWord(first.value);
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -2728,33 +3545,16 @@ void runImmediateTIMEIT(std::deque<ForthToken> &tokens) {
         std::cout << "Word not executable" << std::endl;
         return;
     }
-    initializeTimer();
-    const uint64_t start_time = mach_absolute_time();
-    // Save the value of RBP
-    asm volatile(
-        "pushq %%rbp" // Push RBP onto the stack
-        :
-        : // No inputs
-        : "memory" // Inform the compiler that memory is being changed
-    );
-    first_word->executable();
-    asm volatile(
-        "popq %%rbp" // Pop the saved RBP value from the stack
-        :
-        : // No inputs
-        : "memory" // Inform the compiler that memory is being changed
-    );
-    uint64_t end = mach_absolute_time();
-    uint64_t durationNs = (end - start_time);
-    std::cout << "Duration: ";
-    std::cout << std::dec;
-    displayDuration(durationNs);
+
+    profile_start();
+    run_word(first_word->executable);
+    profile_report();
 }
 
 
 // introspection
 
-void runImmediateSEE(std::deque<ForthToken> &tokens) {
+void runImmediateSEE(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -2764,16 +3564,68 @@ void runImmediateSEE(std::deque<ForthToken> &tokens) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
         return;
     }
-    tokens.erase(tokens.begin()); // Remove the processed token
+    tokens.pop_front(); // Remove the processed token
 
     const auto &dict = ForthDictionary::instance();
-    const auto first_word = dict.findWord(first.value.c_str());
+    const auto first_word = dict.findWord(first.value);
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
     }
 
     first_word->display();
+    if (first_word->effect.known()) {
+        std::cout << "Stack effect: " << first_word->effect.text() << std::endl;
+    }
+
+    // the machine code, from the listing kept when it was compiled or as bytes
+    if (!first_word->executable) return;
+    const auto *range = CodeIndex::instance().find(reinterpret_cast<uintptr_t>(first_word->executable));
+    if (!range) return;
+    std::cout << "Code: " << range->end - range->start << " bytes at "
+            << reinterpret_cast<const void *>(range->start) << std::endl;
+    if (first_word->compileStats) {
+        std::cout << "Compiled in " << first_word->compileStats->totalNs() / 1000 << " us" << std::endl;
+    }
+    CodeListing::instance().display(reinterpret_cast<const void *>(range->start), range->end - range->start);
+}
+
+
+// source files
+
+static void include_file(const std::string &path) {
+    auto &runner = ScriptRunner::instance();
+    if (runner.depth() >= 16) {
+        std::cerr << "INCLUDE: files nested too deeply" << std::endl;
+        SignalHandler::instance().raise(7);
+        return;
+    }
+    if (!runner.includeFile(path)) {
+        SignalHandler::instance().raise(28);
+    }
+}
+
+// INCLUDE file.fs
+void runImmediateINCLUDE(TokenStream &tokens) {
+    if (tokens.empty() || tokens.front().type == TokenType::TOKEN_END) {
+        SignalHandler::instance().raise(11); // file name expected
+        return;
+    }
+    const std::string path(tokens.front().value);
+    tokens.pop_front();
+    include_file(path);
+}
+
+// INCLUDED ( c-addr u -- )
+static void included() {
+    const auto len = cpop();
+    const auto name = reinterpret_cast<const char *>(cpop());
+    include_file(std::string(name, len));
+}
+
+static void bye() {
+    OutputBuffer::instance().flush();
+    exit(0);
 }
 
 
@@ -2786,7 +3638,7 @@ void runImmediateSEE(std::deque<ForthToken> &tokens) {
 
 
 // add TOS by constant
-void runImmediateADD_IMM(std::deque<ForthToken> &tokens) {
+void runImmediateADD_IMM(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     const ForthToken &first = tokens.front();
@@ -2796,7 +3648,7 @@ void runImmediateADD_IMM(std::deque<ForthToken> &tokens) {
     }
 
     const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(first.optimized_op.c_str());
+    auto first_word = dict.findWord(opt_op_name(first.op));
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -2810,7 +3662,7 @@ void runImmediateADD_IMM(std::deque<ForthToken> &tokens) {
 }
 
 // CMP_LT_IMM - Compare if TOS (r13) is less than a constant
-void runImmediateCMP_LT_IMM(std::deque<ForthToken> &tokens) {
+void runImmediateCMP_LT_IMM(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -2821,7 +3673,7 @@ void runImmediateCMP_LT_IMM(std::deque<ForthToken> &tokens) {
     }
 
     const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(first.optimized_op.c_str());
+    auto first_word = dict.findWord(opt_op_name(first.op));
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -2841,7 +3693,7 @@ void runImmediateCMP_LT_IMM(std::deque<ForthToken> &tokens) {
     assembler->cmp(asmjit::x86::r13, asmjit::imm(first.int_value));
 
     // Set the result (1 for true, 0 for false) into r13
-    assembler->setb(asmjit::x86::al); // Set AL (lower byte of RAX) if "below" (unsigned less than)
+    assembler->setl(asmjit::x86::al); // Set AL (lower byte of RAX) if less, signed as <
     assembler->movzx(asmjit::x86::rax, asmjit::x86::al); // Zero-extend AL into r13 (TOS)
     assembler->neg(asmjit::x86::rax);
 
@@ -2850,7 +3702,7 @@ void runImmediateCMP_LT_IMM(std::deque<ForthToken> &tokens) {
 
 
 // sub TOS by constant
-void runImmediateSUB_IMM(std::deque<ForthToken> &tokens) {
+void runImmediateSUB_IMM(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -2863,7 +3715,7 @@ void runImmediateSUB_IMM(std::deque<ForthToken> &tokens) {
 
 
     const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(first.optimized_op.c_str());
+    auto first_word = dict.findWord(opt_op_name(first.op));
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -2879,7 +3731,7 @@ void runImmediateSUB_IMM(std::deque<ForthToken> &tokens) {
 }
 
 // CMP_GT_IMM - Compare if TOS (r13) is greater than a constant and set result to -1 (true) or 0 (false)
-void runImmediateCMP_GT_IMM(std::deque<ForthToken> &tokens) {
+void runImmediateCMP_GT_IMM(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -2890,7 +3742,7 @@ void runImmediateCMP_GT_IMM(std::deque<ForthToken> &tokens) {
     }
 
     const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(first.optimized_op.c_str());
+    auto first_word = dict.findWord(opt_op_name(first.op));
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -2910,7 +3762,7 @@ void runImmediateCMP_GT_IMM(std::deque<ForthToken> &tokens) {
     assembler->cmp(asmjit::x86::r13, asmjit::imm(first.int_value));
 
     // Set AL to 1 if r13 > imm, otherwise 0
-    assembler->seta(asmjit::x86::al); // "Set Above" for unsigned greater than
+    assembler->setg(asmjit::x86::al); // "Set Greater", signed as >
 
     // Move AL to TOS (r13) and extend it into a full register
     assembler->movzx(asmjit::x86::r13, asmjit::x86::al);
@@ -2921,7 +3773,7 @@ void runImmediateCMP_GT_IMM(std::deque<ForthToken> &tokens) {
 
 
 // CMP_EQ_IMM - Compare if TOS (r13) is equal to a constant and set result to -1 (true) or 0 (false)
-void runImmediateCMP_EQ_IMM(std::deque<ForthToken> &tokens) {
+void runImmediateCMP_EQ_IMM(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -2934,7 +3786,7 @@ void runImmediateCMP_EQ_IMM(std::deque<ForthToken> &tokens) {
     }
 
     const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(first.optimized_op.c_str());
+    auto first_word = dict.findWord(opt_op_name(first.op));
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -2965,7 +3817,7 @@ void runImmediateCMP_EQ_IMM(std::deque<ForthToken> &tokens) {
 
 
 // shift left for powers of 2
-void runImmediateSHL_IMM(std::deque<ForthToken> &tokens) {
+void runImmediateSHL_IMM(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -2978,7 +3830,7 @@ void runImmediateSHL_IMM(std::deque<ForthToken> &tokens) {
 
 
     const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(first.optimized_op.c_str());
+    auto first_word = dict.findWord(opt_op_name(first.op));
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -2993,8 +3845,70 @@ void runImmediateSHL_IMM(std::deque<ForthToken> &tokens) {
     assembler->shl(asmjit::x86::r13, asmjit::imm(first.int_value));
 }
 
-// Shift right TOS by constant power of 2
-void runImmediateSHR_IMM(std::deque<ForthToken> &tokens) {
+// n divided by the constant d into RDX, rounded toward zero as idiv does, RAX is used
+static void genSignedQuotient(asmjit::x86::Assembler *assembler, const asmjit::x86::Gp &n, const int64_t d) {
+    const uint64_t ad = d < 0 ? 0 - static_cast<uint64_t>(d) : static_cast<uint64_t>(d);
+    if ((ad & (ad - 1)) == 0) {
+        // add 2^k-1 to a negative n so the shift rounds toward zero
+        const int k = __builtin_ctzll(ad);
+        assembler->mov(asmjit::x86::rdx, n);
+        if (k > 0) {
+            assembler->sar(asmjit::x86::rdx, 63);
+            assembler->shr(asmjit::x86::rdx, 64 - k);
+            assembler->add(asmjit::x86::rdx, n);
+            assembler->sar(asmjit::x86::rdx, k);
+        }
+        if (d < 0) assembler->neg(asmjit::x86::rdx);
+        return;
+    }
+
+    const SignedMagic magic = signed_magic(d);
+    assembler->mov(asmjit::x86::rax, asmjit::imm(magic.multiplier));
+    assembler->imul(n); // RDX:RAX = multiplier * n
+    if (d > 0 && magic.multiplier < 0) assembler->add(asmjit::x86::rdx, n);
+    if (d < 0 && magic.multiplier > 0) assembler->sub(asmjit::x86::rdx, n);
+    if (magic.shift > 0) assembler->sar(asmjit::x86::rdx, magic.shift);
+    assembler->mov(asmjit::x86::rax, asmjit::x86::rdx);
+    assembler->shr(asmjit::x86::rax, 63);
+    assembler->add(asmjit::x86::rdx, asmjit::x86::rax); // add one to a negative quotient
+}
+
+// n divided by the unsigned constant d into RDX, RAX is used
+static void genUnsignedQuotient(asmjit::x86::Assembler *assembler, const asmjit::x86::Gp &n, const uint64_t d) {
+    if ((d & (d - 1)) == 0) {
+        assembler->mov(asmjit::x86::rdx, n);
+        if (d > 1) assembler->shr(asmjit::x86::rdx, __builtin_ctzll(d));
+        return;
+    }
+
+    const UnsignedMagic magic = unsigned_magic(d);
+    assembler->mov(asmjit::x86::rax, asmjit::imm(magic.multiplier));
+    assembler->mul(n); // RDX:RAX = multiplier * n
+    if (magic.add) {
+        // the multiplier needs 65 bits, add n back in halved so it cannot overflow
+        assembler->mov(asmjit::x86::rax, n);
+        assembler->sub(asmjit::x86::rax, asmjit::x86::rdx);
+        assembler->shr(asmjit::x86::rax, 1);
+        assembler->add(asmjit::x86::rdx, asmjit::x86::rax);
+        if (magic.shift > 1) assembler->shr(asmjit::x86::rdx, magic.shift - 1);
+    } else if (magic.shift > 0) {
+        assembler->shr(asmjit::x86::rdx, magic.shift);
+    }
+}
+
+// n - quotient * d into n, the quotient in RDX is kept
+static void genRemainder(asmjit::x86::Assembler *assembler, const asmjit::x86::Gp &n, const int64_t d) {
+    if (d >= INT32_MIN && d <= INT32_MAX) {
+        assembler->imul(asmjit::x86::rax, asmjit::x86::rdx, asmjit::imm(d));
+    } else {
+        assembler->mov(asmjit::x86::rax, asmjit::imm(d));
+        assembler->imul(asmjit::x86::rax, asmjit::x86::rdx);
+    }
+    assembler->sub(n, asmjit::x86::rax);
+}
+
+// Divide TOS by a constant power of 2, rounding toward zero as / does
+void runImmediateSHR_IMM(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -3007,7 +3921,7 @@ void runImmediateSHR_IMM(std::deque<ForthToken> &tokens) {
 
 
     const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(first.optimized_op.c_str());
+    auto first_word = dict.findWord(opt_op_name(first.op));
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -3018,12 +3932,13 @@ void runImmediateSHR_IMM(std::deque<ForthToken> &tokens) {
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
     //
-    assembler->commentf("; Sub constant %llu", first.int_value);
-    assembler->shr(asmjit::x86::r13, asmjit::imm(first.int_value));
+    assembler->commentf("; Divide by 2^%llu", first.int_value);
+    genSignedQuotient(assembler, asmjit::x86::r13, static_cast<int64_t>(1) << first.int_value);
+    assembler->mov(asmjit::x86::r13, asmjit::x86::rdx);
 }
 
 // multiply TOS by immediate general
-void runImmediateMUL_IMM(std::deque<ForthToken> &tokens) {
+void runImmediateMUL_IMM(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -3036,7 +3951,7 @@ void runImmediateMUL_IMM(std::deque<ForthToken> &tokens) {
 
 
     const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(first.optimized_op.c_str());
+    auto first_word = dict.findWord(opt_op_name(first.op));
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -3051,50 +3966,71 @@ void runImmediateMUL_IMM(std::deque<ForthToken> &tokens) {
     assembler->imul(asmjit::x86::r13, asmjit::x86::r13, asmjit::imm(first.int_value));
 }
 
-// multiply TOS by immediate general
-void runImmediateDIV_IMM(std::deque<ForthToken> &tokens) {
+// divide by a constant, / MOD /MOD U/ UMOD and */ with a number before them
+void runImmediateDIV_IMM(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
-    // Get and remove the first token
-    // The first word is the new action
     const ForthToken &first = tokens.front();
     if (first.type != TokenType::TOKEN_OPTIMIZED) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
         return;
     }
 
-
-    const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(first.optimized_op.c_str());
-    if (!first_word) {
-        SignalHandler::instance().raise(14); // Invalid token - raise an error
-        return;
-    }
-    // we will run the optimized generator here...
-    // std::cout << "Running optimized generator:" << first_word->getWordName() << std::endl;
-
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
-    //
-    assembler->commentf("; IDIV by constant %llu", first.int_value);
-    // Setup the dividend
-
-    assembler->mov(asmjit::x86::rax, asmjit::x86::r13); // Move TOS (R13) to RAX.
-    assembler->cdq(); // Sign-extend RAX into RDX:RAX.
-
-    // Load the constant divisor
-    assembler->mov(asmjit::x86::rcx, asmjit::imm(first.int_value)); // Load constant divisor into RCX.
-
-    // Perform the division
-    assembler->idiv(asmjit::x86::rcx); // Divide RDX:RAX by RCX. Quotient -> RAX, Remainder -> RDX.
-
-    // Optionally store the result
-    assembler->mov(asmjit::x86::r13, asmjit::x86::rax); // Move the quotient (RAX) back into TOS (R13).
+    const auto d = static_cast<int64_t>(first.int_value);
+    const auto u = static_cast<uint64_t>(first.int_value); // UMOD reads the literal unsigned
+    assembler->commentf("; %s by constant %lld", opt_op_name(first.op), static_cast<long long>(d));
+
+    switch (first.op) {
+        case OptOp::DIV_IMM:
+            genSignedQuotient(assembler, asmjit::x86::r13, d);
+            assembler->mov(asmjit::x86::r13, asmjit::x86::rdx);
+            break;
+        case OptOp::MOD_IMM:
+            genSignedQuotient(assembler, asmjit::x86::r13, d);
+            genRemainder(assembler, asmjit::x86::r13, d);
+            break;
+        case OptOp::DIVMOD_IMM:
+            // ( n -- quotient remainder ) as /MOD leaves them
+            genSignedQuotient(assembler, asmjit::x86::r13, d);
+            assembler->mov(asmjit::x86::rcx, asmjit::x86::r13);
+            genRemainder(assembler, asmjit::x86::rcx, d);
+            assembler->sub(asmjit::x86::r15, 8);
+            assembler->mov(asmjit::x86::ptr(asmjit::x86::r15), asmjit::x86::r12);
+            assembler->mov(asmjit::x86::r12, asmjit::x86::rdx);
+            assembler->mov(asmjit::x86::r13, asmjit::x86::rcx);
+            break;
+        case OptOp::UDIV_IMM:
+            genUnsignedQuotient(assembler, asmjit::x86::r13, first.int_value);
+            assembler->mov(asmjit::x86::r13, asmjit::x86::rdx);
+            break;
+        case OptOp::UMOD_IMM:
+            // a power of two is a mask, worked out unsigned so any literal, even INT64_MIN, is defined
+            if (u != 0 && (u & (u - 1)) == 0 && u - 1 <= INT32_MAX) {
+                assembler->and_(asmjit::x86::r13, asmjit::imm(u - 1));
+                break;
+            }
+            genUnsignedQuotient(assembler, asmjit::x86::r13, first.int_value);
+            genRemainder(assembler, asmjit::x86::r13, d);
+            break;
+        case OptOp::SCALE_IMM:
+            // ( a b -- a*b/c ), a single width product as */ makes
+            assembler->mov(asmjit::x86::rcx, asmjit::x86::r12);
+            assembler->imul(asmjit::x86::rcx, asmjit::x86::r13);
+            genSignedQuotient(assembler, asmjit::x86::rcx, d);
+            compile_DROP();
+            assembler->mov(asmjit::x86::r13, asmjit::x86::rdx);
+            break;
+        default:
+            SignalHandler::instance().raise(11);
+            break;
+    }
 }
 
 
 // DUP + = lea r13, [r13 + r13] LEA_TOS
-void runImmediateLEA_TOS(std::deque<ForthToken> &tokens) {
+void runImmediateLEA_TOS(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -3107,7 +4043,7 @@ void runImmediateLEA_TOS(std::deque<ForthToken> &tokens) {
 
 
     const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(first.optimized_op.c_str());
+    auto first_word = dict.findWord(opt_op_name(first.op));
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -3121,7 +4057,7 @@ void runImmediateLEA_TOS(std::deque<ForthToken> &tokens) {
 }
 
 // safer alternative to VOCAB DEFINITIONS
-void runImmediateSETCURRENT(std::deque<ForthToken> &tokens) {
+void runImmediateSETCURRENT(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -3134,7 +4070,7 @@ void runImmediateSETCURRENT(std::deque<ForthToken> &tokens) {
 
 
     auto &dict = ForthDictionary::instance();
-    const auto first_word = dict.findWord(first.value.c_str());
+    const auto first_word = dict.findWord(first.value);
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -3151,7 +4087,7 @@ void runImmediateSETCURRENT(std::deque<ForthToken> &tokens) {
 //   so these optimize that pattern.
 
 //   R> 1 + >R (bump pointer held on return stack)
-void runImmediateINC_R(std::deque<ForthToken> &tokens) {
+void runImmediateINC_R(TokenStream &tokens) {
     const ForthToken &first = tokens.front();
     if (first.type != TokenType::TOKEN_OPTIMIZED) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
@@ -3169,7 +4105,7 @@ void runImmediateINC_R(std::deque<ForthToken> &tokens) {
 }
 
 //   R> 1 + >R (bump pointer held on return stack)
-void runImmediateDEC_R(std::deque<ForthToken> &tokens) {
+void runImmediateDEC_R(TokenStream &tokens) {
     const ForthToken &first = tokens.front();
     if (first.type != TokenType::TOKEN_OPTIMIZED) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
@@ -3185,7 +4121,7 @@ void runImmediateDEC_R(std::deque<ForthToken> &tokens) {
 }
 
 // poke value from return stack
-void runImmediateRATcStore(std::deque<ForthToken> &tokens) {
+void runImmediateRATcStore(TokenStream &tokens) {
     const ForthToken &first = tokens.front();
     if (first.type != TokenType::TOKEN_OPTIMIZED) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
@@ -3203,7 +4139,7 @@ void runImmediateRATcStore(std::deque<ForthToken> &tokens) {
 
 
 //  INC_2OS SWAP n + SWAP = increment 2OS
-void runImmediateINC_2OS(std::deque<ForthToken> &tokens) {
+void runImmediateINC_2OS(TokenStream &tokens) {
     const ForthToken &first = tokens.front();
     if (first.type != TokenType::TOKEN_OPTIMIZED) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
@@ -3219,7 +4155,7 @@ void runImmediateINC_2OS(std::deque<ForthToken> &tokens) {
 
 
 // literal variable !  (e.g 10 base !)
-void runImmediateLIT_VAR_Store(std::deque<ForthToken> &tokens) {
+void runImmediateLIT_VAR_Store(TokenStream &tokens) {
     const ForthToken &first = tokens.front();
     if (first.type != TokenType::TOKEN_OPTIMIZED) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
@@ -3228,7 +4164,7 @@ void runImmediateLIT_VAR_Store(std::deque<ForthToken> &tokens) {
 
     const auto varname = first.value;
     const auto &dict = ForthDictionary::instance();
-    const auto first_word = dict.findWord(varname.c_str());
+    const auto first_word = dict.findWord(varname);
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -3247,14 +4183,91 @@ void runImmediateLIT_VAR_Store(std::deque<ForthToken> &tokens) {
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
     assembler->comment("; -- literal variable ! ");
-    assembler->commentf("; -- %d %s ! ", literal, varname.c_str());
+    assembler->commentf("; -- %d %.*s ! ", literal, static_cast<int>(varname.size()), varname.data());
     assembler->mov(asmjit::x86::rax, asmjit::imm(literal)); // Load the literal value into RAX.
     assembler->mov(asmjit::x86::rcx, asmjit::imm(data)); // Store the data address for the variable
     assembler->mov(asmjit::x86::ptr(asmjit::x86::rcx), asmjit::x86::rax); // address=literal
 }
 
+// data address of the variable an optimized token names
+static uintptr_t optimized_variable(const ForthToken &token) {
+    const auto var_word = ForthDictionary::instance().findWord(token.value);
+    if (token.type != TokenType::TOKEN_OPTIMIZED || !var_word || var_word->type != ForthWordType::VARIABLE) {
+        std::cerr << "Error: " << token.value << " is not a variable" << std::endl;
+        SignalHandler::instance().raise(14);
+        return 0;
+    }
+    return reinterpret_cast<uintptr_t>(var_word->data);
+}
+
+// variable @ +  adds the variable to TOS straight from memory
+void runImmediateVAR_AT_ADD(TokenStream &tokens) {
+    if (tokens.empty()) return;
+    const ForthToken &first = tokens.front();
+    const auto address = optimized_variable(first);
+
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->commentf("; -- %.*s @ + ", static_cast<int>(first.value.size()), first.value.data());
+    assembler->mov(asmjit::x86::rax, asmjit::imm(address));
+    assembler->add(asmjit::x86::r13, asmjit::x86::qword_ptr(asmjit::x86::rax));
+}
+
+// variable +!  and  variable @ + variable !  add TOS to the variable in memory
+void runImmediateVAR_PLUS_STORE(TokenStream &tokens) {
+    if (tokens.empty()) return;
+    const ForthToken &first = tokens.front();
+    const auto address = optimized_variable(first);
+
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->commentf("; -- %.*s +! ", static_cast<int>(first.value.size()), first.value.data());
+    assembler->mov(asmjit::x86::rax, asmjit::imm(address));
+    assembler->add(asmjit::x86::qword_ptr(asmjit::x86::rax), asmjit::x86::r13);
+    compile_DROP();
+}
+
+// literal variable +!  and  variable @ literal + variable !  (e.g. 1 counter +!)
+void runImmediateLIT_VAR_PLUS_STORE(TokenStream &tokens) {
+    if (tokens.empty()) return;
+    const ForthToken &first = tokens.front();
+    const auto address = optimized_variable(first);
+    const auto literal = static_cast<int64_t>(first.int_value);
+
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->commentf("; -- %lld %.*s +! ", static_cast<long long>(literal),
+                        static_cast<int>(first.value.size()), first.value.data());
+    assembler->mov(asmjit::x86::rax, asmjit::imm(address));
+    if (literal >= INT32_MIN && literal <= INT32_MAX) {
+        assembler->add(asmjit::x86::qword_ptr(asmjit::x86::rax), asmjit::imm(literal));
+    } else {
+        assembler->mov(asmjit::x86::rcx, asmjit::imm(literal));
+        assembler->add(asmjit::x86::qword_ptr(asmjit::x86::rax), asmjit::x86::rcx);
+    }
+}
+
+// ['] word EXEC  calls the word directly
+void runImmediateCALL_XT(TokenStream &tokens) {
+    if (tokens.empty()) return;
+    const ForthToken &first = tokens.front();
+    const std::string name(first.value);
+    const auto *word = ForthDictionary::instance().findWord(name);
+    if (!word) {
+        SignalHandler::instance().raise(14);
+        return;
+    }
+    if (DeferredWords::instance().deferred(word)) {
+        compile_call_deferred(word, name);
+    } else if (word->executable) {
+        compile_call_forth(word->executable, name);
+    } else {
+        SignalHandler::instance().raise(14);
+    }
+}
+
 // variable >R
-void runImmediateVAR_AT_TOR(std::deque<ForthToken> &tokens) {
+void runImmediateVAR_AT_TOR(TokenStream &tokens) {
     const ForthToken &first = tokens.front();
     if (first.type != TokenType::TOKEN_OPTIMIZED) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
@@ -3263,7 +4276,7 @@ void runImmediateVAR_AT_TOR(std::deque<ForthToken> &tokens) {
 
     const auto varname = first.value;
     const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(varname.c_str());
+    auto first_word = dict.findWord(varname);
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -3272,7 +4285,7 @@ void runImmediateVAR_AT_TOR(std::deque<ForthToken> &tokens) {
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
     assembler->comment("; -- variable >R  ");
-    assembler->commentf("; -- %s >R ", varname.c_str());
+    assembler->commentf("; -- %.*s >R ", static_cast<int>(varname.size()), varname.data());
     assembler->mov(asmjit::x86::rcx, asmjit::imm(data)); // address to rcx
     // fetch value at [rcx] to rax
     assembler->mov(asmjit::x86::rax, asmjit::x86::ptr(asmjit::x86::rcx));
@@ -3281,7 +4294,7 @@ void runImmediateVAR_AT_TOR(std::deque<ForthToken> &tokens) {
     assembler->mov(asmjit::x86::ptr(asmjit::x86::r14), asmjit::x86::rax);
 }
 
-void runImmediateVAR_TOR(std::deque<ForthToken> &tokens) {
+void runImmediateVAR_TOR(TokenStream &tokens) {
     const ForthToken &first = tokens.front();
     if (first.type != TokenType::TOKEN_OPTIMIZED) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
@@ -3290,7 +4303,7 @@ void runImmediateVAR_TOR(std::deque<ForthToken> &tokens) {
 
     const auto varname = first.value;
     const auto &dict = ForthDictionary::instance();
-    auto first_word = dict.findWord(varname.c_str());
+    auto first_word = dict.findWord(varname);
     if (!first_word) {
         SignalHandler::instance().raise(14); // Invalid token - raise an error
         return;
@@ -3299,14 +4312,14 @@ void runImmediateVAR_TOR(std::deque<ForthToken> &tokens) {
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
     assembler->comment("; -- variable >R  ");
-    assembler->commentf("; -- %s >R ", varname.c_str());
+    assembler->commentf("; -- %.*s >R ", static_cast<int>(varname.size()), varname.data());
     assembler->mov(asmjit::x86::rcx, asmjit::imm(data)); // address to rcx
     assembler->sub(asmjit::x86::r14, 8); // Allocate space on return stack
     assembler->mov(asmjit::x86::ptr(asmjit::x86::r14), asmjit::x86::rcx);
 }
 
 
-void runImmediateRATStore(std::deque<ForthToken> &tokens) {
+void runImmediateRATStore(TokenStream &tokens) {
     const ForthToken &first = tokens.front();
     if (first.type != TokenType::TOKEN_OPTIMIZED) {
         SignalHandler::instance().raise(11); // Invalid token - raise an error
@@ -3429,20 +4442,51 @@ void code_generator_add_immediate_words() {
                      nullptr,
                      runImmediateLIT_VAR_Store);
 
+    dict.addCodeWord("LIT_VAR_+!", "FRAGMENTS",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::MACRO,
+                     nullptr,
+                     nullptr,
+                     runImmediateLIT_VAR_PLUS_STORE);
 
-    dict.addCodeWord("LEA_TOS", "FRAGMENTS",
+    dict.addCodeWord("VAR_+!", "FRAGMENTS",
                      ForthState::IMMEDIATE,
                      ForthWordType::MACRO,
                      nullptr,
                      nullptr,
-                     runImmediateLEA_TOS);
+                     runImmediateVAR_PLUS_STORE);
 
-    dict.addCodeWord("DIV_IMM", "FRAGMENTS",
+    dict.addCodeWord("VAR_@_+", "FRAGMENTS",
                      ForthState::IMMEDIATE,
                      ForthWordType::MACRO,
                      nullptr,
                      nullptr,
-                     runImmediateDIV_IMM);
+                     runImmediateVAR_AT_ADD);
+
+    dict.addCodeWord("[']_EXEC", "FRAGMENTS",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::MACRO,
+                     nullptr,
+                     nullptr,
+                     runImmediateCALL_XT);
+
+
+    dict.addCodeWord("LEA_TOS", "FRAGMENTS",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::MACRO,
+                     nullptr,
+                     nullptr,
+                     runImmediateLEA_TOS);
+
+    for (const OptOp op: {OptOp::DIV_IMM, OptOp::MOD_IMM, OptOp::DIVMOD_IMM, OptOp::UDIV_IMM,
+                          OptOp::UMOD_IMM, OptOp::SCALE_IMM}) {
+        dict.addCodeWord(opt_op_name(op), "FRAGMENTS",
+                         ForthState::IMMEDIATE,
+                         ForthWordType::MACRO,
+                         nullptr,
+                         nullptr,
+                         runImmediateDIV_IMM);
+    }
 
 
     dict.addCodeWord("CMP_GT_IMM", "FRAGMENTS",
@@ -3518,6 +4562,34 @@ void code_generator_add_immediate_words() {
                      nullptr,
                      runImmediateTIMEIT);
 
+    dict.addCodeWord("PROFILE", "FORTH",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     nullptr,
+                     runImmediatePROFILE);
+
+    dict.addCodeWord("PROFILE-START", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     profile_start,
+                     nullptr);
+
+    dict.addCodeWord("PROFILE-STOP", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     profile_stop,
+                     nullptr);
+
+    dict.addCodeWord("PROFILE-REPORT", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     profile_report,
+                     nullptr);
+
 
     dict.addCodeWord("SHOW", "FORTH",
                      ForthState::IMMEDIATE,
@@ -3527,6 +4599,28 @@ void code_generator_add_immediate_words() {
                      runImmediateSHOW);
 
 
+    dict.addCodeWord("INCLUDE", "FORTH",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     nullptr,
+                     runImmediateINCLUDE,
+                     nullptr);
+
+    dict.addCodeWord("INCLUDED", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     included,
+                     nullptr);
+
+    dict.addCodeWord("BYE", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     bye,
+                     nullptr);
+
     dict.addCodeWord("SEE", "FORTH",
                      ForthState::IMMEDIATE,
                      ForthWordType::WORD,
@@ -3578,7 +4672,8 @@ void code_generator_add_immediate_words() {
                      ForthWordType::WORD,
                      nullptr,
                      nullptr,
-                     runImmediateIS);
+                     runImmediateIS,
+                     compileImmediateIS);
 }
 
 
@@ -3602,16 +4697,15 @@ void code_generator_add_immediate_words() {
 //     assembler->add(asmjit::x86::r15, 8); // Adjust stack pointer
 // }
 
-static void compile_CHAR(std::deque<ForthToken> &tokens) {
+static void compile_CHAR(TokenStream &tokens) {
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
 
     if (tokens.empty()) return; // Exit early if no tokens to process
-    const ForthToken first = tokens.front();
-    tokens.erase(tokens.begin()); // Remove the processed token
+    tokens.pop_front(); // Remove [CHAR]
     if (tokens.empty()) return; // Exit early if no tokens to process
     const ForthToken character = tokens.front();
-    const int c = static_cast<unsigned char>(character.value[0]);
+    const int c = character.value.empty() ? 0 : static_cast<unsigned char>(character.value[0]);
     // move charValue to rax
     assembler->commentf("; -- literal char '%c'", c);
     compile_DUP();
@@ -3619,7 +4713,7 @@ static void compile_CHAR(std::deque<ForthToken> &tokens) {
 }
 
 
-static void compile_DotString(std::deque<ForthToken> &tokens) {
+static void compile_DotString(TokenStream &tokens) {
     if (tokens.empty()) return; // Exit early if no tokens to process
 
     // Get and remove the first token
@@ -3629,7 +4723,7 @@ static void compile_DotString(std::deque<ForthToken> &tokens) {
         return;
     }
 
-    tokens.erase(tokens.begin()); // Remove the processed token
+    tokens.pop_front(); // Remove the processed token
     if (tokens.empty()) return; // Exit early if no string token to process
     // Get the second token
     const ForthToken second = tokens.front();
@@ -3640,7 +4734,7 @@ static void compile_DotString(std::deque<ForthToken> &tokens) {
 
     // we need to save the string literal
     auto &stringStorage = StringStorage::instance();
-    const char *addr1 = stringStorage.intern(second.value);
+    const char *addr1 = stringStorage.intern(std::string(second.value));
 
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
@@ -3654,6 +4748,40 @@ static void compile_DotString(std::deque<ForthToken> &tokens) {
     assembler->pop(asmjit::x86::rdi); // Pop TOS off the stack
 }
 
+// S" text" ( -- c-addr u ) pushes an interned string and its length
+void runImmediateSQuote(TokenStream &tokens) {
+    if (tokens.empty()) return; // Exit early if no tokens to process
+
+    const ForthToken first = tokens.front();
+    if (first.type != TokenType::TOKEN_STRING) {
+        SignalHandler::instance().raise(11);
+        return;
+    }
+    tokens.pop_front();
+    const char *addr = StringStorage::instance().intern(std::string(first.value));
+    cpush(reinterpret_cast<int64_t>(addr));
+    cpush(static_cast<int64_t>(first.value.size()));
+}
+
+static void compile_SQuote(TokenStream &tokens) {
+    if (tokens.empty()) return; // Exit early if no tokens to process
+
+    tokens.pop_front(); // Remove S"
+    if (tokens.empty()) return; // Exit early if no string token to process
+    const ForthToken second = tokens.front();
+    if (second.type != TokenType::TOKEN_STRING) {
+        SignalHandler::instance().raise(11); // Invalid token - raise an error
+        return;
+    }
+
+    const char *addr = StringStorage::instance().intern(std::string(second.value));
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->comment("; -- S\" string ");
+    compile_pushLiteral(reinterpret_cast<int64_t>(addr));
+    compile_pushLiteral(static_cast<int64_t>(second.value.size()));
+}
+
 // key may raise EOF
 static void compile_KEY() {
     asmjit::x86::Assembler *assembler;
@@ -3673,12 +4801,7 @@ static void compile_EMIT() {
     //
     // DROP ( x -- )
     assembler->comment("; -- EMIT ");
-
-    assembler->push(asmjit::x86::rdi); // Push TOS onto the stack
-    assembler->mov(asmjit::x86::rdi, asmjit::x86::r13); // TOS
-    assembler->comment("; call spit_char");
-    assembler->call(spit_char);
-    assembler->pop(asmjit::x86::rdi); // Pop TOS off the stack
+    compile_emit_inline(asmjit::x86::r13);
 
     assembler->mov(asmjit::x86::r13, asmjit::x86::r12); // Move TOS-1 into TOS
     assembler->mov(asmjit::x86::r12, asmjit::x86::ptr(asmjit::x86::r15)); // Move TOS-2 into TOS-1
@@ -3715,6 +4838,19 @@ static void compile_SPACE() {
     assembler->pop(asmjit::x86::rdi); // Pop TOS off the stack
 }
 
+// TYPE ( c-addr u -- ) copies the whole string into the output buffer
+static void compile_TYPE() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->comment("; -- TYPE ");
+    assembler->push(asmjit::x86::rdi);
+    assembler->mov(asmjit::x86::rdi, asmjit::x86::r12); // addr
+    assembler->mov(asmjit::x86::rsi, asmjit::x86::r13); // len
+    assembler->call(spit_type);
+    assembler->pop(asmjit::x86::rdi);
+    compile_2DROP();
+}
+
 static void compile_CLS() {
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
@@ -3795,101 +4931,333 @@ static void compile_PAGE() {
 //     labels.jnz(*assembler,"emit_loop");
 // }
 
-void code_generator_add_io_words() {
-    ForthDictionary &dict = ForthDictionary::instance();
+void code_generator_add_io_words() {
+    ForthDictionary &dict = ForthDictionary::instance();
+
+    dict.addCodeWord("[CHAR]", "FORTH",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     nullptr,
+                     runImmediateCHAR,
+                     &compile_CHAR);
+
+    dict.addCodeWord("CHAR", "FORTH",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     nullptr,
+                     runImmediateCHAR,
+                     &compile_CHAR);
+
+
+    dict.addCodeWord("[']", "FORTH",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     &compileImmediateTICK);
+
+    dict.addCodeWord("'", "FORTH",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     nullptr,
+                     runImmediateTICK,
+                     nullptr);
+
+
+    dict.addCodeWord(".\"", "FORTH",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     nullptr,
+                     runImmediateString,
+                     &compile_DotString);
+
+    dict.addCodeWord("S\"", "FORTH",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     nullptr,
+                     runImmediateSQuote,
+                     &compile_SQuote);
+
+
+    // dict.addCodeWord(".", "FORTH",
+    //                  ForthState::EXECUTABLE,
+    //                  ForthWordType::WORD,
+    //                  static_cast<ForthFunction>(&compile_DOT),
+    //                  code_generator_build_forth(".", compile_DOT),
+    //                  nullptr);
+
+
+    dict.addCodeWord("SPACE", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&compile_SPACE),
+                     code_generator_build_forth("SPACE", compile_SPACE),
+                     nullptr);
+
+    dict.addCodeWord("(PAGE)", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&compile_PAGE),
+                     code_generator_build_forth("(PAGE)", compile_PAGE),
+                     nullptr);
+
+    // dict.addCodeWord("COUNT", "FORTH",
+    //                  ForthState::EXECUTABLE,
+    //                  ForthWordType::WORD,
+    //                  static_cast<ForthFunction>(&compile_COUNT),
+    //                  code_generator_build_forth("COUNT", compile_COUNT),
+    //                  nullptr);
+
+
+    // dict.addCodeWord("TYPE", "FORTH",
+    //                  ForthState::EXECUTABLE,
+    //                  ForthWordType::WORD,
+    //                  static_cast<ForthFunction>(&compile_TYPE),
+    //                  code_generator_build_forth("TYPE", compile_TYPE),
+    //                  nullptr);
+
+    dict.addCodeWord("TYPE", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     static_cast<ForthFunction>(&compile_TYPE),
+                     code_generator_build_forth("TYPE", compile_TYPE),
+                     nullptr);
+
+    dict.addCodeWord("FLUSH", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     spit_flush,
+                     nullptr);
+
+    dict.addCodeWord("U.", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     spit_unsigned,
+                     nullptr);
+
+    dict.addCodeWord(".", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     spit_signed,
+                     nullptr);
+
+    dict.addCodeWord("D.", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     spit_double,
+                     nullptr);
+
+    dict.addCodeWord("(U.)", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     paren_unsigned,
+                     nullptr);
+
+    dict.addCodeWord("(.)", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     paren_signed,
+                     nullptr);
+
+    dict.addCodeWord("(D.)", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     paren_double,
+                     nullptr);
 
-    dict.addCodeWord("[CHAR]", "FORTH",
-                     ForthState::IMMEDIATE,
+    dict.addCodeWord("<#", "FORTH",
+                     ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      nullptr,
+                     hold_start,
+                     nullptr);
+
+    dict.addCodeWord("#", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
                      nullptr,
-                     runImmediateCHAR,
-                     &compile_CHAR);
+                     hold_digit,
+                     nullptr);
 
-    dict.addCodeWord("CHAR", "FORTH",
-                     ForthState::IMMEDIATE,
+    dict.addCodeWord("#S", "FORTH",
+                     ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      nullptr,
+                     hold_digits,
+                     nullptr);
+
+    dict.addCodeWord("HOLD", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
                      nullptr,
-                     runImmediateCHAR,
-                     &compile_CHAR);
+                     hold,
+                     nullptr);
 
+    dict.addCodeWord("SIGN", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     hold_sign,
+                     nullptr);
 
-    dict.addCodeWord("[']", "FORTH",
-                     ForthState::IMMEDIATE,
+    dict.addCodeWord("#>", "FORTH",
+                     ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      nullptr,
+                     hold_end,
+                     nullptr);
+
+    dict.addCodeWord("R/O", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
                      nullptr,
+                     file_read_only,
+                     nullptr);
+
+    dict.addCodeWord("W/O", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
                      nullptr,
-                     &compileImmediateTICK);
+                     file_write_only,
+                     nullptr);
 
-    dict.addCodeWord("'", "FORTH",
-                     ForthState::IMMEDIATE,
+    dict.addCodeWord("R/W", "FORTH",
+                     ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      nullptr,
+                     file_read_write,
+                     nullptr);
+
+    dict.addCodeWord("OPEN-FILE", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
                      nullptr,
-                     runImmediateTICK,
+                     open_file,
                      nullptr);
 
+    dict.addCodeWord("CREATE-FILE", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     create_file,
+                     nullptr);
 
-    dict.addCodeWord(".\"", "FORTH",
-                     ForthState::IMMEDIATE,
+    dict.addCodeWord("CLOSE-FILE", "FORTH",
+                     ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      nullptr,
+                     close_file,
+                     nullptr);
+
+    dict.addCodeWord("READ-FILE", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
                      nullptr,
-                     runImmediateString,
-                     &compile_DotString);
+                     read_file,
+                     nullptr);
 
+    dict.addCodeWord("WRITE-FILE", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     write_file,
+                     nullptr);
 
-    // dict.addCodeWord(".", "FORTH",
-    //                  ForthState::EXECUTABLE,
-    //                  ForthWordType::WORD,
-    //                  static_cast<ForthFunction>(&compile_DOT),
-    //                  code_generator_build_forth(compile_DOT),
-    //                  nullptr);
+    dict.addCodeWord("FILE-SIZE", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     file_size,
+                     nullptr);
 
+    dict.addCodeWord("READ-FILE-ASYNC", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     read_file_async,
+                     nullptr);
 
-    dict.addCodeWord("SPACE", "FORTH",
+    dict.addCodeWord("AWAIT", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
-                     static_cast<ForthFunction>(&compile_SPACE),
-                     code_generator_build_forth(compile_SPACE),
+                     nullptr,
+                     await_request,
                      nullptr);
 
-    dict.addCodeWord("(PAGE)", "FORTH",
+    dict.addCodeWord("BLOCK", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
-                     static_cast<ForthFunction>(&compile_PAGE),
-                     code_generator_build_forth(compile_PAGE),
+                     nullptr,
+                     get_block,
                      nullptr);
 
-    // dict.addCodeWord("COUNT", "FORTH",
-    //                  ForthState::EXECUTABLE,
-    //                  ForthWordType::WORD,
-    //                  static_cast<ForthFunction>(&compile_COUNT),
-    //                  code_generator_build_forth(compile_COUNT),
-    //                  nullptr);
+    dict.addCodeWord("BUFFER", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     get_buffer,
+                     nullptr);
 
+    dict.addCodeWord("UPDATE", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     update_block,
+                     nullptr);
 
-    // dict.addCodeWord("TYPE", "FORTH",
-    //                  ForthState::EXECUTABLE,
-    //                  ForthWordType::WORD,
-    //                  static_cast<ForthFunction>(&compile_TYPE),
-    //                  code_generator_build_forth(compile_TYPE),
-    //                  nullptr);
+    dict.addCodeWord("SAVE-BUFFERS", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     save_buffers,
+                     nullptr);
+
+    dict.addCodeWord("EMPTY-BUFFERS", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     empty_buffers,
+                     nullptr);
+
+    dict.addCodeWord("OPEN-BLOCKS", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     open_blocks,
+                     nullptr);
+
+    dict.addCodeWord("BLOCK-BUFFERS", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     block_buffers,
+                     nullptr);
 
     dict.addCodeWord("CLS", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_CLS),
-                     code_generator_build_forth(compile_CLS),
+                     code_generator_build_forth("CLS", compile_CLS),
                      nullptr);
 
     dict.addCodeWord("CR", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_CR),
-                     code_generator_build_forth(compile_CR),
+                     code_generator_build_forth("CR", compile_CR),
                      nullptr);
 
 
@@ -3897,7 +5265,7 @@ void code_generator_add_io_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_EMIT),
-                     code_generator_build_forth(compile_EMIT),
+                     code_generator_build_forth("EMIT", compile_EMIT),
                      nullptr);
 
 
@@ -3905,7 +5273,7 @@ void code_generator_add_io_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_KEY),
-                     code_generator_build_forth(compile_KEY),
+                     code_generator_build_forth("KEY", compile_KEY),
                      nullptr);
 }
 
@@ -4238,6 +5606,8 @@ static void genBegin() {
     loopStack.push({BEGIN_AGAIN_REPEAT_UNTIL, beginLabel});
 }
 
+static void genUntilEnd();
+
 static void genUntil() {
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
@@ -4259,6 +5629,14 @@ static void genUntil() {
     assembler->comment("; Jump back if zero");
     assembler->test(topOfStack, topOfStack);
     assembler->jz(beginLabels.beginLabel);
+    genUntilEnd();
+}
+
+// after UNTIL has branched back to BEGIN
+static void genUntilEnd() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    const auto &beginLabels = std::get<BeginAgainRepeatUntilLabel>(loopStack.top().label);
 
     assembler->comment("; LABEL for REPEAT/UNTIL");
     // Bind the appropriate labels
@@ -4375,7 +5753,8 @@ static void genRecurse() {
     assembler->pop(asmjit::x86::rdi);
 }
 
-static void genIf() {
+// open an IF, the label is where the code goes when the condition is false
+static asmjit::Label genIfStart() {
     asmjit::x86::Assembler *assembler;
     initialize_assembler(assembler);
     IfThenElseLabel branches;
@@ -4392,7 +5771,13 @@ static void genIf() {
     loopStack.push({IF_THEN_ELSE, branches});
 
     assembler->comment("; -- IF ");
+    return branches.ifLabel;
+}
 
+static void genIf() {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    const asmjit::Label ifLabel = genIfStart();
 
     // Pop the condition flag from the data stack
     asmjit::x86::Gp flag = asmjit::x86::rax;
@@ -4401,7 +5786,7 @@ static void genIf() {
     // Conditional jump to either the ELSE or THEN location
     assembler->comment("; 0 branch to ELSE or THEN");
     assembler->test(flag, flag);
-    assembler->jz(branches.ifLabel);
+    assembler->jz(ifLabel);
 }
 
 
@@ -4453,9 +5838,189 @@ static void genThen() {
     }
 }
 
+// comparisons the optimizer joins to the IF, UNTIL or WHILE after them
+enum class BranchCompare { NONE, LT, GT, EQ, NE, LE, FLT, FGT };
+
+static BranchCompare branch_compare(const std::string_view text) {
+    std::string name(text);
+    std::transform(name.begin(), name.end(), name.begin(), [](const unsigned char c) { return std::toupper(c); });
+    if (name == "<") return BranchCompare::LT;
+    if (name == ">") return BranchCompare::GT;
+    if (name == "=") return BranchCompare::EQ;
+    if (name == "<>") return BranchCompare::NE;
+    if (name == "<=") return BranchCompare::LE;
+    if (name == "F<") return BranchCompare::FLT;
+    if (name == "F>") return BranchCompare::FGT;
+    return BranchCompare::NONE;
+}
+
+// compare and jump to target when the comparison is false, the flag is never made
+static void genCompareBranch(const ForthToken &token, const bool immediate, const asmjit::Label &target) {
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    const BranchCompare compare = branch_compare(token.value);
+    assembler->commentf("; -- %.*s and branch", static_cast<int>(token.value.size()), token.value.data());
+
+    // the stack is dropped with lea, which leaves the flags alone
+    if (compare == BranchCompare::FLT || compare == BranchCompare::FGT) {
+        assembler->movq(asmjit::x86::xmm0, asmjit::x86::r12);
+        assembler->movq(asmjit::x86::xmm1, asmjit::x86::r13);
+        assembler->mov(asmjit::x86::r13, asmjit::x86::ptr(asmjit::x86::r15));
+        assembler->mov(asmjit::x86::r12, asmjit::x86::ptr(asmjit::x86::r15, 8));
+        assembler->add(asmjit::x86::r15, 16);
+        if (compare == BranchCompare::FLT) {
+            assembler->ucomisd(asmjit::x86::xmm0, asmjit::x86::xmm1);
+        } else {
+            assembler->ucomisd(asmjit::x86::xmm1, asmjit::x86::xmm0);
+        }
+        // below, or unordered, is true as for f< and f>
+        assembler->jae(target);
+        return;
+    }
+
+    if (immediate) {
+        const auto value = static_cast<int64_t>(token.int_value);
+        if (value == 0) {
+            assembler->test(asmjit::x86::r13, asmjit::x86::r13);
+        } else if (value >= INT32_MIN && value <= INT32_MAX) {
+            assembler->cmp(asmjit::x86::r13, asmjit::imm(value));
+        } else {
+            assembler->mov(asmjit::x86::rax, asmjit::imm(value));
+            assembler->cmp(asmjit::x86::r13, asmjit::x86::rax);
+        }
+        assembler->mov(asmjit::x86::r13, asmjit::x86::r12);
+        assembler->mov(asmjit::x86::r12, asmjit::x86::ptr(asmjit::x86::r15));
+        assembler->lea(asmjit::x86::r15, asmjit::x86::ptr(asmjit::x86::r15, 8));
+    } else {
+        assembler->cmp(asmjit::x86::r12, asmjit::x86::r13);
+        assembler->mov(asmjit::x86::r13, asmjit::x86::ptr(asmjit::x86::r15));
+        assembler->mov(asmjit::x86::r12, asmjit::x86::ptr(asmjit::x86::r15, 8));
+        assembler->lea(asmjit::x86::r15, asmjit::x86::ptr(asmjit::x86::r15, 16));
+    }
+
+    switch (compare) {
+        case BranchCompare::LT: assembler->jge(target); break;
+        case BranchCompare::GT: assembler->jle(target); break;
+        case BranchCompare::EQ: assembler->jne(target); break;
+        case BranchCompare::NE: assembler->je(target); break;
+        case BranchCompare::LE: assembler->jg(target); break;
+        default:
+            SignalHandler::instance().raise(11);
+    }
+}
+
+// IF_CMP UNTIL_CMP WHILE_CMP and their _IMM forms, a comparison and the branch that uses it
+void runImmediateCOMPARE_BRANCH(TokenStream &tokens) {
+    if (tokens.empty()) return;
+
+    const ForthToken &first = tokens.front();
+    if (first.type != TokenType::TOKEN_OPTIMIZED) {
+        SignalHandler::instance().raise(11); // Invalid token - raise an error
+        return;
+    }
+
+    const bool immediate = first.op == OptOp::IF_CMP_IMM || first.op == OptOp::UNTIL_CMP_IMM ||
+                           first.op == OptOp::WHILE_CMP_IMM;
+    if (first.op == OptOp::IF_CMP || first.op == OptOp::IF_CMP_IMM) {
+        genCompareBranch(first, immediate, genIfStart());
+        return;
+    }
+
+    if (loopStack.empty() || loopStack.top().type != BEGIN_AGAIN_REPEAT_UNTIL) {
+        throw std::runtime_error("compare branch: No matching BEGIN_AGAIN_REPEAT_UNTIL structure on the stack");
+    }
+    const auto &beginLabels = std::get<BeginAgainRepeatUntilLabel>(loopStack.top().label);
+    if (first.op == OptOp::UNTIL_CMP || first.op == OptOp::UNTIL_CMP_IMM) {
+        genCompareBranch(first, immediate, beginLabels.beginLabel);
+        genUntilEnd();
+    } else {
+        genCompareBranch(first, immediate, beginLabels.whileLabel);
+    }
+}
+
+// an arm of a SELECT, the value it leaves on top in the stack after the flag is taken
+static void genSelectValue(asmjit::x86::Assembler *assembler, const ForthToken &arm, const asmjit::x86::Gp &reg) {
+    if (arm.type == TokenType::TOKEN_NUMBER) {
+        assembler->mov(reg, asmjit::imm(arm.int_value));
+    } else if (arm.value == "DUP" || arm.value == "NIP") {
+        assembler->mov(reg, asmjit::x86::r13);
+    } else {
+        // OVER or DROP
+        assembler->mov(reg, asmjit::x86::r12);
+    }
+}
+
+// IF a ELSE b THEN as a conditional move, the optimizer puts the two arms after the SELECT token
+void runImmediateSELECT(TokenStream &tokens) {
+    if (tokens.size() < 3) {
+        SignalHandler::instance().raise(11);
+        return;
+    }
+    tokens.pop_front();
+    const ForthToken whenTrue = tokens.front();
+    tokens.pop_front();
+    const ForthToken whenFalse = tokens.front(); // popped by the compiler
+
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    assembler->comment("; -- IF .. ELSE .. THEN as cmov");
+    assembler->mov(asmjit::x86::rdx, asmjit::x86::r13); // the flag
+    compile_DROP();
+    // both values are taken before the stack moves
+    genSelectValue(assembler, whenTrue, asmjit::x86::rax);
+    genSelectValue(assembler, whenFalse, asmjit::x86::rcx);
+    if (whenTrue.type == TokenType::TOKEN_NUMBER || whenTrue.value == "DUP" || whenTrue.value == "OVER") {
+        compile_DUP();
+    } else {
+        compile_DROP();
+    }
+    assembler->mov(asmjit::x86::r13, asmjit::x86::rcx);
+    assembler->test(asmjit::x86::rdx, asmjit::x86::rdx);
+    assembler->cmovne(asmjit::x86::r13, asmjit::x86::rax);
+}
+
+// variable @ IF  tests the variable in memory, nothing is pushed
+void runImmediateVAR_AT_IF(TokenStream &tokens) {
+    if (tokens.empty()) return;
+    const ForthToken &first = tokens.front();
+    const auto address = optimized_variable(first);
+
+    asmjit::x86::Assembler *assembler;
+    initialize_assembler(assembler);
+    const asmjit::Label ifLabel = genIfStart();
+    assembler->commentf("; -- %.*s @ IF ", static_cast<int>(first.value.size()), first.value.data());
+    assembler->mov(asmjit::x86::rax, asmjit::imm(address));
+    assembler->cmp(asmjit::x86::qword_ptr(asmjit::x86::rax), asmjit::imm(0));
+    assembler->je(ifLabel);
+}
+
 void code_generator_add_control_flow_words() {
     ForthDictionary &dict = ForthDictionary::instance();
 
+    for (const OptOp op: {OptOp::IF_CMP, OptOp::IF_CMP_IMM, OptOp::UNTIL_CMP, OptOp::UNTIL_CMP_IMM,
+                          OptOp::WHILE_CMP, OptOp::WHILE_CMP_IMM}) {
+        dict.addCodeWord(opt_op_name(op), "FRAGMENTS",
+                         ForthState::IMMEDIATE,
+                         ForthWordType::MACRO,
+                         nullptr,
+                         nullptr,
+                         runImmediateCOMPARE_BRANCH);
+    }
+
+    dict.addCodeWord("VAR_@_IF", "FRAGMENTS",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::MACRO,
+                     nullptr,
+                     nullptr,
+                     runImmediateVAR_AT_IF);
+
+    dict.addCodeWord("SELECT", "FRAGMENTS",
+                     ForthState::IMMEDIATE,
+                     ForthWordType::MACRO,
+                     nullptr,
+                     nullptr,
+                     runImmediateSELECT);
+
 
     dict.addCodeWord("EXIT", "FORTH",
                      ForthState::GENERATOR,
@@ -4758,73 +6323,45 @@ static void genPushXmm0(asmjit::x86::Assembler *assembler) {
 // }
 
 
-void float_to_string(double value, char *buffer, int precision) {
-    // Ensure precision is non-negative
-    if (precision < 0) {
-        precision = 0;
-    }
-
-    char *ptr = buffer; // Pointer for traversing the buffer
-    uint64_t int_part = (uint64_t) value; // Integer part of the number
-    double frac_part = value - int_part; // Fractional part of the number
-
-    // Handle the sign
-    if (value < 0) {
-        *ptr++ = '-';
-        value = -value;
-        int_part = (uint64_t) value;
-        frac_part = value - int_part;
-    }
-
-    // Convert integer part and store directly to the main buffer
-    char *int_start = ptr; // Remember where the integer part starts
-    do {
-        *ptr++ = '0' + (int_part % 10); // Extract least significant digit
-        int_part /= 10; // Remove the digit
-    } while (int_part > 0);
-
-    // Reverse the integer part in-place
-    char *int_end = ptr - 1; // End of the integer digits
-    while (int_start < int_end) {
-        char temp = *int_start;
-        *int_start++ = *int_end;
-        *int_end-- = temp;
-    }
-
-    // Process fractional part if precision > 0
-    if (precision > 0) {
-        *ptr++ = '.'; // Add decimal point
+// F. FE. FS. format straight into the output buffer, followed by a space
+static void float_dot(const FloatStyle style) {
+    const double f = cfpop();
+    auto &out = OutputBuffer::instance();
+    char *text = out.reserve(FLOAT_TEXT_MAX + 1);
+    size_t len = format_float(f, style, floatPrecision, text);
+    text[len++] = ' ';
+    out.commit(len);
+}
 
-        // Process fractional digits
-        char *frac_start = ptr; // Start of fractional part
-        for (int i = 0; i < precision; i++) {
-            frac_part *= 10; // Shift the fractional part
-            int digit = (int) frac_part; // Get the next digit
-            *ptr++ = '0' + digit; // Append the digit
-            frac_part -= digit; // Remove the digit from the fractional part
-        }
+static void genFDot() {
+    float_dot(FloatStyle::GENERAL);
+}
 
-        // Trim trailing zeros while writing the fractional part
-        while (ptr > frac_start && *(ptr - 1) == '0') {
-            ptr--;
-        }
+static void genFEDot() {
+    float_dot(FloatStyle::ENGINEERING);
+}
 
-        // Remove the decimal point if no fractional digits remain
-        if (ptr > buffer && *(ptr - 1) == '.') {
-            ptr--;
-        }
-    }
+static void genFSDot() {
+    float_dot(FloatStyle::SCIENTIFIC);
+}
 
-    // Null-terminate the string
-    *ptr = '\0';
+// (F.) ( r -- c-addr u ) the text is only good until the next (F.)
+static void genParenFDot() {
+    static char text[FLOAT_TEXT_MAX];
+    const size_t len = format_float(cfpop(), FloatStyle::GENERAL, floatPrecision, text);
+    cpush(reinterpret_cast<int64_t>(text));
+    cpush(static_cast<int64_t>(len));
 }
 
+// PRECISION ( -- u )
+static void get_precision() {
+    cpush(floatPrecision);
+}
 
-static void genFDot() {
-    char num_pad[32];
-    double f = cfpop();
-    float_to_string(f, num_pad, 2);
-    std::cout << num_pad;
+// SET-PRECISION ( u -- ) 0 prints the shortest digits that read back exactly
+static void set_precision() {
+    const int64_t digits = cpop();
+    floatPrecision = static_cast<int>(std::clamp<int64_t>(digits, 0, 17));
 }
 
 
@@ -5145,14 +6682,14 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&compile_DIGIT),
-                     code_generator_build_forth(compile_DIGIT),
+                     code_generator_build_forth("DIGIT", compile_DIGIT),
                      nullptr);
 
     dict.addCodeWord("f=", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFEquals),
-                     code_generator_build_forth(genFEquals),
+                     code_generator_build_forth("f=", genFEquals),
                      nullptr
     );
 
@@ -5160,7 +6697,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genSqrt),
-                     code_generator_build_forth(genSqrt),
+                     code_generator_build_forth("fsqrt", genSqrt),
                      nullptr
     );
 
@@ -5168,7 +6705,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFloatToIntFloor),
-                     code_generator_build_forth(genFloatToIntFloor),
+                     code_generator_build_forth("floor", genFloatToIntFloor),
                      nullptr
     );
 
@@ -5176,7 +6713,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFloatToIntRounding),
-                     code_generator_build_forth(genFloatToIntRounding),
+                     code_generator_build_forth("fround", genFloatToIntRounding),
                      nullptr
     );
 
@@ -5185,7 +6722,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFloatToInt),
-                     code_generator_build_forth(genFloatToInt),
+                     code_generator_build_forth("ftruncate", genFloatToInt),
                      nullptr
     );
 
@@ -5193,7 +6730,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFloatToInt),
-                     code_generator_build_forth(genFloatToInt),
+                     code_generator_build_forth("f>s", genFloatToInt),
                      nullptr
     );
 
@@ -5201,7 +6738,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genIntToFloat),
-                     code_generator_build_forth(genIntToFloat),
+                     code_generator_build_forth("s>f", genIntToFloat),
                      nullptr
     );
 
@@ -5210,7 +6747,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFGreater),
-                     code_generator_build_forth(genFGreater),
+                     code_generator_build_forth("f>", genFGreater),
                      nullptr
     );
 
@@ -5219,7 +6756,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFLess),
-                     code_generator_build_forth(genFLess),
+                     code_generator_build_forth("f<", genFLess),
                      nullptr
     );
 
@@ -5228,7 +6765,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genSin),
-                     code_generator_build_forth(genSin),
+                     code_generator_build_forth("sin", genSin),
                      nullptr
     );
 
@@ -5236,7 +6773,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genCos),
-                     code_generator_build_forth(genCos),
+                     code_generator_build_forth("cos", genCos),
                      nullptr
     );
 
@@ -5245,7 +6782,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFAbs),
-                     code_generator_build_forth(genFAbs),
+                     code_generator_build_forth("fabs", genFAbs),
                      nullptr
     );
 
@@ -5254,7 +6791,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFMin),
-                     code_generator_build_forth(genFMin),
+                     code_generator_build_forth("fmin", genFMin),
                      nullptr
     );
 
@@ -5263,7 +6800,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFMax),
-                     code_generator_build_forth(genFMax),
+                     code_generator_build_forth("fmax", genFMax),
                      nullptr
     );
 
@@ -5272,7 +6809,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFMod),
-                     code_generator_build_forth(genFMod),
+                     code_generator_build_forth("fmod", genFMod),
                      nullptr
     );
 
@@ -5281,7 +6818,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFDiv),
-                     code_generator_build_forth(genFDiv),
+                     code_generator_build_forth("f/", genFDiv),
                      nullptr
     );
 
@@ -5290,7 +6827,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFMul),
-                     code_generator_build_forth(genFMul),
+                     code_generator_build_forth("f*", genFMul),
                      nullptr
     );
 
@@ -5299,7 +6836,7 @@ void code_generator_add_float_words() {
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFSub),
-                     code_generator_build_forth(genFSub),
+                     code_generator_build_forth("f-", genFSub),
                      nullptr
     );
 
@@ -5312,11 +6849,51 @@ void code_generator_add_float_words() {
                      nullptr
     );
 
+    dict.addCodeWord("fe.", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     genFEDot,
+                     nullptr
+    );
+
+    dict.addCodeWord("fs.", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     genFSDot,
+                     nullptr
+    );
+
+    dict.addCodeWord("(f.)", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     genParenFDot,
+                     nullptr
+    );
+
+    dict.addCodeWord("precision", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     get_precision,
+                     nullptr
+    );
+
+    dict.addCodeWord("set-precision", "FORTH",
+                     ForthState::EXECUTABLE,
+                     ForthWordType::WORD,
+                     nullptr,
+                     set_precision,
+                     nullptr
+    );
+
     dict.addCodeWord("f+", "FORTH",
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      static_cast<ForthFunction>(&genFPlus),
-                     code_generator_build_forth(genFPlus),
+                     code_generator_build_forth("f+", genFPlus),
                      nullptr
     );
 }
@@ -0,0 +1,34 @@
+#include "CodeIndex.h"
+#include <algorithm>
+
+
+void CodeIndex::add(const void *code, const size_t size, const std::string &name) {
+    const auto start = reinterpret_cast<uintptr_t>(code);
+    if (!ranges.empty() && start < ranges.back().start) {
+        sorted = false;
+    }
+    ranges.push_back({start, start + size, name});
+    lowest = std::min(lowest, start);
+    highest = std::max(highest, start + size);
+}
+
+void CodeIndex::remove(const uintptr_t start) {
+    ranges.erase(std::remove_if(ranges.begin(), ranges.end(),
+                                [start](const Range &r) { return r.start == start; }),
+                 ranges.end());
+}
+
+const CodeIndex::Range *CodeIndex::find(const uintptr_t addr) {
+    if (!contains(addr)) return nullptr;
+    if (!sorted) {
+        std::sort(ranges.begin(), ranges.end(),
+                  [](const Range &a, const Range &b) { return a.start < b.start; });
+        sorted = true;
+    }
+    // the last range starting at or before addr
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), addr,
+                               [](const uintptr_t a, const Range &r) { return a < r.start; });
+    if (it == ranges.begin()) return nullptr;
+    --it;
+    return addr < it->end ? &*it : nullptr;
+}
@@ -0,0 +1,110 @@
+#include "CodeListing.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include "Profiler.h"
+
+
+asmjit::Error ListingLogger::_log(const char *data, size_t size) noexcept {
+    if (forward) forward->log(data, size);
+
+    // asmjit logs an instruction before the buffer moves past it, so offset() is where it starts
+    const auto offset = static_cast<uint32_t>(assembler ? assembler->offset() : 0);
+    while (size > 0 && (data[size - 1] == '\n' || data[size - 1] == ' ')) --size;
+    while (size > 0 && *data == ' ') {
+        ++data;
+        --size;
+    }
+    if (size > 0) {
+        lines.push_back({offset, std::string(data, size)});
+    }
+    return asmjit::kErrorOk;
+}
+
+void CodeListing::add(const void *code, std::vector<ListingLine> lines) {
+    listings[reinterpret_cast<uintptr_t>(code)] = std::move(lines);
+}
+
+void CodeListing::remove(const void *code) {
+    listings.erase(reinterpret_cast<uintptr_t>(code));
+}
+
+const std::vector<ListingLine> *CodeListing::find(const void *code) const {
+    const auto it = listings.find(reinterpret_cast<uintptr_t>(code));
+    return it == listings.end() ? nullptr : &it->second;
+}
+
+// comments, labels and directives take no bytes of their own
+static bool is_instruction(const std::string &text) {
+    return !text.empty() && text[0] != ';' && text[0] != '.' && text[0] != '\\' && text.back() != ':';
+}
+
+static void print_bytes(const uint8_t *code, const size_t from, const size_t to) {
+    std::string hex;
+    for (size_t i = from; i < to && i < from + 8; ++i) {
+        static constexpr char digits[] = "0123456789abcdef";
+        hex += digits[code[i] >> 4];
+        hex += digits[code[i] & 15];
+    }
+    if (to - from > 8) hex += "..";
+    std::cout << std::left << std::setw(20) << hex << std::right;
+}
+
+void CodeListing::display(const void *code, const size_t size) const {
+    const auto *bytes = static_cast<const uint8_t *>(code);
+    const auto start = reinterpret_cast<uintptr_t>(code);
+    const auto samples = Profiler::instance().samplesIn(start, start + size);
+    size_t total = 0;
+    for (const auto &[ip, n]: samples) total += n;
+
+    const auto flags = std::cout.flags();
+    std::cout << std::hex;
+
+    const auto *lines = find(code);
+    if (!lines) {
+        // no listing, the bytes in rows of 16
+        std::cout << "No listing, SET LISTING ON before compiling to keep one" << std::endl;
+        for (size_t row = 0; row < size; row += 16) {
+            std::cout << std::setw(6) << std::setfill('0') << row << std::setfill(' ') << "  ";
+            for (size_t i = row; i < row + 16 && i < size; ++i) {
+                std::cout << std::setw(2) << std::setfill('0') << static_cast<int>(bytes[i]) << std::setfill(' ') << ' ';
+            }
+            size_t hits = 0;
+            for (const auto &[ip, n]: samples) {
+                if (ip >= start + row && ip < start + row + 16) hits += n;
+            }
+            if (hits) std::cout << std::dec << " " << hits << " samples" << std::hex;
+            std::cout << std::endl;
+        }
+        std::cout.flags(flags);
+        return;
+    }
+
+    for (size_t i = 0; i < lines->size(); ++i) {
+        const ListingLine &line = (*lines)[i];
+        if (!is_instruction(line.text)) {
+            // the source token that produced the code below stands out from the generator's comments
+            const bool token = line.text[0] == '\\';
+            std::cout << (token ? "" : std::string(28, ' ')) << line.text << std::endl;
+            continue;
+        }
+        size_t end = size;
+        for (size_t j = i + 1; j < lines->size(); ++j) {
+            if ((*lines)[j].offset > line.offset) {
+                end = (*lines)[j].offset;
+                break;
+            }
+        }
+        std::cout << std::setw(6) << std::setfill('0') << line.offset << std::setfill(' ') << "  ";
+        print_bytes(bytes, line.offset, end);
+        std::cout << line.text;
+        if (const auto it = samples.find(start + line.offset); it != samples.end()) {
+            std::cout << std::dec << "    ; " << it->second << " samples" << std::hex;
+        }
+        std::cout << std::endl;
+    }
+    if (total) {
+        std::cout << std::dec << total << " profile samples in this word" << std::endl;
+    }
+    std::cout.flags(flags);
+}
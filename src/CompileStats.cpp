@@ -0,0 +1,134 @@
+#include "CompileStats.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "ForthDictionaryEntry.h"
+
+
+CompileStats &CompilerStats::begin() {
+    pending = CompileStats{};
+    pending.tokenizeNs = tokenizeNs;
+    tokenizeNs = 0;
+    return pending;
+}
+
+void CompilerStats::end(const std::string &name, ForthDictionaryEntry *entry) {
+    entries.push_back({pending, name});
+    if (entry) {
+        entry->compileStats = &entries.back().stats;
+    }
+}
+
+const CompileStats *CompilerStats::find(const std::string &name) const {
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        if (it->name == name) return &it->stats;
+    }
+    return nullptr;
+}
+
+static uint32_t rules_applied(const CompileStats &s) {
+    uint32_t n = 0;
+    for (const uint32_t r: s.rules) n += r;
+    return n;
+}
+
+static double micros(const uint64_t ns) {
+    return static_cast<double>(ns) / 1000.0;
+}
+
+void CompilerStats::display(const size_t rows) const {
+    if (entries.empty()) {
+        std::cout << "No definitions compiled" << std::endl;
+        return;
+    }
+    CompileStats total;
+    std::vector<const Entry *> slowest;
+    for (const auto &e: entries) {
+        total.tokenizeNs += e.stats.tokenizeNs;
+        total.optimizeNs += e.stats.optimizeNs;
+        total.codegenNs += e.stats.codegenNs;
+        total.finalizeNs += e.stats.finalizeNs;
+        total.codeBytes += e.stats.codeBytes;
+        slowest.push_back(&e);
+    }
+    std::sort(slowest.begin(), slowest.end(),
+              [](const Entry *a, const Entry *b) { return a->stats.totalNs() > b->stats.totalNs(); });
+
+    const auto flags = std::cout.flags();
+    const auto precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1);
+
+    std::cout << entries.size() << " definitions, " << total.codeBytes << " bytes of code, "
+            << micros(total.totalNs()) << " us" << std::endl;
+    std::cout << "tokenize " << micros(total.tokenizeNs) << " us, optimize " << micros(total.optimizeNs)
+            << " us, codegen " << micros(total.codegenNs) << " us, finalize " << micros(total.finalizeNs)
+            << " us" << std::endl << std::endl;
+
+    std::cout << std::left << std::setw(20) << "word" << std::right
+            << std::setw(10) << "total us" << std::setw(10) << "tokenize" << std::setw(10) << "optimize"
+            << std::setw(10) << "codegen" << std::setw(10) << "finalize" << std::setw(8) << "bytes"
+            << std::setw(7) << "rules" << std::setw(7) << "calls" << std::setw(8) << "inlined"
+            << std::setw(8) << "spills" << std::endl;
+    for (size_t i = 0; i < slowest.size() && i < rows; ++i) {
+        const CompileStats &s = slowest[i]->stats;
+        std::cout << std::left << std::setw(20) << slowest[i]->name << std::right
+                << std::setw(10) << micros(s.totalNs())
+                << std::setw(10) << micros(s.tokenizeNs)
+                << std::setw(10) << micros(s.optimizeNs)
+                << std::setw(10) << micros(s.codegenNs)
+                << std::setw(10) << micros(s.finalizeNs)
+                << std::setw(8) << s.codeBytes
+                << std::setw(7) << rules_applied(s)
+                << std::setw(7) << s.calls
+                << std::setw(8) << s.inlined
+                << std::setw(8) << s.spills << std::endl;
+    }
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+void CompilerStats::display(const std::string &name) const {
+    const CompileStats *s = find(name);
+    if (!s) {
+        std::cout << "No compiler statistics for " << name << std::endl;
+        return;
+    }
+    const auto flags = std::cout.flags();
+    const auto precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1);
+
+    std::cout << name << ": " << s->codeBytes << " bytes, " << micros(s->totalNs()) << " us" << std::endl;
+    std::cout << "  tokenize " << micros(s->tokenizeNs) << " us" << std::endl;
+    std::cout << "  optimize " << micros(s->optimizeNs) << " us" << std::endl;
+    std::cout << "  codegen  " << micros(s->codegenNs) << " us" << std::endl;
+    std::cout << "  finalize " << micros(s->finalizeNs) << " us" << std::endl;
+    std::cout << "  calls " << s->calls << ", inlined " << s->inlined << ", spills " << s->spills << std::endl;
+    for (size_t op = 1; op < static_cast<size_t>(OptOp::COUNT); ++op) {
+        if (s->rules[op]) {
+            std::cout << "  " << opt_op_name(static_cast<OptOp>(op)) << " x " << s->rules[op] << std::endl;
+        }
+    }
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+void CompilerStats::dump() const {
+    for (const auto &e: entries) {
+        const CompileStats &s = e.stats;
+        std::cout << "{\"word\":\"" << e.name << "\",\"ns\":{\"tokenize\":" << s.tokenizeNs
+                << ",\"optimize\":" << s.optimizeNs << ",\"codegen\":" << s.codegenNs
+                << ",\"finalize\":" << s.finalizeNs << "},\"bytes\":" << s.codeBytes
+                << ",\"calls\":" << s.calls << ",\"inlined\":" << s.inlined << ",\"spills\":" << s.spills
+                << ",\"rules\":{";
+        bool first = true;
+        for (size_t op = 1; op < static_cast<size_t>(OptOp::COUNT); ++op) {
+            if (!s.rules[op]) continue;
+            std::cout << (first ? "" : ",") << '"' << opt_op_name(static_cast<OptOp>(op)) << "\":" << s.rules[op];
+            first = false;
+        }
+        std::cout << "}}" << std::endl;
+    }
+}
@@ -9,6 +9,21 @@
 
 #include "SignalHandler.h"
 #include "Settings.h"
+#include "CompileStats.h"
+#include "CodeIndex.h"
+#include "JitContext.h"
+#include "RegisterTracker.h"
+#include "Timing.h"
+#include "Tiering.h"
+#include "StackEffect.h"
+#include "DeferredWords.h"
+
+
+// size of the code finalized for f, 0 if it was not JIT code
+static uint64_t code_bytes(const ForthFunction f) {
+    const auto *range = CodeIndex::instance().find(reinterpret_cast<uintptr_t>(f));
+    return range ? range->end - range->start : 0;
+}
 
 
 
@@ -50,11 +65,17 @@ void Compiler::compile_let(const std::string &input) {
     std::transform(letString.begin(), letString.end(), letString.begin(),
                    [](unsigned char c) { return std::tolower(c); });
 
+    CompileStats &stats = CompilerStats::instance().begin();
+    uint64_t started = clock_ns();
+
     code_generator_startFunction(functionName);
 
     const auto tokens = tokenize(letString);
     Parser parser(tokens);
     const auto ast = parser.parseLetStatement();
+    // LET is tokenized and parsed here, not by the interpreter
+    stats.tokenizeNs = clock_ns() - started;
+    started = clock_ns();
 
     if ( jitLogging) parser.printAST(ast.get());
 
@@ -101,27 +122,87 @@ void Compiler::compile_let(const std::string &input) {
 
 
     compile_return();
+    stats.spills = static_cast<uint32_t>(RegisterTracker::instance().spillCount());
+    stats.codegenNs = clock_ns() - started;
+    started = clock_ns();
     const ForthFunction f = code_generator_finalizeFunction(functionName);
+    stats.finalizeNs = clock_ns() - started;
+    stats.codeBytes = code_bytes(f);
     //
     auto &dict = ForthDictionary::instance();
-    dict.addCodeWord(functionName, "FORTH",
+    const auto entry = dict.addCodeWord(functionName, "FORTH",
                     ForthState::EXECUTABLE,
                     ForthWordType::WORD,
                     nullptr,
                     f,
                     nullptr);
-
+    CompilerStats::instance().end(functionName, entry);
 
 }
 
  
-void Compiler::compile_words(std::deque<ForthToken> &input_tokens) {
-    // Create a copy of tokens and optimize if necessary
-    std::deque<ForthToken> tokens = input_tokens;
-    if (optimizer == true) {
-        Optimizer::instance().optimize(input_tokens, tokens);
+// the word each name between : and ; refers to now
+static std::vector<const ForthDictionaryEntry *> tier_bindings(const TokenStream &tokens) {
+    std::vector<const ForthDictionaryEntry *> bindings;
+    const auto &dict = ForthDictionary::instance();
+    for (size_t i = 2; i < tokens.size(); ++i) {
+        const auto &token = tokens[i];
+        if (token.type == TokenType::TOKEN_INTERPRETING) break;
+        if (token.type == TokenType::TOKEN_WORD || token.type == TokenType::TOKEN_VARIABLE) {
+            bindings.push_back(dict.findWord(token.value));
+        }
+    }
+    return bindings;
+}
+
+// what tier 0 code needs to compile the definition again, nullptr if it is not all on this line
+static TieredWord *tier_record(const TokenStream &tokens) {
+    if (tokens.size() < 3 || tokens[0].type != TokenType::TOKEN_COMPILING) return nullptr;
+    for (size_t i = 2; i < tokens.size(); ++i) {
+        if (tokens[i].type == TokenType::TOKEN_END) return nullptr;
+        if (tokens[i].type != TokenType::TOKEN_INTERPRETING) continue;
+
+        TieredWord word;
+        const char *start = tokens[0].value.data();
+        word.source.assign(start, tokens[i].value.data() + tokens[i].value.size() - start);
+        word.name = std::string(tokens[1].value);
+        word.base = tokens.base;
+        word.bindings = tier_bindings(tokens);
+        word.frame = ForthDictionary::instance().getLatestWordAdded();
+        return Tiering::instance().add(std::move(word));
+    }
+    return nullptr;
+}
+
+void Compiler::compile_words(TokenStream &input_tokens) {
+    busy = true;
+    // tier 0 compiles the tokens as they are, the optimizer runs when the word is hot
+    TieredWord *tiered = tieredCompilation ? tier_record(input_tokens) : nullptr;
+    const bool optimizing = optimizer && !tiered;
+    // the effect is worked out from the source, before the optimizer merges words
+    StackEffect effect;
+    if (input_tokens.size() > 2) {
+        std::string problem;
+        effect = StackEffects::instance().infer(input_tokens, problem);
+        if (!problem.empty()) {
+            std::cerr << "Warning: " << input_tokens[1].value << ": " << problem << std::endl;
+        }
+    }
+    // Optimize into the reused stream, otherwise compile the tokens where they are
+    TokenStream &tokens = optimizing ? optimized : input_tokens;
+    CompileStats &stats = CompilerStats::instance().begin();
+    uint64_t started = clock_ns();
+    if (optimizing) {
+        Optimizer::instance().optimize(input_tokens, optimized);
+        input_tokens.clear();
+        for (size_t i = 0; i < optimized.size(); ++i) {
+            if (optimized[i].type == TokenType::TOKEN_OPTIMIZED) {
+                ++stats.rules[static_cast<size_t>(optimized[i].op)];
+            }
+        }
+        stats.optimizeNs = clock_ns() - started;
+        started = clock_ns();
     }
-    input_tokens.clear();
     // Tokenizer::instance().print_token_list(tokens);
     // Step 1: Validate the compiler state and token structure
     validate_compiler_state(tokens);
@@ -131,7 +212,11 @@ void Compiler::compile_words(std::deque<ForthToken> &input_tokens) {
 
 
     // Step 3: Start code generation for the function
-    code_generator_startFunction(word_name);
+    if (tiered) {
+        code_generator_startFunction(word_name, tiered->frame, tiered);
+    } else {
+        code_generator_startFunction(word_name);
+    }
 
     // Step 4: Process tokens
     while (!tokens.empty()) {
@@ -143,26 +228,104 @@ void Compiler::compile_words(std::deque<ForthToken> &input_tokens) {
         }
 
 
+        // mark where each source token's code starts in the listing
+        if (keepListing) {
+            const std::string_view text = token.type == TokenType::TOKEN_OPTIMIZED ? opt_op_name(token.op) : token.value;
+            JitContext::instance().getAssembler().commentf("\\ %.*s", static_cast<int>(text.size()), text.data());
+        }
+
         process_token(token, tokens, word_name);
 
 
         tokens.pop_front(); // Remove the processed token
     }
 
+    tokens.clear();
+
     // Step 5: Finalize the function and add it to the dictionary
     compile_return();
+    stats.codegenNs = clock_ns() - started;
+    started = clock_ns();
     ForthFunction f = code_generator_finalizeFunction(word_name);
+    stats.finalizeNs = clock_ns() - started;
+    stats.codeBytes = code_bytes(f);
     auto &dict = ForthDictionary::instance();
-    dict.addCodeWord(word_name, dict.getCurrentVocabularyName(),
+    const auto entry = dict.addCodeWord(word_name, dict.getCurrentVocabularyName(),
                      ForthState::EXECUTABLE,
                      ForthWordType::WORD,
                      nullptr,
                      f,
                      nullptr);
+    entry->effect = effect;
+    DeferredWords::instance().claimSites(entry);
+    if (tiered) {
+        tiered->entry = entry;
+    }
+    CompilerStats::instance().end(word_name, entry);
+    busy = false;
+}
+
+// compile a tier 0 word again from its source, with the optimizer
+ForthFunction Compiler::recompile(const TieredWord &word) {
+    if (busy) return nullptr;
+
+    // read the source in the BASE it was written in
+    TokenStream tokens;
+    auto *baseWord = ForthDictionary::instance().findWord("BASE");
+    auto *base = baseWord ? static_cast<int64_t *>(baseWord->data) : nullptr;
+    const int64_t saved = base ? *base : 10;
+    if (base) *base = word.base;
+    Tokenizer::instance().tokenize_forth(word.source, tokens);
+    if (base) *base = saved;
+
+    // a name that now means something else would change what the word does
+    if (tier_bindings(tokens) != word.bindings) return nullptr;
+
+    busy = true;
+    CompileStats &stats = CompilerStats::instance().begin();
+    uint64_t started = clock_ns();
+    Optimizer::instance().optimize(tokens, optimized);
+    for (size_t i = 0; i < optimized.size(); ++i) {
+        if (optimized[i].type == TokenType::TOKEN_OPTIMIZED) {
+            ++stats.rules[static_cast<size_t>(optimized[i].op)];
+        }
+    }
+    stats.optimizeNs = clock_ns() - started;
+    started = clock_ns();
+
+    // the name is a defined word by now, drop : and the name without checking them
+    optimized.pop_front();
+    std::string word_name = word.name;
+    optimized.pop_front();
+    code_generator_startFunction(word_name, word.frame, nullptr);
+    while (!optimized.empty()) {
+        const auto &token = optimized.front();
+        if (token.type == TokenType::TOKEN_END || token.type == TokenType::TOKEN_INTERPRETING) {
+            break;
+        }
+        if (keepListing) {
+            const std::string_view text = token.type == TokenType::TOKEN_OPTIMIZED ? opt_op_name(token.op) : token.value;
+            JitContext::instance().getAssembler().commentf("\\ %.*s", static_cast<int>(text.size()), text.data());
+        }
+        process_token(token, optimized, word_name);
+        optimized.pop_front();
+    }
+    optimized.clear();
+
+    compile_return();
+    stats.codegenNs = clock_ns() - started;
+    started = clock_ns();
+    const ForthFunction f = code_generator_finalizeFunction(word_name);
+    stats.finalizeNs = clock_ns() - started;
+    stats.codeBytes = code_bytes(f);
+    DeferredWords::instance().claimSites(word.entry);
+    CompilerStats::instance().end(word_name, word.entry);
+    busy = false;
+    return f;
 }
 
 // Helper Method: Validate Compiler State
-void Compiler::validate_compiler_state(std::deque<ForthToken> &tokens) {
+void Compiler::validate_compiler_state(TokenStream &tokens) {
     auto token = tokens.front();
     if (token.type != TokenType::TOKEN_COMPILING) {
         SignalHandler::instance().raise(16); // "Colon expected" or other similar error
@@ -174,8 +337,8 @@ void Compiler::validate_compiler_state(std::deque<ForthToken> &tokens) {
 }
 
 // Helper Method: Extract Word Name
-std::string Compiler::extract_word_name(std::deque<ForthToken> &tokens) {
-    auto token = tokens.front();
+std::string Compiler::extract_word_name(TokenStream &tokens) {
+    const auto token = tokens.front();
     if (token.type != TokenType::TOKEN_UNKNOWN) {
         SignalHandler::instance().raise(17); // "New name expected"
     }
@@ -183,16 +346,21 @@ std::string Compiler::extract_word_name(std::deque<ForthToken> &tokens) {
     if (tokens.empty()) {
         SignalHandler::instance().raise(6);
     }
-    return token.value; // Extract word name
+    return std::string(token.value); // Extract word name
 }
 
 // Helper Method: Process Token
-void Compiler::process_token(const ForthToken &token, std::deque<ForthToken> &tokens, std::string &word_name) {
+void Compiler::process_token(const ForthToken &token, TokenStream &tokens, std::string &word_name) {
     switch (token.type) {
         case TokenType::TOKEN_NUMBER:
             compile_token_number(token);
             break;
 
+        case TokenType::TOKEN_DOUBLE:
+            compile_token_number(token);
+            compile_pushLiteral(static_cast<int64_t>(token.int_value) < 0 ? -1 : 0);
+            break;
+
         case TokenType::TOKEN_FLOAT:
             compile_token_float(token);
             break;
@@ -225,17 +393,17 @@ void Compiler::compile_token_float(const ForthToken &token) {
 }
 
 // Helper Method: Compile Word Token
-void Compiler::compile_token_word(const ForthToken &token, std::deque<ForthToken> &tokens, [[maybe_unused]] std::string &word_name) {
+void Compiler::compile_token_word(const ForthToken &token, TokenStream &tokens, [[maybe_unused]] std::string &word_name) {
 
 
-    auto word_found = ForthDictionary::instance().findWord(token.value.c_str());
+    auto word_found = ForthDictionary::instance().findWord(token.value);
     if (word_found == nullptr) {
         std::cerr << "Word not found: " << token.value << std::endl;
         SignalHandler::instance().raise(6);
         return;
     }
 
-    const std::string called_word_name = token.value;
+    const std::string called_word_name(token.value);
 
     if (word_found->type == ForthWordType::VARIABLE ) {
 
@@ -244,6 +412,9 @@ void Compiler::compile_token_word(const ForthToken &token, std::deque<ForthToken
     } else if (word_found->generator) {
 
         word_found->generator();
+        ++CompilerStats::instance().current().inlined;
+    } else if (DeferredWords::instance().deferred(word_found)) {
+        compile_call_deferred(word_found, called_word_name);
     } else if (word_found->executable) {
         compile_call_forth(word_found->executable, called_word_name);
     } else if (word_found->immediate_compiler) {
@@ -253,10 +424,14 @@ void Compiler::compile_token_word(const ForthToken &token, std::deque<ForthToken
 }
 
 // Helper Method: Compile Optimized Token
-void Compiler::compile_token_optimized(const ForthToken &token, std::deque<ForthToken> &tokens) {
+void Compiler::compile_token_optimized(const ForthToken &token, TokenStream &tokens) {
     // Tokenizer::instance().print_token(token);
-    auto word_found = ForthDictionary::instance().findWord(token.optimized_op.c_str());
+    auto word_found = ForthDictionary::instance().findWord(opt_op_name(token.op));
     if (word_found && word_found->immediate_interpreter) {
         word_found->immediate_interpreter(tokens);
+    } else if (word_found && word_found->generator) {
+        // plain replacements such as SWAP DROP => NIP
+        word_found->generator();
     }
+    ++CompilerStats::instance().current().inlined;
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "DeferredWords.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include "ForthDictionaryEntry.h"
+#include "JitContext.h"
+
+
+DeferredWord &DeferredWords::add(ForthDictionaryEntry *entry, const ForthFunction action) {
+    DeferredWord &word = words[entry];
+    word.entry = entry;
+    word.action = action;
+    entry->executable = action;
+    return word;
+}
+
+DeferredWord *DeferredWords::deferred(const ForthDictionaryEntry *entry) {
+    const auto it = words.find(entry);
+    return it == words.end() ? nullptr : &it->second;
+}
+
+ForthFunction DeferredWords::xt(const ForthDictionaryEntry *entry) {
+    if (const DeferredWord *word = deferred(entry); word && word->thunk) return word->thunk;
+    return entry->executable;
+}
+
+// a direct call when the action is in reach, otherwise a call to the thunk
+bool DeferredWords::patch(uint8_t *rel32, const DeferredWord &word) {
+    for (const ForthFunction target: {word.action, word.thunk}) {
+        if (!target) continue;
+        const auto distance = reinterpret_cast<intptr_t>(target) - reinterpret_cast<intptr_t>(rel32 + 4);
+        if (distance < INT32_MIN || distance > INT32_MAX) continue;
+        const auto displacement = static_cast<int32_t>(distance);
+        return JitContext::instance().patch(rel32, &displacement, sizeof(displacement));
+    }
+    return false;
+}
+
+void DeferredWords::addSite(const ForthDictionaryEntry *word, uint8_t *rel32) {
+    DeferredWord *deferredWord = deferred(word);
+    if (!deferredWord) return;
+    if (!patch(rel32, *deferredWord)) {
+        std::cerr << "DEFER: call to " << word->getWordName() << " is out of reach" << std::endl;
+        SignalHandler::instance().raise(12);
+        return;
+    }
+    deferredWord->sites.push_back({rel32, nullptr});
+}
+
+// a word is added to the dictionary after its code is finalized, so its sites are stamped afterwards
+void DeferredWords::claimSites(const ForthDictionaryEntry *owner) {
+    for (auto &[key, word]: words) {
+        for (auto &site: word.sites) {
+            if (!site.owner) site.owner = owner;
+        }
+    }
+}
+
+void DeferredWords::retarget(ForthDictionaryEntry *entry, const ForthFunction action) {
+    DeferredWord *word = deferred(entry);
+    if (!word) return;
+    // the thunk reads action, a call through it sees the new action as soon as it is stored
+    __atomic_store_n(&word->action, action, __ATOMIC_RELEASE);
+    __atomic_store_n(&entry->executable, action, __ATOMIC_RELEASE);
+    for (const auto &site: word->sites) {
+        patch(site.rel32, *word);
+    }
+}
+
+bool DeferredWords::forget(const ForthDictionaryEntry *entry) {
+    for (auto &[key, word]: words) {
+        auto &sites = word.sites;
+        sites.erase(std::remove_if(sites.begin(), sites.end(),
+                                   [entry](const CallSite &site) { return site.owner == entry; }),
+                    sites.end());
+    }
+    const auto it = words.find(entry);
+    if (it == words.end()) return false;
+    if (it->second.thunk) {
+        JitContext::instance().release(it->second.thunk);
+    }
+    words.erase(it);
+    return true;
+}
+
+void DeferredWords::display() const {
+    if (words.empty()) {
+        std::cout << "No deferred words" << std::endl;
+        return;
+    }
+    std::cout << std::left << std::setw(24) << "word" << std::right
+            << std::setw(8) << "sites" << "  action" << std::endl;
+    for (const auto &[key, word]: words) {
+        const auto *action = CodeIndex::instance().find(reinterpret_cast<uintptr_t>(word.action));
+        std::cout << std::left << std::setw(24) << word.entry->getWordName() << std::right
+                << std::setw(8) << word.sites.size()
+                << "  " << (action ? action->name : "(none, IS sets it)") << std::endl;
+    }
+}
@@ -0,0 +1,105 @@
+#include "DivMagic.h"
+
+__extension__ typedef __int128 int128;
+__extension__ typedef unsigned __int128 uint128;
+
+static constexpr uint64_t TWO63 = 1ULL << 63;
+
+static uint64_t magnitude(const int64_t d) {
+    return d < 0 ? 0 - static_cast<uint64_t>(d) : static_cast<uint64_t>(d);
+}
+
+// Hacker's Delight, magic, for 64 bits
+SignedMagic signed_magic(const int64_t d) {
+    const uint64_t ad = magnitude(d);
+    const uint64_t t = TWO63 + (static_cast<uint64_t>(d) >> 63);
+    const uint64_t anc = t - 1 - t % ad; // largest n with n % d == d - 1
+    int p = 63;
+    uint64_t q1 = TWO63 / anc, r1 = TWO63 - q1 * anc;
+    uint64_t q2 = TWO63 / ad, r2 = TWO63 - q2 * ad;
+    uint64_t delta;
+    do {
+        ++p;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            ++q1;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad) {
+            ++q2;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    uint64_t multiplier = q2 + 1;
+    if (d < 0) multiplier = 0 - multiplier;
+    return {static_cast<int64_t>(multiplier), p - 64};
+}
+
+// Hacker's Delight, magicu2, for 64 bits
+UnsignedMagic unsigned_magic(const uint64_t d) {
+    bool add = false;
+    const uint64_t nc = UINT64_MAX - (0 - d) % d;
+    int p = 63;
+    uint64_t q1 = TWO63 / nc, r1 = TWO63 - q1 * nc;
+    uint64_t q2 = (TWO63 - 1) / d, r2 = (TWO63 - 1) - q2 * d;
+    uint64_t delta;
+    do {
+        ++p;
+        if (r1 >= nc - r1) {
+            q1 = 2 * q1 + 1;
+            r1 = 2 * r1 - nc;
+        } else {
+            q1 = 2 * q1;
+            r1 = 2 * r1;
+        }
+        if (r2 + 1 >= d - r2) {
+            if (q2 >= TWO63 - 1) add = true;
+            q2 = 2 * q2 + 1;
+            r2 = 2 * r2 + 1 - d;
+        } else {
+            if (q2 >= TWO63) add = true;
+            q2 = 2 * q2;
+            r2 = 2 * r2 + 1;
+        }
+        delta = d - 1 - r2;
+    } while (p < 128 && (q1 < delta || (q1 == delta && r1 == 0)));
+    return {q2 + 1, p - 64, add};
+}
+
+int64_t signed_quotient(const int64_t n, const int64_t d) {
+    const uint64_t ad = magnitude(d);
+    if ((ad & (ad - 1)) == 0) {
+        // a negative n is biased by 2^k-1 so the shift rounds toward zero
+        const int k = __builtin_ctzll(ad);
+        int64_t q = n;
+        if (k > 0) {
+            const uint64_t bias = static_cast<uint64_t>(n >> 63) >> (64 - k);
+            q = static_cast<int64_t>(static_cast<uint64_t>(n) + bias) >> k;
+        }
+        return d < 0 ? static_cast<int64_t>(0 - static_cast<uint64_t>(q)) : q;
+    }
+
+    const SignedMagic magic = signed_magic(d);
+    auto hi = static_cast<int64_t>((static_cast<int128>(magic.multiplier) * n) >> 64);
+    if (d > 0 && magic.multiplier < 0) hi += n;
+    if (d < 0 && magic.multiplier > 0) hi -= n;
+    hi >>= magic.shift;
+    return hi + static_cast<int64_t>(static_cast<uint64_t>(hi) >> 63);
+}
+
+uint64_t unsigned_quotient(const uint64_t n, const uint64_t d) {
+    if ((d & (d - 1)) == 0) return n >> __builtin_ctzll(d);
+
+    const UnsignedMagic magic = unsigned_magic(d);
+    auto hi = static_cast<uint64_t>((static_cast<uint128>(magic.multiplier) * n) >> 64);
+    if (magic.add) {
+        hi += (n - hi) >> 1;
+        return hi >> (magic.shift - 1);
+    }
+    return hi >> magic.shift;
+}
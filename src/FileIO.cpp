@@ -0,0 +1,380 @@
+#include "FileIO.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+
+#if defined(__linux__)
+
+// the rings shared with the kernel, see io_uring_setup(2)
+struct FileIO::Ring {
+    int fd = -1;
+    void *sq = MAP_FAILED;
+    size_t sqSize = 0;
+    void *cq = MAP_FAILED;
+    size_t cqSize = 0;
+    io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+    size_t sqesSize = 0;
+
+    unsigned *sqTail = nullptr;
+    unsigned *sqMask = nullptr;
+    unsigned *sqArray = nullptr;
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    unsigned *cqMask = nullptr;
+    io_uring_cqe *cqes = nullptr;
+
+    ~Ring() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (cq != MAP_FAILED && cq != sq) munmap(cq, cqSize);
+        if (sq != MAP_FAILED) munmap(sq, sqSize);
+        if (fd >= 0) close(fd);
+    }
+};
+
+namespace {
+
+template<typename T>
+T *at(void *base, const uint32_t offset) {
+    return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+int io_uring_enter(const int fd, const unsigned submit, const unsigned complete, const unsigned flags) {
+    return static_cast<int>(syscall(SYS_io_uring_enter, fd, submit, complete, flags, nullptr, 0));
+}
+
+} // namespace
+
+// false when the kernel has no io_uring or does not allow it, e.g. in a container
+bool FileIO::startRing() {
+    io_uring_params params{};
+    const int fd = static_cast<int>(syscall(SYS_io_uring_setup, MAX_REQUESTS, &params));
+    if (fd < 0) return false;
+
+    auto *r = new Ring;
+    r->fd = fd;
+    r->sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    r->cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) {
+        r->sqSize = r->cqSize = std::max(r->sqSize, r->cqSize);
+    }
+    r->sq = mmap(nullptr, r->sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    r->cq = single
+                ? r->sq
+                : mmap(nullptr, r->cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    r->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    r->sqes = static_cast<io_uring_sqe *>(
+        mmap(nullptr, r->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (r->sq == MAP_FAILED || r->cq == MAP_FAILED || r->sqes == MAP_FAILED) {
+        delete r;
+        return false;
+    }
+
+    r->sqTail = at<unsigned>(r->sq, params.sq_off.tail);
+    r->sqMask = at<unsigned>(r->sq, params.sq_off.ring_mask);
+    r->sqArray = at<unsigned>(r->sq, params.sq_off.array);
+    r->cqHead = at<unsigned>(r->cq, params.cq_off.head);
+    r->cqTail = at<unsigned>(r->cq, params.cq_off.tail);
+    r->cqMask = at<unsigned>(r->cq, params.cq_off.ring_mask);
+    r->cqes = at<io_uring_cqe>(r->cq, params.cq_off.cqes);
+    ring = r;
+    return true;
+}
+
+// at most MAX_REQUESTS are ever in flight, so the submission queue always has room
+void FileIO::submit(const size_t slot) {
+    Request &request = requests[slot];
+    request.iov = {request.buffer, request.len};
+
+    const unsigned tail = *ring->sqTail;
+    const unsigned index = tail & *ring->sqMask;
+    io_uring_sqe &sqe = ring->sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READV;
+    sqe.fd = request.fd;
+    sqe.addr = reinterpret_cast<uint64_t>(&request.iov);
+    sqe.len = 1;
+    sqe.off = static_cast<uint64_t>(request.offset);
+    sqe.user_data = slot;
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    int submitted;
+    do {
+        submitted = io_uring_enter(ring->fd, 1, 0, 0);
+    } while (submitted < 0 && errno == EINTR);
+    if (submitted < 0) {
+        request.result = -errno;
+        request.done = true;
+    }
+}
+
+void FileIO::reap(const bool wait) {
+    while (true) {
+        unsigned head = *ring->cqHead;
+        const unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        if (head != tail) {
+            for (; head != tail; ++head) {
+                const io_uring_cqe &cqe = ring->cqes[head & *ring->cqMask];
+                Request &request = requests[cqe.user_data];
+                request.result = cqe.res;
+                request.done = true;
+            }
+            __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+            return;
+        }
+        if (!wait) return;
+        io_uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS);
+    }
+}
+
+#else
+
+struct FileIO::Ring {
+};
+
+bool FileIO::startRing() {
+    return false;
+}
+
+void FileIO::submit(size_t) {
+}
+
+void FileIO::reap(bool) {
+}
+
+#endif
+
+
+FileIO::~FileIO() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    submitted.notify_all();
+    for (auto &t: workers) {
+        t.join();
+    }
+    // closing the ring cancels anything still in flight
+    delete ring;
+    for (const auto &[fd, position]: positions) {
+        close(fd);
+    }
+}
+
+int64_t FileIO::openFile(const std::string &path, const int64_t fam, const bool create, int64_t &ior) {
+    int flags;
+    switch (fam) {
+        case READ_ONLY: flags = O_RDONLY; break;
+        case WRITE_ONLY: flags = O_WRONLY; break;
+        case READ_WRITE: flags = O_RDWR; break;
+        default:
+            ior = EINVAL;
+            return 0;
+    }
+    if (create) {
+        flags |= O_CREAT | O_TRUNC;
+    }
+    const int fd = open(path.c_str(), flags | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        ior = errno;
+        return 0;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    positions[fd] = 0;
+    ior = 0;
+    return fd;
+}
+
+int64_t FileIO::closeFile(const int64_t fileId) {
+    const int fd = static_cast<int>(fileId);
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        if (positions.erase(fd) == 0) return EBADF;
+
+        // a read no worker has started is dropped, its AWAIT gives -ECANCELED
+        for (auto it = queue.begin(); it != queue.end();) {
+            if (requests[*it].fd == fd) {
+                requests[*it].result = -ECANCELED;
+                requests[*it].done = true;
+                it = queue.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        // the rest are reading the file now, the descriptor must stay open until they finish
+        for (size_t slot = 0; slot < MAX_REQUESTS; ++slot) {
+            if (requests[slot].busy && requests[slot].fd == fd) {
+                waitFor(guard, slot);
+            }
+        }
+    }
+    return close(fd) == 0 ? 0 : errno;
+}
+
+int64_t FileIO::readFile(const int64_t fileId, void *buffer, const uint64_t len, int64_t &ior) {
+    const int fd = static_cast<int>(fileId);
+    off_t offset;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        const auto it = positions.find(fd);
+        if (it == positions.end()) {
+            ior = EBADF;
+            return 0;
+        }
+        offset = it->second;
+    }
+
+    ssize_t n;
+    do {
+        n = pread(fd, buffer, len, offset);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        ior = errno;
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    positions[fd] = offset + n;
+    ior = 0;
+    return n;
+}
+
+int64_t FileIO::writeFile(const int64_t fileId, const void *buffer, const uint64_t len) {
+    const int fd = static_cast<int>(fileId);
+    off_t offset;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        const auto it = positions.find(fd);
+        if (it == positions.end()) return EBADF;
+        offset = it->second;
+    }
+
+    const auto *p = static_cast<const char *>(buffer);
+    uint64_t left = len;
+    while (left > 0) {
+        const ssize_t n = pwrite(fd, p, left, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        p += n;
+        left -= static_cast<uint64_t>(n);
+        offset += n;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    positions[fd] = offset;
+    return 0;
+}
+
+int64_t FileIO::fileSize(const int64_t fileId, int64_t &ior) {
+    struct stat st{};
+    if (fstat(static_cast<int>(fileId), &st) != 0) {
+        ior = errno;
+        return 0;
+    }
+    ior = 0;
+    return st.st_size;
+}
+
+int64_t FileIO::readAsync(const int64_t fileId, void *buffer, const uint64_t len) {
+    const int fd = static_cast<int>(fileId);
+    size_t slot = 0;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        const auto it = positions.find(fd);
+        if (it == positions.end()) return 0;
+
+        while (slot < MAX_REQUESTS && requests[slot].busy) ++slot;
+        if (slot == MAX_REQUESTS) return 0;
+
+        if (!ringTried) {
+            ringTried = true;
+            startRing();
+        }
+
+        // the read owns the next len bytes, the following read starts after them
+        requests[slot] = Request{fd, buffer, len, it->second, 0, true, false};
+        it->second += static_cast<off_t>(len);
+        if (ring) {
+            submit(slot);
+            return static_cast<int64_t>(slot) + 1;
+        }
+        queue.push_back(slot);
+    }
+    if (workers.empty()) {
+        startWorkers();
+    }
+    submitted.notify_one();
+    return static_cast<int64_t>(slot) + 1;
+}
+
+void FileIO::waitFor(std::unique_lock<std::mutex> &guard, const size_t slot) {
+    const Request &r = requests[slot];
+    if (ring) {
+        while (!r.done) {
+            reap(true);
+        }
+    } else {
+        completed.wait(guard, [&r] { return r.done; });
+    }
+}
+
+int64_t FileIO::await(const int64_t request) {
+    if (request < 1 || request > static_cast<int64_t>(MAX_REQUESTS)) return -EINVAL;
+    auto &r = requests[request - 1];
+
+    std::unique_lock<std::mutex> guard(lock);
+    if (!r.busy) return -EINVAL;
+    waitFor(guard, static_cast<size_t>(request - 1));
+    r.busy = false;
+
+    if (r.result > 0 && static_cast<uint64_t>(r.result) < r.len) {
+        // a short read at the end of the file, later reads start from the real end
+        const auto it = positions.find(r.fd);
+        if (it != positions.end() && it->second == r.offset + static_cast<off_t>(r.len)) {
+            it->second = r.offset + r.result;
+        }
+    }
+    return r.result;
+}
+
+void FileIO::startWorkers() {
+    for (size_t i = 0; i < WORKERS; ++i) {
+        workers.emplace_back(&FileIO::worker, this);
+    }
+}
+
+void FileIO::worker() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        submitted.wait(guard, [this] { return stopping || !queue.empty(); });
+        if (stopping) return;
+
+        const size_t slot = queue.front();
+        queue.pop_front();
+        const Request r = requests[slot];
+        guard.unlock();
+
+        ssize_t n;
+        do {
+            n = pread(r.fd, r.buffer, r.len, r.offset);
+        } while (n < 0 && errno == EINTR);
+        const int64_t result = n < 0 ? -errno : n;
+
+        guard.lock();
+        requests[slot].result = result;
+        requests[slot].done = true;
+        completed.notify_all();
+    }
+}
@@ -0,0 +1,342 @@
+#include "FloatFormat.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Grisu2, after Florian Loitsch "Printing Floating-Point Numbers Quickly and
+// Accurately with Integers". The result always reads back as the same double
+// and is the shortest such string in all but a tiny number of cases.
+
+namespace {
+
+struct DiyFp {
+    uint64_t f;
+    int e;
+};
+
+constexpr uint64_t HIDDEN_BIT = 0x0010000000000000ULL;
+constexpr uint64_t SIGNIFICAND_MASK = 0x000FFFFFFFFFFFFFULL;
+constexpr uint64_t EXPONENT_MASK = 0x7FF0000000000000ULL;
+
+// normalized 10^k for k = -348, -340 ... 340
+constexpr DiyFp CACHED_POWERS[] = {
+    {0xfa8fd5a0081c0288ULL, -1220}, // 1e-348
+    {0xbaaee17fa23ebf76ULL, -1193}, // 1e-340
+    {0x8b16fb203055ac76ULL, -1166}, // 1e-332
+    {0xcf42894a5dce35eaULL, -1140}, // 1e-324
+    {0x9a6bb0aa55653b2dULL, -1113}, // 1e-316
+    {0xe61acf033d1a45dfULL, -1087}, // 1e-308
+    {0xab70fe17c79ac6caULL, -1060}, // 1e-300
+    {0xff77b1fcbebcdc4fULL, -1034}, // 1e-292
+    {0xbe5691ef416bd60cULL, -1007}, // 1e-284
+    {0x8dd01fad907ffc3cULL, -980}, // 1e-276
+    {0xd3515c2831559a83ULL, -954}, // 1e-268
+    {0x9d71ac8fada6c9b5ULL, -927}, // 1e-260
+    {0xea9c227723ee8bcbULL, -901}, // 1e-252
+    {0xaecc49914078536dULL, -874}, // 1e-244
+    {0x823c12795db6ce57ULL, -847}, // 1e-236
+    {0xc21094364dfb5637ULL, -821}, // 1e-228
+    {0x9096ea6f3848984fULL, -794}, // 1e-220
+    {0xd77485cb25823ac7ULL, -768}, // 1e-212
+    {0xa086cfcd97bf97f4ULL, -741}, // 1e-204
+    {0xef340a98172aace5ULL, -715}, // 1e-196
+    {0xb23867fb2a35b28eULL, -688}, // 1e-188
+    {0x84c8d4dfd2c63f3bULL, -661}, // 1e-180
+    {0xc5dd44271ad3cdbaULL, -635}, // 1e-172
+    {0x936b9fcebb25c996ULL, -608}, // 1e-164
+    {0xdbac6c247d62a584ULL, -582}, // 1e-156
+    {0xa3ab66580d5fdaf6ULL, -555}, // 1e-148
+    {0xf3e2f893dec3f126ULL, -529}, // 1e-140
+    {0xb5b5ada8aaff80b8ULL, -502}, // 1e-132
+    {0x87625f056c7c4a8bULL, -475}, // 1e-124
+    {0xc9bcff6034c13053ULL, -449}, // 1e-116
+    {0x964e858c91ba2655ULL, -422}, // 1e-108
+    {0xdff9772470297ebdULL, -396}, // 1e-100
+    {0xa6dfbd9fb8e5b88fULL, -369}, // 1e-92
+    {0xf8a95fcf88747d94ULL, -343}, // 1e-84
+    {0xb94470938fa89bcfULL, -316}, // 1e-76
+    {0x8a08f0f8bf0f156bULL, -289}, // 1e-68
+    {0xcdb02555653131b6ULL, -263}, // 1e-60
+    {0x993fe2c6d07b7facULL, -236}, // 1e-52
+    {0xe45c10c42a2b3b06ULL, -210}, // 1e-44
+    {0xaa242499697392d3ULL, -183}, // 1e-36
+    {0xfd87b5f28300ca0eULL, -157}, // 1e-28
+    {0xbce5086492111aebULL, -130}, // 1e-20
+    {0x8cbccc096f5088ccULL, -103}, // 1e-12
+    {0xd1b71758e219652cULL, -77}, // 1e-4
+    {0x9c40000000000000ULL, -50}, // 1e4
+    {0xe8d4a51000000000ULL, -24}, // 1e12
+    {0xad78ebc5ac620000ULL, 3}, // 1e20
+    {0x813f3978f8940984ULL, 30}, // 1e28
+    {0xc097ce7bc90715b3ULL, 56}, // 1e36
+    {0x8f7e32ce7bea5c70ULL, 83}, // 1e44
+    {0xd5d238a4abe98068ULL, 109}, // 1e52
+    {0x9f4f2726179a2245ULL, 136}, // 1e60
+    {0xed63a231d4c4fb27ULL, 162}, // 1e68
+    {0xb0de65388cc8ada8ULL, 189}, // 1e76
+    {0x83c7088e1aab65dbULL, 216}, // 1e84
+    {0xc45d1df942711d9aULL, 242}, // 1e92
+    {0x924d692ca61be758ULL, 269}, // 1e100
+    {0xda01ee641a708deaULL, 295}, // 1e108
+    {0xa26da3999aef774aULL, 322}, // 1e116
+    {0xf209787bb47d6b85ULL, 348}, // 1e124
+    {0xb454e4a179dd1877ULL, 375}, // 1e132
+    {0x865b86925b9bc5c2ULL, 402}, // 1e140
+    {0xc83553c5c8965d3dULL, 428}, // 1e148
+    {0x952ab45cfa97a0b3ULL, 455}, // 1e156
+    {0xde469fbd99a05fe3ULL, 481}, // 1e164
+    {0xa59bc234db398c25ULL, 508}, // 1e172
+    {0xf6c69a72a3989f5cULL, 534}, // 1e180
+    {0xb7dcbf5354e9beceULL, 561}, // 1e188
+    {0x88fcf317f22241e2ULL, 588}, // 1e196
+    {0xcc20ce9bd35c78a5ULL, 614}, // 1e204
+    {0x98165af37b2153dfULL, 641}, // 1e212
+    {0xe2a0b5dc971f303aULL, 667}, // 1e220
+    {0xa8d9d1535ce3b396ULL, 694}, // 1e228
+    {0xfb9b7cd9a4a7443cULL, 720}, // 1e236
+    {0xbb764c4ca7a44410ULL, 747}, // 1e244
+    {0x8bab8eefb6409c1aULL, 774}, // 1e252
+    {0xd01fef10a657842cULL, 800}, // 1e260
+    {0x9b10a4e5e9913129ULL, 827}, // 1e268
+    {0xe7109bfba19c0c9dULL, 853}, // 1e276
+    {0xac2820d9623bf429ULL, 880}, // 1e284
+    {0x80444b5e7aa7cf85ULL, 907}, // 1e292
+    {0xbf21e44003acdd2dULL, 933}, // 1e300
+    {0x8e679c2f5e44ff8fULL, 960}, // 1e308
+    {0xd433179d9c8cb841ULL, 986}, // 1e316
+    {0x9e19db92b4e31ba9ULL, 1013}, // 1e324
+    {0xeb96bf6ebadf77d9ULL, 1039}, // 1e332
+    {0xaf87023b9bf0ee6bULL, 1066}, // 1e340
+};
+
+constexpr uint32_t POW10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+DiyFp multiply(const DiyFp &x, const DiyFp &y) {
+    constexpr uint64_t M32 = 0xFFFFFFFFULL;
+    const uint64_t a = x.f >> 32, b = x.f & M32;
+    const uint64_t c = y.f >> 32, d = y.f & M32;
+    const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+    tmp += 1ULL << 31; // round
+    return {ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64};
+}
+
+DiyFp normalize(DiyFp v) {
+    const int shift = __builtin_clzll(v.f);
+    return {v.f << shift, v.e - shift};
+}
+
+DiyFp from_double(const double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const int biased = static_cast<int>((bits & EXPONENT_MASK) >> 52);
+    const uint64_t significand = bits & SIGNIFICAND_MASK;
+    if (biased != 0) {
+        return {significand + HIDDEN_BIT, biased - 1075};
+    }
+    return {significand, -1074};
+}
+
+// the neighbours half way to the next doubles either side
+void boundaries(const DiyFp &v, DiyFp &minus, DiyFp &plus) {
+    plus = normalize({(v.f << 1) + 1, v.e - 1});
+    minus = (v.f == HIDDEN_BIT) ? DiyFp{(v.f << 2) - 1, v.e - 2} : DiyFp{(v.f << 1) - 1, v.e - 1};
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+}
+
+DiyFp cached_power(const int e, int &k) {
+    const double dk = (-61 - e) * 0.30102999566398114 + 347; // 1/log2(10)
+    int ik = static_cast<int>(dk);
+    if (dk - ik > 0.0) ++ik;
+    const unsigned index = static_cast<unsigned>((ik >> 3) + 1);
+    k = -(-348 + static_cast<int>(index) * 8);
+    return CACHED_POWERS[index];
+}
+
+int count_digits(const uint32_t n) {
+    int digits = 1;
+    while (digits < 10 && n >= POW10[digits]) ++digits;
+    return digits;
+}
+
+// move the last digit towards w while it stays inside the boundaries
+void round_weed(char *buffer, const int len, const uint64_t delta, uint64_t rest,
+                const uint64_t ten_kappa, const uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buffer[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+int generate_digits(const DiyFp &w, const DiyFp &mp, uint64_t delta, char *buffer, int &k) {
+    const DiyFp one{1ULL << -mp.e, mp.e};
+    const uint64_t wp_w = mp.f - w.f;
+    auto p1 = static_cast<uint32_t>(mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+    int kappa = count_digits(p1);
+    int len = 0;
+
+    while (kappa > 0) {
+        const uint32_t d = p1 / POW10[kappa - 1];
+        p1 %= POW10[kappa - 1];
+        if (d || len) buffer[len++] = static_cast<char>('0' + d);
+        kappa--;
+        const uint64_t rest = (static_cast<uint64_t>(p1) << -one.e) + p2;
+        if (rest <= delta) {
+            k += kappa;
+            round_weed(buffer, len, delta, rest, static_cast<uint64_t>(POW10[kappa]) << -one.e, wp_w);
+            return len;
+        }
+    }
+
+    while (true) {
+        p2 *= 10;
+        delta *= 10;
+        const auto d = static_cast<char>(p2 >> -one.e);
+        if (d || len) buffer[len++] = static_cast<char>('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            k += kappa;
+            const int index = -kappa;
+            round_weed(buffer, len, delta, p2, one.f, wp_w * (index < 10 ? POW10[index] : 0));
+            return len;
+        }
+    }
+}
+
+// precision significant digits of value rounded once from its exact binary value, returns the digit count.
+// Rounding the shortest digits instead would round twice, 2.675 is really 2.67499.. and must give 2.67.
+int precise_digits(const double value, const int precision, char *digits, int &exponent) {
+    char text[FLOAT_TEXT_MAX];
+    std::snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+    int len = 0;
+    const char *p = text;
+    for (; *p && *p != 'e'; ++p) {
+        if (*p != '.') digits[len++] = *p;
+    }
+    exponent = std::atoi(p + 1) - (len - 1);
+    while (len > 1 && digits[len - 1] == '0') {
+        len--;
+        exponent++;
+    }
+    return len;
+}
+
+char *write_exponent(char *p, int e) {
+    *p++ = 'E';
+    if (e < 0) {
+        *p++ = '-';
+        e = -e;
+    }
+    if (e >= 100) {
+        *p++ = static_cast<char>('0' + e / 100);
+        e %= 100;
+        *p++ = static_cast<char>('0' + e / 10);
+    } else if (e >= 10) {
+        *p++ = static_cast<char>('0' + e / 10);
+    }
+    *p++ = static_cast<char>('0' + e % 10);
+    return p;
+}
+
+// digits with the point after the first 'before' of them, padding with zeros
+char *write_mantissa(char *p, const char *digits, const int len, const int before) {
+    for (int i = 0; i < before; i++) {
+        *p++ = i < len ? digits[i] : '0';
+    }
+    if (len > before) {
+        *p++ = '.';
+        std::memcpy(p, digits + before, static_cast<size_t>(len - before));
+        p += len - before;
+    }
+    return p;
+}
+
+} // namespace
+
+
+int float_shortest_digits(const double value, char *digits, int &exponent) {
+    const DiyFp v = from_double(value);
+    DiyFp minus{}, plus{};
+    boundaries(v, minus, plus);
+
+    int mk = 0;
+    const DiyFp c_mk = cached_power(plus.e, mk);
+    const DiyFp w = multiply(normalize(v), c_mk);
+    DiyFp wp = multiply(plus, c_mk);
+    DiyFp wm = multiply(minus, c_mk);
+    wm.f++;
+    wp.f--;
+
+    exponent = mk;
+    return generate_digits(w, wp, wp.f - wm.f, digits, exponent);
+}
+
+size_t format_float(const double value, const FloatStyle style, const int precision, char *out) {
+    char *p = out;
+
+    if (std::isnan(value)) {
+        std::memcpy(p, "NaN", 3);
+        return 3;
+    }
+    if (std::signbit(value)) {
+        *p++ = '-';
+    }
+    if (std::isinf(value)) {
+        std::memcpy(p, "Inf", 3);
+        return static_cast<size_t>(p - out) + 3;
+    }
+    if (value == 0.0) {
+        *p++ = '0';
+        return static_cast<size_t>(p - out);
+    }
+
+    char digits[20];
+    int exponent = 0;
+    int len = float_shortest_digits(std::fabs(value), digits, exponent);
+    if (precision > 0 && len > precision) {
+        len = precise_digits(std::fabs(value), precision, digits, exponent);
+    }
+
+    // decimal exponent of the first digit
+    const int e10 = len + exponent - 1;
+
+    switch (style) {
+        case FloatStyle::GENERAL:
+            if (e10 >= 0 && e10 < 21) {
+                // 1234.5 or 1500
+                p = write_mantissa(p, digits, len, e10 + 1);
+            } else if (e10 < 0 && e10 >= -7) {
+                // 0.00125
+                *p++ = '0';
+                *p++ = '.';
+                for (int i = -1; i > e10; i--) *p++ = '0';
+                std::memcpy(p, digits, static_cast<size_t>(len));
+                p += len;
+            } else {
+                p = write_mantissa(p, digits, len, 1);
+                p = write_exponent(p, e10);
+            }
+            break;
+
+        case FloatStyle::SCIENTIFIC:
+            p = write_mantissa(p, digits, len, 1);
+            p = write_exponent(p, e10);
+            break;
+
+        case FloatStyle::ENGINEERING: {
+            const int eng = (e10 >= 0 ? e10 / 3 : -((-e10 + 2) / 3)) * 3;
+            p = write_mantissa(p, digits, len, e10 - eng + 1);
+            p = write_exponent(p, eng);
+            break;
+        }
+    }
+    return static_cast<size_t>(p - out);
+}
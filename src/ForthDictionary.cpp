@@ -8,6 +8,8 @@
 #include "Quit.h"
 #include "SymbolTable.h"
 #include "Tokenizer.h"
+#include "DeferredWords.h"
+#include "Tiering.h"
 #include "SignalHandler.h"
 #include <map>
 
@@ -169,19 +171,20 @@ ForthDictionaryEntry *ForthDictionary::findWord(const char *name) const {
     if (!name) {
         throw std::invalid_argument("Name cannot be null!");
     }
+    return findWord(std::string_view(name));
+}
 
-    // uppercase the name
-    std::string nameStr(name);
-    std::transform(nameStr.begin(), nameStr.end(), nameStr.begin(), ::toupper);
-    name = nameStr.c_str();
-
-
-    size_t length = std::strlen(name);
+ForthDictionaryEntry *ForthDictionary::findWord(const std::string_view name) const {
+    size_t length = name.size();
     if (length >= MAX_WORD_LENGTH) {
         return nullptr; // Word is too long, invalid
     }
 
-    auto word_id = SymbolTable::instance().addSymbol(name);
+    // uppercase the name
+    char upper[MAX_WORD_LENGTH];
+    std::transform(name.begin(), name.end(), upper, ::toupper);
+
+    auto word_id = SymbolTable::instance().addSymbol(std::string_view(upper, length));
 
     // Create a set of vocab IDs prioritized by search order
     std::unordered_set<size_t> vocabSet;
@@ -206,22 +209,17 @@ ForthDictionaryEntry *ForthDictionary::findWord(const char *name) const {
 }
 
 
-bool ForthDictionary::isVariable(const char *name) const {
-    if (!name) {
-        throw std::invalid_argument("Name cannot be null!");
-    }
-
-    // uppercase the name
-    std::string nameStr(name);
-    std::transform(nameStr.begin(), nameStr.end(), nameStr.begin(), ::toupper);
-    name = nameStr.c_str();
-
-    size_t length = std::strlen(name);
+bool ForthDictionary::isVariable(const std::string_view name) const {
+    size_t length = name.size();
     if (length >= MAX_WORD_LENGTH) {
         return false; // Word is too long, invalid
     }
 
-    auto word_id = SymbolTable::instance().findSymbol(name);
+    // uppercase the name
+    char upper[MAX_WORD_LENGTH];
+    std::transform(name.begin(), name.end(), upper, ::toupper);
+
+    auto word_id = SymbolTable::instance().findSymbol(std::string_view(upper, length));
     if (word_id == 0) return false;
 
     // Create a set of vocab IDs prioritized by search order
@@ -264,7 +262,8 @@ void ForthDictionary::execWord(const char *name) {
 
 
 ForthDictionaryEntry *ForthDictionary::findWordByToken(const ForthToken &word) const {
-    if (word.word_len >= MAX_WORD_LENGTH) {
+    const size_t word_len = word.value.size();
+    if (word_len >= MAX_WORD_LENGTH) {
         return nullptr; // Word length is invalid
     }
 
@@ -277,7 +276,7 @@ ForthDictionaryEntry *ForthDictionary::findWordByToken(const ForthToken &word) c
     }
 
     // Traverse the linked list for the given word length
-    ForthDictionaryEntry *current = dictionaryLists[word.word_len];
+    ForthDictionaryEntry *current = dictionaryLists[word_len];
     while (current) {
         // Check for both vocab ID and word ID match
         if (vocabSet.count(current->vocab_id) > 0 && current->word_id == word.word_id) {
@@ -433,7 +432,7 @@ void ForthDictionary::setSearchOrder(const std::vector<std::string> &order) {
     searchOrder.clear();
     for (const auto &vocabName: order) {
         if (!findVocab(vocabName.c_str())) {
-            printf("Vocabulary %s does not exist. Creating it...\n", vocabName.c_str());
+            std::cout << "Vocabulary " << vocabName << " does not exist. Creating it..." << std::endl;
             createVocabulary(vocabName);
         }
         ForthDictionaryEntry *vocab = findVocab(vocabName.c_str());
@@ -574,18 +573,24 @@ void ForthDictionary::forgetLastWord() {
 
     const size_t length = latestWordName.size();
 
+    // a deferred word's executable is its action, code that belongs to another word
+    if (DeferredWords::instance().forget(wordToForget)) {
+        wordToForget->executable = nullptr;
+    }
+    // a tiered word has tier 0 code as well as the tier 1 code in executable, both are released here
+    Tiering::instance().forget(wordToForget);
+
     if (wordToForget->executable) {
         // free asmjit memory
-        if (const auto runtime = &JitContext::instance()._rt) {
-            runtime->release(wordToForget->executable);
-            wordToForget->executable = nullptr;
-            runtime->release(wordToForget->immediate_interpreter);
-            wordToForget->immediate_interpreter = nullptr;
-            runtime->release(wordToForget->generator);
-            wordToForget->generator = nullptr;
-            runtime->release(wordToForget->immediate_compiler);
-            wordToForget->immediate_compiler = nullptr;
-        }
+        auto &jit = JitContext::instance();
+        jit.release(wordToForget->executable);
+        wordToForget->executable = nullptr;
+        jit.release(wordToForget->immediate_interpreter);
+        wordToForget->immediate_interpreter = nullptr;
+        jit.release(wordToForget->generator);
+        wordToForget->generator = nullptr;
+        jit.release(wordToForget->immediate_compiler);
+        wordToForget->immediate_compiler = nullptr;
     }
 
 
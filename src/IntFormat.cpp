@@ -0,0 +1,142 @@
+#include "IntFormat.h"
+#include <cstring>
+
+namespace {
+
+__extension__ typedef unsigned __int128 uint128;
+
+constexpr char DIGITS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+constexpr char DIGIT_PAIRS[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+constexpr uint64_t POW10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+constexpr uint64_t TEN_19 = 10000000000000000000ULL;
+
+bool power_of_two(const unsigned base) {
+    return (base & (base - 1)) == 0;
+}
+
+unsigned clamp_base(const unsigned base) {
+    return (base < 2 || base > 36) ? 10 : base;
+}
+
+} // namespace
+
+
+int unsigned_length(const uint64_t n, unsigned base) {
+    base = clamp_base(base);
+    if (base == 10) {
+        int len = 1;
+        while (len < 20 && n >= POW10[len]) ++len;
+        return len;
+    }
+    if (power_of_two(base)) {
+        const int shift = __builtin_ctz(base);
+        const int bits = n ? 64 - __builtin_clzll(n) : 1;
+        return (bits + shift - 1) / shift;
+    }
+    int len = 1;
+    for (uint64_t v = n / base; v; v /= base) ++len;
+    return len;
+}
+
+char *write_unsigned_back(uint64_t n, unsigned base, char *end) {
+    base = clamp_base(base);
+    char *p = end;
+    if (base == 10) {
+        while (n >= 100) {
+            const unsigned pair = static_cast<unsigned>(n % 100) * 2;
+            n /= 100;
+            *--p = DIGIT_PAIRS[pair + 1];
+            *--p = DIGIT_PAIRS[pair];
+        }
+        if (n >= 10) {
+            const unsigned pair = static_cast<unsigned>(n) * 2;
+            *--p = DIGIT_PAIRS[pair + 1];
+            *--p = DIGIT_PAIRS[pair];
+        } else {
+            *--p = static_cast<char>('0' + n);
+        }
+        return p;
+    }
+    if (power_of_two(base)) {
+        const int shift = __builtin_ctz(base);
+        const uint64_t mask = base - 1;
+        do {
+            *--p = DIGITS[n & mask];
+            n >>= shift;
+        } while (n);
+        return p;
+    }
+    do {
+        *--p = DIGITS[n % base];
+        n /= base;
+    } while (n);
+    return p;
+}
+
+char *write_unsigned_double_back(const uint64_t lo, const uint64_t hi, unsigned base, char *end) {
+    base = clamp_base(base);
+    if (hi == 0) {
+        return write_unsigned_back(lo, base, end);
+    }
+    uint128 n = (static_cast<uint128>(hi) << 64) | lo;
+    char *p = end;
+    if (base == 10) {
+        // 19 digits at a time, all but the leading group padded with zeros
+        while (n >> 64) {
+            const auto chunk = static_cast<uint64_t>(n % TEN_19);
+            n /= TEN_19;
+            char *start = write_unsigned_back(chunk, 10, p);
+            while (p - start < 19) *--start = '0';
+            p = start;
+        }
+        return write_unsigned_back(static_cast<uint64_t>(n), 10, p);
+    }
+    do {
+        *--p = DIGITS[static_cast<unsigned>(n % base)];
+        n /= base;
+    } while (n);
+    return p;
+}
+
+size_t format_unsigned(const uint64_t n, const unsigned base, char *out) {
+    const int len = unsigned_length(n, base);
+    write_unsigned_back(n, base, out + len);
+    return static_cast<size_t>(len);
+}
+
+size_t format_signed(const int64_t n, const unsigned base, char *out) {
+    if (n < 0) {
+        *out = '-';
+        return 1 + format_unsigned(0 - static_cast<uint64_t>(n), base, out + 1);
+    }
+    return format_unsigned(static_cast<uint64_t>(n), base, out);
+}
+
+size_t format_double(uint64_t lo, int64_t hi, const unsigned base, char *out) {
+    const bool negative = hi < 0;
+    if (negative) {
+        // two's complement negate of the 128 bit value
+        lo = ~lo + 1;
+        hi = static_cast<int64_t>(~static_cast<uint64_t>(hi) + (lo == 0 ? 1 : 0));
+    }
+    char text[INT_TEXT_MAX];
+    char *end = text + sizeof(text);
+    const char *start = write_unsigned_double_back(lo, static_cast<uint64_t>(hi), base, end);
+    size_t len = 0;
+    if (negative) out[len++] = '-';
+    std::memcpy(out + len, start, static_cast<size_t>(end - start));
+    return len + static_cast<size_t>(end - start);
+}
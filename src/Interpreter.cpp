@@ -3,10 +3,11 @@
 #include "ForthDictionary.h"
 #include "CodeGenerator.h"
 #include "Compiler.h"
-#include <deque>
 #include <iostream>
 
 #include "SignalHandler.h"
+#include "CompileStats.h"
+#include "Timing.h"
 
 // Helper: Raise error with additional message
 void Interpreter::raise_error(int code, const std::string &message) {
@@ -15,7 +16,7 @@ void Interpreter::raise_error(int code, const std::string &message) {
 }
 
 // Helper: Handle comments
-void Interpreter::handle_comment(ForthToken &first, std::deque<ForthToken> &tokens) {
+void Interpreter::handle_comment(ForthToken &first, TokenStream &tokens) {
     while (first.type != TokenType::TOKEN_ENDCOMMENT) {
         tokens.pop_front(); // Remove current token
         if (tokens.empty()) {
@@ -28,18 +29,18 @@ void Interpreter::handle_comment(ForthToken &first, std::deque<ForthToken> &toke
 }
 
 // Helper: Handle TOKEN_WORD logic
-void Interpreter::handle_word(std::deque<ForthToken> &tokens) {
+void Interpreter::handle_word(TokenStream &tokens) {
     if (tokens.empty())
         return;
 
     const ForthDictionary &dict = ForthDictionary::instance();
-    const ForthToken &first = tokens.front();
+    const ForthToken first = tokens.front();
     tokens.pop_front(); // Efficiently remove the first token
 
     if (first.type == TokenType::TOKEN_WORD || first.type == TokenType::TOKEN_VARIABLE) {
         auto word_found = dict.findWordByToken(first);
         if (word_found == nullptr) {
-            raise_error(5, "Word not found: " + first.value);
+            raise_error(5, "Word not found: " + std::string(first.value));
             return;
         }
 
@@ -52,18 +53,25 @@ void Interpreter::handle_word(std::deque<ForthToken> &tokens) {
 }
 
 // Helper: Handle TOKEN_COMPILING
-void Interpreter::handle_compiling(std::deque<ForthToken> &tokens) {
+void Interpreter::handle_compiling(TokenStream &tokens) {
     Compiler::instance().compile_words(tokens);
 }
 
 // Helper: Handle TOKEN_NUMBER
-void Interpreter::handle_number(const ForthToken &first, std::deque<ForthToken> &tokens) {
+void Interpreter::handle_number(const ForthToken &first, TokenStream &tokens) {
     cpush(first.int_value); // Push the integer to the stack
     tokens.pop_front(); // Remove the processed token
 }
 
+// Helper: Handle TOKEN_DOUBLE, the high cell holds the sign
+void Interpreter::handle_double(const ForthToken &first, TokenStream &tokens) {
+    cpush(first.int_value);
+    cpush(static_cast<int64_t>(first.int_value) < 0 ? -1 : 0);
+    tokens.pop_front(); // Remove the processed token
+}
+
 // Helper: Handle TOKEN_FLOAT
-void Interpreter::handle_float(const ForthToken &first, std::deque<ForthToken> &tokens) {
+void Interpreter::handle_float(const ForthToken &first, TokenStream &tokens) {
     cfpush(first.float_value); // Push the float to the stack
     tokens.pop_front(); // Remove the processed token
 }
@@ -82,14 +90,34 @@ void Interpreter::execute(const std::string &input) {
     }
 
 
-    std::deque<ForthToken> tokens;
+    // INCLUDE runs files from inside execute, so each level has its own stream
+    if (depth == streams.size()) {
+        streams.emplace_back();
+    }
+    TokenStream &tokens = streams[depth];
+    const size_t level = depth++;
 
     // Tokenize the input into Forth tokens
+    const uint64_t started = clock_ns();
     Tokenizer::instance().tokenize_forth(input, tokens);
+    CompilerStats::instance().tokenized(clock_ns() - started);
 
     while (!tokens.empty()) {
         ForthToken &first = tokens.front();
 
+        // numbers after HEX or DECIMAL on the same line are read in the new BASE
+        switch (first.type) {
+            case TokenType::TOKEN_NUMBER:
+            case TokenType::TOKEN_DOUBLE:
+            case TokenType::TOKEN_FLOAT:
+            case TokenType::TOKEN_UNKNOWN:
+            case TokenType::TOKEN_COMPILING:
+                Tokenizer::instance().rebase(tokens);
+                break;
+            default:
+                break;
+        }
+
         // Use a switch structure for token processing
         switch (first.type) {
             case TokenType::TOKEN_BEGINCOMMENT:
@@ -109,12 +137,17 @@ void Interpreter::execute(const std::string &input) {
                 handle_number(first, tokens);
                 break;
 
+            case TokenType::TOKEN_DOUBLE:
+                handle_double(first, tokens);
+                break;
+
             case TokenType::TOKEN_FLOAT:
                 handle_float(first, tokens);
                 break;
 
             case TokenType::TOKEN_END:
                 tokens.pop_front(); // Remove TOKEN_END and exit
+                depth = level;
                 return;
 
             default:
@@ -123,4 +156,9 @@ void Interpreter::execute(const std::string &input) {
                 break;
         }
     }
+    depth = level;
+}
+
+void Interpreter::reset() {
+    depth = 0;
 }
@@ -1,6 +1,7 @@
 #include "Optimizer.h"
+#include <algorithm>
+#include <cctype>
 #include <cstdint>
-#include <deque>
 #include <SignalHandler.h>
 #include <stdexcept>
 #include <string>
@@ -10,8 +11,26 @@
 
 int optimizations;
 
-int Optimizer::optimize(const std::deque<ForthToken> &tokens,
-                        std::deque<ForthToken> &optimized_tokens) {
+// words are found whatever their case
+static bool same_word(const std::string_view a, const std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const char x, const char y) {
+        return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y));
+    });
+}
+
+// division words with a by-constant form, the number before them is the divisor
+static OptOp division_op(const std::string_view op) {
+    if (same_word(op, "MOD")) return OptOp::MOD_IMM;
+    if (op == "/MOD") return OptOp::DIVMOD_IMM;
+    if (same_word(op, "U/")) return OptOp::UDIV_IMM;
+    if (same_word(op, "UMOD")) return OptOp::UMOD_IMM;
+    if (op == "*/") return OptOp::SCALE_IMM;
+    return OptOp::NONE;
+}
+
+
+int Optimizer::optimize(const TokenStream &tokens,
+                        TokenStream &optimized_tokens) {
     optimized_tokens.clear(); // Clear the output deque before optimization
     optimizations = 0;
     for (size_t i = 0; i < tokens.size(); ++i) {
@@ -55,52 +74,51 @@ int Optimizer::optimize(const std::deque<ForthToken> &tokens,
 
 // PRIVATE UTILITY FUNCTIONS
 
-bool Optimizer::is_arithmetic_operator(const std::string &op) {
-    return (op == "+" || op == "-" || op == "*" || op == "/");
+bool Optimizer::is_arithmetic_operator(const std::string_view op) {
+    return (op == "+" || op == "-" || op == "*" || op == "/" || division_op(op) != OptOp::NONE);
 }
 
-bool Optimizer::is_comparison_operator(const std::string &op) {
+bool Optimizer::is_comparison_operator(const std::string_view op) {
     return (op == "<" || op == ">" || op == "=");
 }
 
-bool Optimizer::optimize_constant_operation(const std::deque<ForthToken> &tokens,
-                                            std::deque<ForthToken> &optimized_tokens, size_t index) {
+bool Optimizer::optimize_constant_operation(const TokenStream &tokens,
+                                            TokenStream &optimized_tokens, size_t index) {
     const ForthToken &number = tokens[index];
     const ForthToken &op = tokens[index + 1];
 
-    ForthToken temp;
-    temp.type = TOKEN_OPTIMIZED;
-    temp.int_value = number.int_value;
+    ForthToken temp(OptOp::NONE, number.int_value);
 
     if (op.value == "+" || op.value == "-") {
-        temp.optimized_op = (op.value == "+") ? "ADD_IMM" : "SUB_IMM";
+        temp.op = (op.value == "+") ? OptOp::ADD_IMM : OptOp::SUB_IMM;
     } else if (op.value == "*") {
         if (number.int_value == 1) return false; // Skip multiplication by 1
         if (is_power_of_two(number.int_value)) {
-            temp.optimized_op = "SHL_IMM"; // Optimized for power of 2
-            temp.int_value = __builtin_ctz(number.int_value); // Number of trailing zeroes (log2)
+            temp.op = OptOp::SHL_IMM; // Optimized for power of 2
+            temp.int_value = __builtin_ctzll(number.int_value); // Number of trailing zeroes (log2)
         } else {
-            temp.optimized_op = "MUL_IMM";
+            temp.op = OptOp::MUL_IMM;
         }
     } else if (op.value == "/") {
         if (number.int_value == 0) throw std::runtime_error("Division by zero detected!");
         if (number.int_value == 1) return false; // Skip division by 1
         if (is_power_of_two(number.int_value)) {
-            temp.optimized_op = "SHR_IMM"; // Optimized for power of 2
-            temp.int_value = __builtin_ctz(number.int_value);
+            temp.op = OptOp::SHR_IMM; // Optimized for power of 2
+            temp.int_value = __builtin_ctzll(number.int_value);
         } else {
-            temp.optimized_op = "DIV_IMM";
+            temp.op = OptOp::DIV_IMM;
         }
-
+    } else {
+        if (number.int_value == 0) return false; // left to trap at run time
+        temp.op = division_op(op.value);
     }
     optimizations++;
-    set_common_fields(temp);
-    optimized_tokens.emplace_back(temp);
+    optimized_tokens.push_back(temp);
     return true;
 }
 
-bool Optimizer::optimize_literal_comparison(const std::deque<ForthToken> &tokens,
-                                            std::deque<ForthToken> &optimized_tokens, size_t index) {
+bool Optimizer::optimize_literal_comparison(const TokenStream &tokens,
+                                            TokenStream &optimized_tokens, size_t index) {
     if (index + 1 >= tokens.size()) {
         std::cerr << ("Insufficient tokens for literal comparison optimization");
         SignalHandler::instance().raise(5);
@@ -114,22 +132,19 @@ bool Optimizer::optimize_literal_comparison(const std::deque<ForthToken> &tokens
         SignalHandler::instance().raise(5);
     }
 
-    ForthToken temp;
-    temp.type = TOKEN_OPTIMIZED; // Mark as optimized
-    temp.int_value = number.int_value;
+    ForthToken temp(OptOp::NONE, number.int_value); // Mark as optimized
 
     if (op.value == "<") {
-        temp.optimized_op = "CMP_LT_IMM"; // Less than
+        temp.op = OptOp::CMP_LT_IMM; // Less than
     } else if (op.value == ">") {
-        temp.optimized_op = "CMP_GT_IMM"; // Greater than
+        temp.op = OptOp::CMP_GT_IMM; // Greater than
     } else if (op.value == "=") {
-        temp.optimized_op = "CMP_EQ_IMM"; // Equal
+        temp.op = OptOp::CMP_EQ_IMM; // Equal
     }
     optimizations++;
-    set_common_fields(temp);
 
     // Add the optimized token to the output
-    optimized_tokens.emplace_back(temp);
+    optimized_tokens.push_back(temp);
 
     // // Handle the token following the operator (if any)
     // if (index + 2 < tokens.size()) {
@@ -144,21 +159,51 @@ bool Optimizer::optimize_literal_comparison(const std::deque<ForthToken> &tokens
 
 
 
-ForthToken Optimizer::getToken(const std::deque<ForthToken>& tokens, size_t i) {
+// the compare and branch for IF, UNTIL or WHILE, the _IMM form follows each one
+static OptOp branch_op(const ForthToken &token) {
+    if (token.type != TOKEN_WORD) return OptOp::NONE;
+    if (same_word(token.value, "IF")) return OptOp::IF_CMP;
+    if (same_word(token.value, "UNTIL")) return OptOp::UNTIL_CMP;
+    if (same_word(token.value, "WHILE")) return OptOp::WHILE_CMP;
+    return OptOp::NONE;
+}
+
+// what an arm of IF .. ELSE .. THEN leaves, a new top cell or one of the top two cells
+enum class SelectArm { NONE, PUSH, KEEP };
+
+static SelectArm select_arm(const ForthToken &token) {
+    if (token.type == TOKEN_NUMBER) return SelectArm::PUSH;
+    if (token.type != TOKEN_WORD) return SelectArm::NONE;
+    if (token.value == "DUP" || token.value == "OVER") return SelectArm::PUSH;
+    if (token.value == "DROP" || token.value == "NIP") return SelectArm::KEEP;
+    return SelectArm::NONE;
+}
+
+// IF a ELSE b THEN at index, where a and b have no side effects and the same stack effect
+static bool is_select(const TokenStream &tokens, const size_t index) {
+    if (index + 4 >= tokens.size() || branch_op(tokens[index]) != OptOp::IF_CMP) return false;
+    const SelectArm arm = select_arm(tokens[index + 1]);
+    return arm != SelectArm::NONE && same_word(tokens[index + 2].value, "ELSE") &&
+           select_arm(tokens[index + 3]) == arm && same_word(tokens[index + 4].value, "THEN");
+}
+
+bool Optimizer::is_branch_comparison(const std::string_view op) {
+    return is_comparison_operator(op) || op == "<>" || op == "<=" || same_word(op, "f<") || same_word(op, "f>");
+}
+
+ForthToken Optimizer::getToken(const TokenStream& tokens, size_t i) {
     return (i < tokens.size()) ? tokens[i] : ForthToken();
 }
 
-bool Optimizer::optimize_peephole_case(const std::deque<ForthToken>& tokens,
-                                       std::deque<ForthToken>& optimized_tokens, size_t& index) {
+bool Optimizer::optimize_peephole_case(const TokenStream& tokens,
+                                       TokenStream& optimized_tokens, size_t& index) {
 
 
     // Lambda to create optimized tokens with less boilerplate
-    auto addOptimizedToken = [&](const std::string& optimized_name, int int_value = 0, const std::string& value = "", int word_id = 0) {
-        auto token = create_optimized_token(optimized_name);
-        token.int_value = int_value;
+    auto addOptimizedToken = [&](const OptOp op, const int64_t int_value = 0, const std::string_view value = {}, const uint32_t word_id = 0) {
+        auto &token = optimized_tokens.emplace_back(op, int_value);
         token.value = value;
         token.word_id = word_id;
-        optimized_tokens.emplace_back(token);
     };
 
     // Retrieve current token and lookahead tokens
@@ -166,38 +211,129 @@ bool Optimizer::optimize_peephole_case(const std::deque<ForthToken>& tokens,
     const ForthToken& next = getToken(tokens, index + 1);
     const ForthToken& third = getToken(tokens, index + 2);
     const ForthToken& fourth = getToken(tokens, index + 3);
+    const ForthToken& fifth = getToken(tokens, index + 4);
+    const ForthToken& sixth = getToken(tokens, index + 5);
 
     // Pattern-matching optimizations
+
+    // IF a ELSE b THEN becomes a conditional move, the arms follow the SELECT token
+    if (is_select(tokens, index)) {
+        addOptimizedToken(OptOp::SELECT);
+        optimized_tokens.push_back(next);
+        optimized_tokens.push_back(fourth);
+        index += 4;
+        optimizations++;
+        return true;
+    }
+
+    // a comparison that only feeds IF, UNTIL or WHILE becomes a compare and branch,
+    // unless the IF is a select, which needs the flag
+    if (const OptOp branch = branch_op(third); branch != OptOp::NONE && current.type == TOKEN_NUMBER &&
+                                               (next.value == "<" || next.value == ">" || next.value == "=") &&
+                                               !is_select(tokens, index + 2)) {
+        addOptimizedToken(static_cast<OptOp>(static_cast<uint8_t>(branch) + 1), current.int_value, next.value);
+        index += 2;
+        optimizations++;
+        return true;
+    }
+    if (const OptOp branch = branch_op(next); branch != OptOp::NONE && !is_select(tokens, index + 1)) {
+        if (current.type == TOKEN_WORD && same_word(current.value, "0=")) {
+            addOptimizedToken(static_cast<OptOp>(static_cast<uint8_t>(branch) + 1), 0, "=");
+            index += 1;
+            optimizations++;
+            return true;
+        }
+        if (current.type == TOKEN_WORD && is_branch_comparison(current.value)) {
+            addOptimizedToken(branch, 0, current.value);
+            index += 1;
+            optimizations++;
+            return true;
+        }
+    }
+
     if (current.value == "R>" && next.type == TOKEN_NUMBER && third.value == "+" && fourth.value == ">R") {
-        addOptimizedToken("INC_R@", next.int_value);
+        addOptimizedToken(OptOp::INC_R, next.int_value);
         index += 3; // Skip next 3 tokens
         optimizations++;
         return true;
     }
 
     if (current.value == "R>" && next.type == TOKEN_NUMBER && third.value == "-" && fourth.value == ">R") {
-        addOptimizedToken("DEC_R@", next.int_value);
+        addOptimizedToken(OptOp::DEC_R, next.int_value);
         index += 3;
         optimizations++;
         return true;
     }
 
+    // a known execution token is called directly, through the patch table when the word is deferred
+    if (current.value == "[']" && next.type == TOKEN_WORD && same_word(third.value, "EXEC")) {
+        addOptimizedToken(OptOp::CALL_XT, 0, next.value, next.word_id);
+        index += 2;
+        optimizations++;
+        return true;
+    }
+
+    // counters and accumulators are updated in memory
+    if (current.type == TOKEN_NUMBER && next.type == TOKEN_VARIABLE && third.value == "+!") {
+        addOptimizedToken(OptOp::LIT_VAR_PLUS_STORE, current.int_value, next.value, next.word_id);
+        index += 2;
+        optimizations++;
+        return true;
+    }
+
+    if (current.type == TOKEN_VARIABLE && next.value == "@") {
+        // the sum is stored back into the variable it was read from
+        const bool literal = third.type == TOKEN_NUMBER;
+        const ForthToken &target = literal ? fifth : fourth;
+        const ForthToken &store = literal ? sixth : fifth;
+        const bool storedBack = target.type == TOKEN_VARIABLE && same_word(target.value, current.value) &&
+                                store.value == "!";
+
+        // var @ n + var !  and  var @ n - var !
+        if (literal && (fourth.value == "+" || fourth.value == "-") && storedBack) {
+            const uint64_t n = fourth.value == "+" ? third.int_value : 0 - third.int_value;
+            addOptimizedToken(OptOp::LIT_VAR_PLUS_STORE, static_cast<int64_t>(n), current.value, current.word_id);
+            index += 5;
+            optimizations++;
+            return true;
+        }
+        // var @ + var !
+        if (third.value == "+" && storedBack) {
+            addOptimizedToken(OptOp::VAR_PLUS_STORE, 0, current.value, current.word_id);
+            index += 4;
+            optimizations++;
+            return true;
+        }
+        if (third.value == "+") {
+            addOptimizedToken(OptOp::VAR_AT_ADD, 0, current.value, current.word_id);
+            index += 2;
+            optimizations++;
+            return true;
+        }
+        if (branch_op(third) == OptOp::IF_CMP && !is_select(tokens, index + 2)) {
+            addOptimizedToken(OptOp::VAR_AT_IF, 0, current.value, current.word_id);
+            index += 2;
+            optimizations++;
+            return true;
+        }
+    }
+
     if (current.type == TOKEN_NUMBER && next.type == TOKEN_VARIABLE && third.value == "!") {
-        addOptimizedToken("LIT_VAR_!", current.int_value, next.value);
+        addOptimizedToken(OptOp::LIT_VAR_STORE, current.int_value, next.value);
         index += 2;
         optimizations++;
         return true;
     }
 
     if (current.value == "R@" && next.value == "C!") {
-        addOptimizedToken("R@_C!");
+        addOptimizedToken(OptOp::R_AT_CSTORE);
         index += 1;
         optimizations++;
         return true;
     }
 
     if (current.value == "R@" && next.value == "!") {
-        addOptimizedToken("R@_!");
+        addOptimizedToken(OptOp::R_AT_STORE);
         index += 1;
         optimizations++;
         return true;
@@ -205,19 +341,25 @@ bool Optimizer::optimize_peephole_case(const std::deque<ForthToken>& tokens,
 
     if (current.type == TOKEN_VARIABLE) {
         if (next.value == "@") {
-            addOptimizedToken("VAR_@", 0, current.value, current.word_id);
+            addOptimizedToken(OptOp::VAR_AT, 0, current.value, current.word_id);
             index += 1;
             optimizations++;
             return true;
         }
         if (next.value == "!") {
-            addOptimizedToken("VAR_!", 0, current.value, current.word_id);
+            addOptimizedToken(OptOp::VAR_STORE, 0, current.value, current.word_id);
             index += 1;
             optimizations++;
             return true;
         }
         if (next.value == ">R") {
-            addOptimizedToken("VAR_TOR", 0, current.value, current.word_id);
+            addOptimizedToken(OptOp::VAR_TOR, 0, current.value, current.word_id);
+            index += 1;
+            optimizations++;
+            return true;
+        }
+        if (next.value == "+!") {
+            addOptimizedToken(OptOp::VAR_PLUS_STORE, 0, current.value, current.word_id);
             index += 1;
             optimizations++;
             return true;
@@ -225,35 +367,28 @@ bool Optimizer::optimize_peephole_case(const std::deque<ForthToken>& tokens,
     }
 
     if (current.value == "C@" && next.value == "EMIT") {
-        addOptimizedToken("C@_EMIT");
+        addOptimizedToken(OptOp::CAT_EMIT);
         index += 1;
         optimizations++;
         return true;
     }
 
     if (current.value == "DUP" && next.value == "+") {
-        addOptimizedToken("LEA_TOS");
+        addOptimizedToken(OptOp::LEA_TOS);
         index += 1;
         optimizations++;
         return true;
     }
 
     if (current.value == "SWAP" && next.value == "DROP") {
-        addOptimizedToken("MOV_TOS_1");
-        index += 1;
-        optimizations++;
-        return true;
-    }
-
-    if (current.value == "DUP" && next.value == "ROT") {
-        addOptimizedToken("TUCK");
+        addOptimizedToken(OptOp::MOV_TOS_1);
         index += 1;
         optimizations++;
         return true;
     }
 
+    // OVER DROP changes nothing
     if (current.value == "OVER" && next.value == "DROP") {
-        addOptimizedToken("DUP");
         index += 1;
         optimizations++;
         return true;
@@ -265,19 +400,3 @@ bool Optimizer::optimize_peephole_case(const std::deque<ForthToken>& tokens,
 bool Optimizer::is_power_of_two(int64_t value) {
     return (value > 0 && (value & (value - 1)) == 0);
 }
-
-ForthToken Optimizer::create_optimized_token(const std::string &optimized_op) {
-    ForthToken temp;
-    temp.type = TOKEN_OPTIMIZED;
-    temp.optimized_op = optimized_op;
-    set_common_fields(temp);
-
-    return temp;
-}
-
-void Optimizer::set_common_fields(ForthToken &token) {
-    token.word_id = SymbolTable::instance().addSymbol(token.optimized_op);
-    token.word_len = token.optimized_op.size();
-    token.opt_value = token.int_value;
-
-}
@@ -0,0 +1,194 @@
+#include "PerfCounters.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+
+PerfCounters::~PerfCounters() {
+    for (const auto &counter: counters) {
+        close(counter.fd);
+    }
+}
+
+#if defined(__linux__)
+
+namespace {
+
+struct EventSpec {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+};
+
+constexpr uint64_t cache_event(const uint64_t cache, const uint64_t op, const uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+// cycles first, it leads the first group
+constexpr EventSpec EVENTS[] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"L1D-misses", PERF_TYPE_HW_CACHE,
+        cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"LLC-misses", PERF_TYPE_HW_CACHE,
+        cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"iTLB-misses", PERF_TYPE_HW_CACHE,
+        cache_event(PERF_COUNT_HW_CACHE_ITLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+};
+
+// the groups tried in turn, all together first, then groups small enough to share the PMU,
+// e.g. with the NMI watchdog holding a counter, then one event at a time
+const std::vector<std::vector<std::vector<size_t>>> LAYOUTS = {
+    {{0, 1, 2, 3, 4, 5}},
+    {{0, 1}, {2}, {3, 4, 5}},
+    {{0, 1}, {2}, {3}, {4}, {5}},
+};
+
+int perf_event_open(perf_event_attr *attr, const int group) {
+    return static_cast<int>(syscall(SYS_perf_event_open, attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC));
+}
+
+} // namespace
+
+void PerfCounters::openGroup(const std::vector<size_t> &events) {
+    int leader = -1;
+    for (const size_t index: events) {
+        const EventSpec &event = EVENTS[index];
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.disabled = leader < 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                           PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        const int fd = perf_event_open(&attr, leader);
+        if (fd < 0) {
+            if (index == 0) {
+                // without cycles there are no counters, perf_event_paranoid or a container is the usual cause
+                why = std::string("perf_event_open: ") + std::strerror(errno);
+                return;
+            }
+            continue; // this CPU does not count it
+        }
+        if (leader < 0) {
+            leader = fd;
+            leaders.push_back(fd);
+        }
+        uint64_t id = 0;
+        ioctl(fd, PERF_EVENT_IOC_ID, &id);
+        counters.push_back({event.name, fd, id, leader});
+    }
+}
+
+// nr, time enabled, time running, then a value and id for each counter
+std::vector<uint64_t> PerfCounters::readGroup(const int leader) const {
+    std::vector<uint64_t> data(3 + 2 * counters.size());
+    const ssize_t n = read(leader, data.data(), data.size() * sizeof(uint64_t));
+    if (n < static_cast<ssize_t>(3 * sizeof(uint64_t))) data.assign(3, 0);
+    return data;
+}
+
+void PerfCounters::closeAll() {
+    for (const auto &counter: counters) {
+        close(counter.fd);
+    }
+    counters.clear();
+    leaders.clear();
+}
+
+// a group the PMU cannot fit is never scheduled, its time running stays 0
+bool PerfCounters::scheduled() const {
+    start();
+    volatile uint64_t sink = 0;
+    for (uint64_t i = 0; i < 100000; ++i) {
+        sink = sink + i;
+    }
+    stop();
+    for (const int leader: leaders) {
+        if (readGroup(leader)[2] == 0) return false;
+    }
+    return true;
+}
+
+bool PerfCounters::open() {
+    for (const auto &layout: LAYOUTS) {
+        closeAll();
+        for (const auto &group: layout) {
+            openGroup(group);
+            if (leaders.empty()) return false;
+        }
+        if (scheduled()) break;
+    }
+    for (const int leader: leaders) {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    }
+    return true;
+}
+
+void PerfCounters::start() const {
+    for (const int leader: leaders) {
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+void PerfCounters::stop() const {
+    for (const int leader: leaders) {
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+std::vector<std::pair<const char *, double>> PerfCounters::totals() {
+    std::vector<std::pair<const char *, double>> result;
+    std::string unscheduled;
+    for (const int leader: leaders) {
+        const std::vector<uint64_t> data = readGroup(leader);
+        if (data[2] == 0) {
+            for (const auto &counter: counters) {
+                if (counter.leader == leader) unscheduled += std::string(" ") + counter.name;
+            }
+            continue;
+        }
+        const double scale = static_cast<double>(data[1]) / static_cast<double>(data[2]);
+        for (uint64_t i = 0; i < data[0] && 4 + 2 * i < data.size(); ++i) {
+            const uint64_t value = data[3 + 2 * i];
+            const uint64_t id = data[4 + 2 * i];
+            for (const auto &counter: counters) {
+                if (counter.id == id) {
+                    result.emplace_back(counter.name, static_cast<double>(value) * scale);
+                }
+            }
+        }
+    }
+    if (!unscheduled.empty()) {
+        why = "not scheduled:" + unscheduled;
+    }
+    return result;
+}
+
+#else
+
+bool PerfCounters::open() {
+    why = "hardware counters need Linux perf_event_open";
+    return false;
+}
+
+void PerfCounters::start() const {
+}
+
+void PerfCounters::stop() const {
+}
+
+std::vector<std::pair<const char *, double>> PerfCounters::totals() {
+    return {};
+}
+
+#endif
@@ -0,0 +1,145 @@
+#include "PerfMap.h"
+#include <iostream>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+// the jitdump format as read by perf inject, see tools/perf/util/jitdump.h in the kernel tree
+constexpr uint32_t JITDUMP_MAGIC = 0x4A695444;
+constexpr uint32_t JITDUMP_VERSION = 1;
+constexpr uint32_t EM_X86_64_MACHINE = 62;
+constexpr uint32_t JIT_CODE_LOAD = 0;
+
+struct JitHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t totalSize;
+    uint32_t elfMach;
+    uint32_t pad;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags;
+};
+
+struct JitCodeLoad {
+    uint32_t id;
+    uint32_t totalSize;
+    uint64_t timestamp;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t codeAddr;
+    uint64_t codeSize;
+    uint64_t codeIndex;
+    // followed by the name with its terminating zero, then the code
+};
+
+// perf record -k mono uses the same clock
+uint64_t timestamp() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint32_t thread_id() {
+#if defined(__linux__)
+    return static_cast<uint32_t>(syscall(SYS_gettid));
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+} // namespace
+
+
+PerfMap::~PerfMap() {
+    setMap(false);
+    closeDump();
+}
+
+bool PerfMap::setMap(const bool on) {
+    if (!on) {
+        if (mapFile) fclose(mapFile);
+        mapFile = nullptr;
+        return true;
+    }
+    if (mapFile) return true;
+    const std::string path = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+    mapFile = fopen(path.c_str(), "a");
+    if (!mapFile) {
+        std::cerr << "PERFMAP: unable to open " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool PerfMap::setDump(const bool on) {
+    if (!on) {
+        closeDump();
+        return true;
+    }
+    if (dumpFile) return true;
+    const std::string path = "/tmp/jit-" + std::to_string(getpid()) + ".dump";
+    dumpFile = fopen(path.c_str(), "w+");
+    if (!dumpFile) {
+        std::cerr << "JITDUMP: unable to open " << path << std::endl;
+        return false;
+    }
+    writeDumpHeader();
+    // perf record notices the dump file when it is mapped executable
+    markerSize = static_cast<size_t>(getpagesize());
+    dumpMarker = mmap(nullptr, markerSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, fileno(dumpFile), 0);
+    if (dumpMarker == MAP_FAILED) {
+        dumpMarker = nullptr;
+    }
+    return true;
+}
+
+void PerfMap::writeDumpHeader() {
+    const JitHeader header{
+        JITDUMP_MAGIC, JITDUMP_VERSION, sizeof(JitHeader), EM_X86_64_MACHINE, 0,
+        static_cast<uint32_t>(getpid()), timestamp(), 0
+    };
+    fwrite(&header, sizeof(header), 1, dumpFile);
+    fflush(dumpFile);
+}
+
+void PerfMap::closeDump() {
+    if (dumpMarker) munmap(dumpMarker, markerSize);
+    dumpMarker = nullptr;
+    if (dumpFile) fclose(dumpFile);
+    dumpFile = nullptr;
+}
+
+void PerfMap::record(const void *code, const size_t size, const std::string &name) {
+    const std::string symbol = name.empty() ? "anonymous" : name;
+    const auto address = reinterpret_cast<uintptr_t>(code);
+
+    if (mapFile) {
+        fprintf(mapFile, "%lx %zx %s\n", static_cast<unsigned long>(address), size, symbol.c_str());
+        fflush(mapFile);
+    }
+
+    if (dumpFile) {
+        const JitCodeLoad load{
+            JIT_CODE_LOAD,
+            static_cast<uint32_t>(sizeof(JitCodeLoad) + symbol.size() + 1 + size),
+            timestamp(),
+            static_cast<uint32_t>(getpid()),
+            thread_id(),
+            address,
+            address,
+            size,
+            codeIndex++
+        };
+        fwrite(&load, sizeof(load), 1, dumpFile);
+        fwrite(symbol.c_str(), symbol.size() + 1, 1, dumpFile);
+        fwrite(code, size, 1, dumpFile);
+        fflush(dumpFile);
+    }
+}
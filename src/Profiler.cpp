@@ -0,0 +1,131 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <sys/time.h>
+#include <ucontext.h>
+#include "CodeIndex.h"
+
+
+Profiler::~Profiler() {
+    stop();
+}
+
+bool Profiler::start() {
+    if (active) return true;
+    samples.resize(MAX_SAMPLES);
+    count = 0;
+    dropped = 0;
+
+    struct sigaction action{};
+    action.sa_sigaction = &Profiler::handle_sample;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) return false;
+
+    itimerval timer{};
+    timer.it_interval.tv_usec = INTERVAL_US;
+    timer.it_value.tv_usec = INTERVAL_US;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) return false;
+    active = true;
+    return true;
+}
+
+void Profiler::stop() {
+    if (!active) return;
+    itimerval timer{};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    signal(SIGPROF, SIG_IGN);
+    active = false;
+}
+
+// runs in the signal handler, so it only copies, the samples are made sense of in report
+void Profiler::handle_sample(int, siginfo_t *, void *context) {
+    auto &profiler = instance();
+    const size_t n = profiler.count;
+    if (n >= profiler.samples.size()) {
+        ++profiler.dropped;
+        return;
+    }
+    const auto *uc = static_cast<const ucontext_t *>(context);
+#if defined(__APPLE__)
+    const auto ip = static_cast<uintptr_t>(uc->uc_mcontext->__ss.__rip);
+    const auto sp = static_cast<uintptr_t>(uc->uc_mcontext->__ss.__rsp);
+#else
+    const auto ip = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+    const auto sp = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RSP]);
+#endif
+    Sample &sample = profiler.samples[n];
+    sample.ip = ip;
+    std::memcpy(sample.stack, reinterpret_cast<const void *>(sp), sizeof(sample.stack));
+    profiler.count = n + 1;
+}
+
+std::unordered_map<uintptr_t, size_t> Profiler::samplesIn(const uintptr_t start, const uintptr_t end) const {
+    std::unordered_map<uintptr_t, size_t> hits;
+    const size_t n = count;
+    for (size_t i = 0; i < n; ++i) {
+        if (samples[i].ip >= start && samples[i].ip < end) {
+            ++hits[samples[i].ip];
+        }
+    }
+    return hits;
+}
+
+void Profiler::report(const size_t rows) {
+    stop();
+    const size_t n = count;
+    if (n == 0) {
+        std::cout << "No samples, PROFILE-START first" << std::endl;
+        return;
+    }
+
+    auto &index = CodeIndex::instance();
+    struct Counts {
+        size_t self = 0;
+        size_t total = 0;
+    };
+    std::unordered_map<std::string, Counts> words;
+    std::unordered_set<std::string> seen;
+
+    for (size_t i = 0; i < n; ++i) {
+        const Sample &sample = samples[i];
+        seen.clear();
+        const auto *range = index.find(sample.ip);
+        const std::string self = range ? range->name : "[native code]";
+        ++words[self].self;
+        ++words[self].total;
+        seen.insert(self);
+        // values on the stack that point into JIT code are taken to be return addresses
+        for (const uintptr_t value: sample.stack) {
+            if (const auto *caller = index.find(value); caller && seen.insert(caller->name).second) {
+                ++words[caller->name].total;
+            }
+        }
+    }
+
+    std::vector<std::pair<std::string, Counts>> sorted(words.begin(), words.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+        return a.second.self != b.second.self ? a.second.self > b.second.self : a.second.total > b.second.total;
+    });
+
+    const auto flags = std::cout.flags();
+    const auto precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Profile: " << n << " samples, " << n * INTERVAL_US / 1000 << " ms of CPU time";
+    if (dropped) std::cout << ", " << dropped << " dropped";
+    std::cout << std::endl;
+    std::cout << std::setw(8) << "self%" << std::setw(8) << "total%" << "  word" << std::endl;
+    for (size_t i = 0; i < sorted.size() && i < rows; ++i) {
+        const auto &[name, c] = sorted[i];
+        std::cout << std::setw(8) << 100.0 * static_cast<double>(c.self) / static_cast<double>(n)
+                << std::setw(8) << 100.0 * static_cast<double>(c.total) / static_cast<double>(n)
+                << "  " << name << std::endl;
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
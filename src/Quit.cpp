@@ -1,11 +1,17 @@
 #include <iostream>
 #include <csignal>
 #include <csetjmp>
+#include <cctype>
 #include "Quit.h"
 #include <Interpreter.h>
 #include "LineReader.h"
 #include "SignalHandler.h"
 #include "Settings.h"
+#include "OutputBuffer.h"
+#include "ScriptRunner.h"
+#include "CallCounters.h"
+#include "Compiler.h"
+#include <unistd.h>
 
 // Function to fetch registers for debugging (example placeholders)
 uint64_t fetchR15();
@@ -24,6 +30,7 @@ extern uintptr_t stack_base;
 
 void display_stack_status() {
     const auto depth = static_cast<int64_t>((stack_top - fetchR15() > 0) ? ((stack_top - fetchR15()) / 8) : 0);
+    OutputBuffer::instance().flush();
     std::cout << std::endl << "Ok ";
     if (print_stack) {
         std::cout <<
@@ -49,10 +56,23 @@ bool containsSemiColon(const std::string &input) {
 void to_uppercase(std::string &str) {
     bool in_quotes = false; // Track if we're inside quotes
     char current_quote = '\0'; // Tracks the type of quote we are inside (' or ")
+    bool file_name = false; // the word after INCLUDE keeps its case
+    size_t word_start = 0;
 
     for (size_t i = 0; i < str.size(); ++i) {
         char &c = str[i];
 
+        if (!in_quotes && std::isspace(static_cast<unsigned char>(c))) {
+            if (i > word_start) {
+                file_name = str.compare(word_start, i - word_start, "INCLUDE") == 0;
+            }
+            word_start = i + 1;
+            continue;
+        }
+        if (file_name) {
+            continue;
+        }
+
         // Check if the current character is a quote
         if ((c == '\'' || c == '"') && (i == 0 || str[i - 1] != '\\')) {
             if (!in_quotes) {
@@ -80,6 +100,8 @@ inline void interactive_terminal() {
     bool compiling = false;
 
     // std::cout << "ForthJIT " << std::endl;
+    Interpreter::instance().execute(
+        R"( CLS ." MacForth" CR )");
     display_stack_status();
 
     LineReader::initialize();
@@ -92,6 +114,7 @@ inline void interactive_terminal() {
 
         // Exit condition
         if (input == "BYE" || input == "bye") {
+            OutputBuffer::instance().flush();
             LineReader::finalize();
             exit(0);
         }
@@ -135,7 +158,36 @@ void Quit() {
             interactive_terminal();
         } else {
             // If an exception is raised (via longjmp), handle it here
+            ScriptRunner::instance().reset();
+            Interpreter::instance().reset();
+            Compiler::instance().reset();
+            CallCounters::instance().resetDepths();
             // std::cout << "Recovered from a runtime error. Restarting interpreter." << std::endl;
         }
     }
 }
+
+
+// Script mode runs a file, or a pipe on stdin, without the terminal.
+// The first error stops the script with a non zero exit status.
+int Script(const std::string &path) {
+    SignalHandler::instance().register_signal_handlers();
+
+    if (setjmp(SignalHandler::instance().get_jump_buffer()) != 0) {
+        ScriptRunner::instance().reset();
+        Interpreter::instance().reset();
+        Compiler::instance().reset();
+        CallCounters::instance().resetDepths();
+        OutputBuffer::instance().flush();
+        return 1;
+    }
+
+    bool ok = true;
+    if (path.empty()) {
+        ScriptRunner::instance().run(STDIN_FILENO);
+    } else {
+        ok = ScriptRunner::instance().includeFile(path);
+    }
+    OutputBuffer::instance().flush();
+    return ok ? 0 : 1;
+}
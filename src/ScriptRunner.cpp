@@ -0,0 +1,145 @@
+#include "ScriptRunner.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Interpreter.h"
+#include "Quit.h"
+
+
+bool ScriptRunner::includeFile(const std::string &path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "INCLUDE: unable to open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    openFiles.push_back(fd);
+    run(fd);
+    openFiles.pop_back();
+    close(fd);
+    return true;
+}
+
+void ScriptRunner::run(const int fd) {
+    std::string source;
+    ScanState state;
+
+    while (true) {
+        // read straight into the end of the source buffer
+        const size_t used = source.size();
+        source.resize(used + CHUNK_SIZE);
+        const ssize_t n = read(fd, source.data() + used, CHUNK_SIZE);
+        if (n < 0 && errno == EINTR) {
+            source.resize(used);
+            continue;
+        }
+        source.resize(used + static_cast<size_t>(std::max<ssize_t>(n, 0)));
+        if (n <= 0) break;
+
+        scan(source, state, false);
+
+        // forget the source that has been run, once per chunk
+        source.erase(0, state.unitStart);
+        state.scanned -= state.unitStart;
+        state.unitStart = 0;
+    }
+
+    // the last line may not have a newline
+    source.push_back('\n');
+    scan(source, state, true);
+    if (state.unitStart < source.size()) {
+        // an unfinished definition, let the compiler report it
+        execute(source, state.unitStart, source.size());
+    }
+}
+
+void ScriptRunner::reset() {
+    for (const int fd: openFiles) {
+        close(fd);
+    }
+    openFiles.clear();
+}
+
+// Walk the complete tokens in source, running each line as it ends and each
+// definition when its ; arrives. Comments are blanked out in place.
+// Stops early at a token that may continue in the next chunk.
+void ScriptRunner::scan(std::string &source, ScanState &state, const bool atEnd) {
+    const size_t n = source.size();
+    size_t i = state.scanned;
+
+    while (i < n) {
+        const char c = source[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            if (c == '\n' && !state.compiling) {
+                execute(source, state.unitStart, i);
+                state.unitStart = i + 1;
+            }
+            ++i;
+            continue;
+        }
+
+        size_t end = i;
+        while (end < n && !std::isspace(static_cast<unsigned char>(source[end]))) ++end;
+        if (end == n && !atEnd) break;
+
+        const std::string_view token(source.data() + i, end - i);
+
+        if (state.skipNext) {
+            // the character after CHAR or [CHAR]
+            state.skipNext = false;
+        } else if (token == "\\") {
+            size_t eol = source.find('\n', end);
+            if (eol == std::string::npos) {
+                if (!atEnd) break;
+                eol = n;
+            }
+            std::fill(source.begin() + static_cast<std::ptrdiff_t>(i), source.begin() + static_cast<std::ptrdiff_t>(eol), ' ');
+            end = eol;
+        } else if (token == "(") {
+            size_t close = source.find(')', end);
+            if (close == std::string::npos) {
+                if (!atEnd) break;
+                close = n - 1;
+            }
+            std::fill(source.begin() + static_cast<std::ptrdiff_t>(i), source.begin() + static_cast<std::ptrdiff_t>(close) + 1, ' ');
+            end = close + 1;
+        } else if (token.size() > 1 && token.back() == '"') {
+            // ." and S" are followed by a string that may hold anything
+            size_t close = end + 1 < n ? source.find('"', end + 1) : std::string::npos;
+            if (close == std::string::npos) {
+                if (!atEnd) break;
+                close = n - 1;
+            }
+            end = close + 1;
+        } else if (token == "CHAR" || token == "[CHAR]" || token == "char" || token == "[char]") {
+            state.skipNext = true;
+        } else if (token == ":" && !state.compiling) {
+            // run anything before the definition on this line first
+            execute(source, state.unitStart, i);
+            state.unitStart = i;
+            state.compiling = true;
+        } else if (token == ";" && state.compiling) {
+            state.compiling = false;
+            execute(source, state.unitStart, end);
+            state.unitStart = end;
+        }
+        i = end;
+    }
+    state.scanned = i;
+}
+
+void ScriptRunner::execute(std::string &source, const size_t from, const size_t to) {
+    if (to <= from) return;
+    const auto first = std::find_if(source.begin() + static_cast<std::ptrdiff_t>(from),
+                                    source.begin() + static_cast<std::ptrdiff_t>(to),
+                                    [](const unsigned char c) { return !std::isspace(c); });
+    if (first == source.begin() + static_cast<std::ptrdiff_t>(to)) return;
+
+    std::string unit = source.substr(from, to - from);
+    to_uppercase(unit);
+    Interpreter::instance().execute(unit);
+}
@@ -2,6 +2,7 @@
 #include <csignal>
 #include <csetjmp>
 #include <cstdio>
+#include "OutputBuffer.h"
 
 // Public method to raise an exception
 void SignalHandler::raise(int eno) {
@@ -13,6 +14,9 @@ void SignalHandler::raise(int eno) {
         eno = 0; // Default to "Unknown error" if out of range
     }
 
+    // Show what the word printed before it failed
+    OutputBuffer::instance().flush();
+
     // Print the error message
     fprintf(stderr, "FORTH RUNTIME ERROR: %s (Error %d)\n", exception_messages[eno], eno);
 
@@ -0,0 +1,235 @@
+#include "StackEffect.h"
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ForthDictionary.h"
+#include "Tokenizer.h"
+
+// data stack effects of the primitives
+static const std::unordered_map<std::string_view, StackEffect> primitives = {
+    // stack
+    {"DUP", {1, 2}}, {"DROP", {1, 0}}, {"SWAP", {2, 2}}, {"OVER", {2, 3}}, {"ROT", {3, 3}}, {"-ROT", {3, 3}},
+    {"NIP", {2, 1}}, {"TUCK", {2, 3}}, {"2DUP", {2, 4}}, {"2DROP", {2, 0}}, {"2OVER", {4, 6}},
+    {"DEPTH", {0, 1}}, {"RDEPTH", {0, 1}},
+    // return stack
+    {">R", {1, 0}}, {"R>", {0, 1}}, {"R@", {0, 1}}, {"2>R", {2, 0}}, {"2R>", {0, 2}},
+    {"RDROP", {0, 0}}, {"2RDROP", {0, 0}}, {"R>R", {0, 0}},
+    // memory
+    {"@", {1, 1}}, {"!", {2, 0}}, {"+!", {2, 0}}, {"C@", {1, 1}}, {"C!", {2, 0}},
+    {"FILL", {3, 0}}, {"BLANK", {2, 0}}, {"ERASE", {2, 0}},
+    // arithmetic and logic
+    {"+", {2, 1}}, {"-", {2, 1}}, {"*", {2, 1}}, {"/", {2, 1}}, {"MOD", {2, 1}}, {"/MOD", {2, 2}},
+    {"U/", {2, 1}}, {"UMOD", {2, 1}}, {"*/", {3, 1}}, {"*/MOD", {3, 2}},
+    {"NEGATE", {1, 1}}, {"ABS", {1, 1}}, {"SQRT", {1, 1}},
+    {"MIN", {2, 1}}, {"MAX", {2, 1}}, {"CLAMP", {3, 1}}, {"WITHIN", {3, 1}},
+    {"AND", {2, 1}}, {"OR", {2, 1}}, {"XOR", {2, 1}}, {"NOT", {1, 1}},
+    {"=", {2, 1}}, {"<>", {2, 1}}, {"<", {2, 1}}, {">", {2, 1}}, {"<=", {2, 1}}, {"0=", {1, 1}},
+    // loops
+    {"I", {0, 1}}, {"J", {0, 1}}, {"K", {0, 1}}, {"LEAVE", {0, 0}},
+    // output
+    {"EMIT", {1, 0}}, {"KEY", {0, 1}}, {"CR", {0, 0}}, {"SPACE", {0, 0}}, {"CLS", {0, 0}}, {"(PAGE)", {0, 0}},
+    {"TYPE", {2, 0}}, {"COUNT", {1, 2}}, {"FLUSH", {0, 0}},
+    {".", {1, 0}}, {"U.", {1, 0}}, {"D.", {2, 0}}, {"(.)", {1, 2}}, {"(U.)", {1, 2}}, {"(D.)", {2, 2}},
+    {"<#", {0, 0}}, {"#", {2, 2}}, {"#S", {2, 2}}, {"HOLD", {1, 0}}, {"SIGN", {1, 0}}, {"#>", {2, 2}},
+    {".\"", {0, 0}}, {"S\"", {0, 2}},
+    // files and blocks
+    {"R/O", {0, 1}}, {"W/O", {0, 1}}, {"R/W", {0, 1}},
+    {"OPEN-FILE", {3, 2}}, {"CREATE-FILE", {3, 2}}, {"CLOSE-FILE", {1, 1}}, {"READ-FILE", {3, 2}},
+    {"WRITE-FILE", {3, 1}}, {"FILE-SIZE", {1, 3}}, {"READ-FILE-ASYNC", {3, 1}}, {"AWAIT", {1, 1}},
+    {"BLOCK", {1, 1}}, {"BUFFER", {1, 1}}, {"UPDATE", {0, 0}}, {"SAVE-BUFFERS", {0, 0}},
+    {"EMPTY-BUFFERS", {0, 0}}, {"OPEN-BLOCKS", {2, 0}}, {"BLOCK-BUFFERS", {2, 0}}, {"INCLUDED", {2, 0}},
+    // floats, kept on the data stack
+    {"F+", {2, 1}}, {"F-", {2, 1}}, {"F*", {2, 1}}, {"F/", {2, 1}}, {"FMOD", {2, 1}}, {"FMIN", {2, 1}},
+    {"FMAX", {2, 1}}, {"FABS", {1, 1}}, {"FSQRT", {1, 1}}, {"SIN", {1, 1}}, {"COS", {1, 1}},
+    {"FLOOR", {1, 1}}, {"FROUND", {1, 1}}, {"FTRUNCATE", {1, 1}},
+    {"F=", {2, 1}}, {"F<", {2, 1}}, {"F>", {2, 1}}, {"F>S", {1, 1}}, {"S>F", {1, 1}},
+    {"F.", {1, 0}}, {"FE.", {1, 0}}, {"FS.", {1, 0}}, {"(F.)", {1, 2}},
+    {"PRECISION", {0, 1}}, {"SET-PRECISION", {1, 0}},
+    // words that read the next name
+    {"[']", {0, 1}}, {"'", {0, 1}}, {"[CHAR]", {0, 1}}, {"CHAR", {0, 1}}, {"IS", {1, 0}},
+};
+
+// the words above that take the following token as their argument
+static bool parses_name(const std::string_view name) {
+    return name == "[']" || name == "'" || name == "[CHAR]" || name == "CHAR" || name == "IS";
+}
+
+static std::string upper(const std::string_view text) {
+    std::string name(text);
+    std::transform(name.begin(), name.end(), name.begin(), [](const unsigned char c) { return std::toupper(c); });
+    return name;
+}
+
+StackEffect StackEffects::lookup(const ForthToken &token) const {
+    const auto *entry = ForthDictionary::instance().findWord(token.value);
+    if (entry && entry->effect.known()) return entry->effect;
+    if (entry && entry->type == ForthWordType::VARIABLE) return {0, 1};
+    if (const auto it = primitives.find(upper(token.value)); it != primitives.end()) return it->second;
+    return {};
+}
+
+namespace {
+    enum class Structure { IF, BEGIN, DO };
+
+    // an open IF, BEGIN or DO, with the depth when it started
+    struct Frame {
+        Structure kind;
+        int depth;
+        bool dead; // code before it had already left with EXIT
+        bool hasElse = false;
+        int branchDepth = 0; // the IF branch, once ELSE is seen
+        bool branchDead = false;
+        int whileDepth = 0; // BEGIN .. WHILE leaves at this depth
+        bool hasWhile = false;
+    };
+}
+
+// depth is counted from the start of the word, lowest is the deepest cell used below it
+StackEffect StackEffects::infer(const TokenStream &tokens, std::string &problem) const {
+    int depth = 0;
+    int lowest = 0;
+    bool dead = false; // after EXIT until the end of the branch
+    bool exits = false;
+    int exitDepth = 0;
+    std::vector<Frame> frames;
+
+    // two paths meet, an unreachable path takes the depth of the other
+    auto join = [&](const int otherDepth, const bool otherDead, const char *what) {
+        if (dead) {
+            depth = otherDepth;
+            dead = otherDead;
+        } else if (!otherDead && otherDepth != depth) {
+            problem = std::string(what) + " leave the stack at different depths";
+            return false;
+        }
+        return true;
+    };
+    auto unbalanced = [&problem]() -> StackEffect {
+        problem = "unbalanced control structure";
+        return {};
+    };
+    auto apply = [&](const StackEffect effect) {
+        if (dead) return;
+        lowest = std::min(lowest, depth - effect.in);
+        depth += effect.out - effect.in;
+    };
+
+    bool ended = false;
+    for (size_t i = 2; i < tokens.size() && !ended; ++i) { // after : name
+        const ForthToken &token = tokens[i];
+        switch (token.type) {
+            case TokenType::TOKEN_END:
+            case TokenType::TOKEN_INTERPRETING:
+                ended = true;
+                continue;
+            case TokenType::TOKEN_NUMBER:
+            case TokenType::TOKEN_FLOAT:
+                apply({0, 1});
+                continue;
+            case TokenType::TOKEN_DOUBLE:
+                apply({0, 2});
+                continue;
+            case TokenType::TOKEN_STRING:
+                continue;
+            case TokenType::TOKEN_BEGINCOMMENT:
+                while (i + 1 < tokens.size() && tokens[i + 1].type != TokenType::TOKEN_ENDCOMMENT) ++i;
+                ++i;
+                continue;
+            case TokenType::TOKEN_WORD:
+            case TokenType::TOKEN_VARIABLE:
+                break;
+            default:
+                // locals, or a name that is not defined
+                return {};
+        }
+
+        const std::string name = upper(token.value);
+        if (name == "IF") {
+            apply({1, 0});
+            frames.push_back({Structure::IF, depth, dead});
+        } else if (name == "ELSE") {
+            if (frames.empty() || frames.back().kind != Structure::IF) return unbalanced();
+            auto &frame = frames.back();
+            frame.hasElse = true;
+            frame.branchDepth = depth;
+            frame.branchDead = dead;
+            depth = frame.depth;
+            dead = frame.dead;
+        } else if (name == "THEN") {
+            if (frames.empty() || frames.back().kind != Structure::IF) return unbalanced();
+            const Frame frame = frames.back();
+            frames.pop_back();
+            const bool same = frame.hasElse
+                                  ? join(frame.branchDepth, frame.branchDead, "IF and ELSE")
+                                  : join(frame.depth, frame.dead, "IF and its skipped branch");
+            if (!same) return {};
+        } else if (name == "BEGIN") {
+            frames.push_back({Structure::BEGIN, depth, dead});
+        } else if (name == "WHILE") {
+            if (frames.empty() || frames.back().kind != Structure::BEGIN) return unbalanced();
+            apply({1, 0});
+            frames.back().hasWhile = true;
+            frames.back().whileDepth = depth;
+        } else if (name == "UNTIL" || name == "REPEAT" || name == "AGAIN") {
+            if (frames.empty() || frames.back().kind != Structure::BEGIN) return unbalanced();
+            const Frame frame = frames.back();
+            frames.pop_back();
+            if (name == "UNTIL") apply({1, 0});
+            if (!dead && depth != frame.depth) {
+                problem = "the " + name + " loop body changes the stack depth";
+                return {};
+            }
+            if (name == "REPEAT" && frame.hasWhile) {
+                depth = frame.whileDepth;
+                dead = frame.dead;
+            } else if (name == "AGAIN") {
+                // only EXIT leaves BEGIN .. AGAIN
+                dead = true;
+            } else {
+                depth = frame.depth;
+                dead = frame.dead;
+            }
+        } else if (name == "DO") {
+            apply({2, 0});
+            frames.push_back({Structure::DO, depth, dead});
+        } else if (name == "LOOP" || name == "+LOOP") {
+            if (frames.empty() || frames.back().kind != Structure::DO) return unbalanced();
+            const Frame frame = frames.back();
+            frames.pop_back();
+            if (name == "+LOOP") apply({1, 0});
+            if (!dead && depth != frame.depth) {
+                problem = "the DO loop body changes the stack depth";
+                return {};
+            }
+            depth = frame.depth;
+            dead = frame.dead;
+        } else if (name == "EXIT") {
+            if (!dead) {
+                if (exits && depth != exitDepth) {
+                    problem = "EXIT leaves the stack at different depths";
+                    return {};
+                }
+                exits = true;
+                exitDepth = depth;
+            }
+            dead = true;
+        } else {
+            const StackEffect effect = lookup(token);
+            if (!effect.known()) return {};
+            apply(effect);
+            if (parses_name(name)) ++i;
+        }
+    }
+    if (!frames.empty()) return unbalanced();
+
+    if (exits) {
+        if (!dead && depth != exitDepth) {
+            problem = "EXIT and the end of the word leave the stack at different depths";
+            return {};
+        }
+        depth = exitDepth;
+    }
+    return {static_cast<int16_t>(-lowest), static_cast<int16_t>(depth - lowest)};
+}
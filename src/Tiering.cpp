@@ -0,0 +1,69 @@
+#include "Tiering.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include "Compiler.h"
+#include "ForthDictionaryEntry.h"
+#include "JitContext.h"
+
+
+TieredWord *Tiering::add(TieredWord word) {
+    words.push_back(std::move(word));
+    return &words.back();
+}
+
+// runs on the thread that made the word hot, the code generator is idle whenever Forth code runs
+void Tiering::promote(TieredWord *word) {
+    if (Compiler::instance().compiling()) {
+        // ran while another definition compiles, count to HOT_CALLS again
+        word->calls = 0;
+        return;
+    }
+    word->promoted = true;
+    const ForthFunction f = Compiler::instance().recompile(*word);
+    if (!f) return;
+    __atomic_store_n(&word->target, reinterpret_cast<void *>(f), __ATOMIC_RELEASE);
+    if (word->entry) {
+        __atomic_store_n(&word->entry->executable, f, __ATOMIC_RELEASE);
+    }
+}
+
+// tier 0 code holds the address of its record, so only the newest record can go, an older one is marked
+bool Tiering::forget(ForthDictionaryEntry *entry) {
+    const auto it = std::find_if(words.begin(), words.end(),
+                                 [entry](const TieredWord &w) { return !w.forgotten && w.entry == entry; });
+    if (it == words.end()) return false;
+    auto &jit = JitContext::instance();
+    if (entry->executable != it->code) {
+        jit.release(entry->executable);
+    }
+    jit.release(it->code);
+    entry->executable = nullptr;
+    if (it + 1 == words.end()) {
+        words.pop_back();
+    } else {
+        it->forgotten = true;
+        it->entry = nullptr;
+        it->target = nullptr;
+        it->bindings.clear();
+    }
+    return true;
+}
+
+void Tiering::display() const {
+    if (words.empty()) {
+        std::cout << "No tiered words, SET TIERED ON before compiling" << std::endl;
+        return;
+    }
+    std::cout << std::left << std::setw(24) << "word" << std::right
+            << std::setw(14) << "tier 0 calls" << std::setw(6) << "tier" << std::endl;
+    for (const auto &w: words) {
+        if (w.forgotten) continue;
+        const bool recompiled = w.promoted && w.entry && reinterpret_cast<void *>(w.entry->executable) == w.target;
+        std::cout << std::left << std::setw(24) << w.name << std::right
+                << std::setw(14) << w.calls
+                << std::setw(6) << (recompiled ? 1 : 0)
+                << (w.promoted && !recompiled ? "  (not recompiled, a word it uses was redefined)" : "")
+                << std::endl;
+    }
+}
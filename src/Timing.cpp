@@ -0,0 +1,121 @@
+#include "Timing.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+
+
+double cycles_per_ns() {
+    static const double ratio = [] {
+        // 20ms is enough for a ratio good to a few parts in a million
+        const uint64_t ns0 = clock_ns();
+        const uint64_t c0 = cycles_start();
+        uint64_t ns1;
+        do {
+            ns1 = clock_ns();
+        } while (ns1 - ns0 < 20000000);
+        const uint64_t c1 = cycles_end();
+        return static_cast<double>(c1 - c0) / static_cast<double>(ns1 - ns0);
+    }();
+    return ratio;
+}
+
+uint64_t timing_overhead() {
+    static const uint64_t overhead = [] {
+        uint64_t best = UINT64_MAX;
+        for (int i = 0; i < 1000; ++i) {
+            const uint64_t t0 = cycles_start();
+            const uint64_t t1 = cycles_end();
+            best = std::min(best, t1 - t0);
+        }
+        return best;
+    }();
+    return overhead;
+}
+
+// nearest rank, the smallest sample with at least p percent of the samples at or below it
+static double percentile(const std::vector<uint64_t> &sorted, const unsigned p) {
+    const size_t rank = (sorted.size() * p + 99) / 100;
+    return static_cast<double>(sorted[rank > 0 ? rank - 1 : 0]);
+}
+
+TimingSummary summarize_timings(std::vector<uint64_t> &samples) {
+    TimingSummary summary;
+    if (samples.empty()) return summary;
+    std::sort(samples.begin(), samples.end());
+    summary.runs = samples.size();
+    summary.min = static_cast<double>(samples.front());
+    summary.median = percentile(samples, 50);
+    summary.p90 = percentile(samples, 90);
+    summary.p99 = percentile(samples, 99);
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    return summary;
+}
+
+static double counter(const TimingSummary &summary, const char *name) {
+    for (const auto &[counterName, value]: summary.counters) {
+        if (std::strcmp(counterName, name) == 0) return value;
+    }
+    return 0;
+}
+
+static void print_counters(const TimingSummary &summary) {
+    if (summary.counters.empty()) return;
+    std::cout << "per run:" << std::endl;
+    for (const auto &[name, value]: summary.counters) {
+        std::cout << std::setw(16) << name << std::setw(14) << value << std::endl;
+    }
+    const double cycles = counter(summary, "cycles");
+    const double instructions = counter(summary, "instructions");
+    if (cycles > 0 && instructions > 0) {
+        std::cout << std::setw(16) << "IPC" << std::setw(14) << std::setprecision(2) << instructions / cycles
+                << std::setprecision(1) << std::endl;
+    }
+}
+
+void print_timings(const std::string &name, const TimingSummary &summary, const bool json) {
+    const double ratio = cycles_per_ns();
+    const double values[] = {summary.min, summary.median, summary.p90, summary.p99, summary.mean};
+    const char *labels[] = {"min", "median", "p90", "p99", "mean"};
+
+    const auto flags = std::cout.flags();
+    const auto precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1);
+
+    if (json) {
+        std::cout << "{\"word\":\"" << name << "\",\"runs\":" << summary.runs
+                << ",\"warmups\":" << summary.warmups << ",\"bytes\":" << summary.codeBytes << ",\"ns\":{";
+        for (size_t i = 0; i < 5; ++i) {
+            std::cout << (i ? "," : "") << '"' << labels[i] << "\":" << values[i] / ratio;
+        }
+        std::cout << "},\"cycles\":{";
+        for (size_t i = 0; i < 5; ++i) {
+            std::cout << (i ? "," : "") << '"' << labels[i] << "\":" << values[i];
+        }
+        std::cout << "}";
+        if (!summary.counters.empty()) {
+            std::cout << ",\"counters\":{";
+            for (size_t i = 0; i < summary.counters.size(); ++i) {
+                std::cout << (i ? "," : "") << '"' << summary.counters[i].first << "\":" << summary.counters[i].second;
+            }
+            std::cout << "}";
+        }
+        std::cout << "}" << std::endl;
+    } else {
+        std::cout << name << ": " << summary.runs << " runs after " << summary.warmups << " warm-up" << std::endl;
+        std::cout << std::setw(10) << "" << std::setw(12) << "ns/op" << std::setw(12) << "cycles/op" << std::endl;
+        for (size_t i = 0; i < 5; ++i) {
+            std::cout << std::setw(10) << labels[i]
+                    << std::setw(12) << values[i] / ratio
+                    << std::setw(12) << values[i] << std::endl;
+        }
+        if (summary.codeBytes) {
+            std::cout << "Code: " << summary.codeBytes << " bytes" << std::endl;
+        }
+        print_counters(summary);
+    }
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
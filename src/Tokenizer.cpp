@@ -3,31 +3,14 @@
 #include <iostream>
 #include <cctype>
 #include <cstring>
+#include <strings.h>
 #include <cstdlib>
 #include <stdexcept>
 #include <cstdint>
 #include <cassert>
-#include <deque>
 #include <ForthDictionary.h>
 #include "SymbolTable.h"
-
-bool is_number(const std::string &s) {
-    try {
-        std::stoll(s, nullptr, 0);
-        return true;
-    } catch (...) {
-        return false;
-    }
-}
-
-int64_t parseNumber(const std::string &word) {
-    try {
-        return std::stoll(word, nullptr, 0);
-    } catch (...) {
-        throw std::invalid_argument("Invalid number: " + word);
-    }
-}
-
+#include "SignalHandler.h"
 
 void Tokenizer::print_token(const ForthToken &token) {
     switch (token.type) {
@@ -40,6 +23,9 @@ void Tokenizer::print_token(const ForthToken &token) {
         case TOKEN_NUMBER:
             std::cout << "NUMBER:" << '\t' << '[' << token.int_value << "]\n";
             break;
+        case TOKEN_DOUBLE:
+            std::cout << "DOUBLE:" << '\t' << '[' << static_cast<int64_t>(token.int_value) << ".]\n";
+            break;
         case TOKEN_FLOAT:
             std::cout << "FLOAT: " << '\t' << '[' << token.float_value << "]\n";
             break;
@@ -57,10 +43,10 @@ void Tokenizer::print_token(const ForthToken &token) {
             break;
         case TOKEN_OPTIMIZED:
             std::cout << "OPTIMIZED:";
-            std::cout << token.optimized_op;
+            std::cout << opt_op_name(token.op);
             std::cout << " with constant:" << '[' << token.int_value << "] "
                     << "id: [" << token.word_id << "] "
-                    << "len: [" << token.word_len << "] " << std::endl;
+                    << "value: [" << token.value << "] " << std::endl;
 
             break;
 
@@ -70,7 +56,7 @@ void Tokenizer::print_token(const ForthToken &token) {
     }
 }
 
-void Tokenizer::print_token_list(const std::deque<ForthToken> &tokens) {
+void Tokenizer::print_token_list(const TokenStream &tokens) {
     int count = 0;
     for (const auto &token: tokens) {
         std::cout << "[" << count++ << "] - ";
@@ -87,42 +73,184 @@ void skip_whitespace(const char **input) {
 }
 
 
-int is_float(const char *str) {
-    int has_dot = 0, has_exp = 0;
-    int seen_digit_before_exp = 0, seen_digit_after_exp = 0;
+// value of a digit in any base up to 36, or 99 for anything else
+static int digit_value(const char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'z') return c - 'a' + 10;
+    return 99;
+}
 
-    // Handle optional leading sign
-    if (*str == '-' || *str == '+') {
-        str++;
-    }
+static bool radix_prefix(const char c) {
+    return c == '#' || c == '$' || c == '%' || c == '0';
+}
 
-    while (*str) {
-        if (*str == '.') {
-            if (has_dot || has_exp) {
-                return 0; // Invalid: more than one dot or dot after exponent
-            }
-            has_dot = 1;
-        } else if (*str == 'e' || *str == 'E') {
-            if (has_exp || !seen_digit_before_exp) {
-                return 0; // Invalid: more than one exponent or no digits before exponent
-            }
-            has_exp = 1;
-        } else if (*str == '-' || *str == '+') {
-            if (*(str - 1) != 'e' && *(str - 1) != 'E') {
-                return 0; // Invalid: sign not immediately after exponent
-            }
-        } else if (isdigit(*str)) {
-            if (has_exp) {
-                seen_digit_after_exp = 1; // Keeping track of digits after 'e/E'
-            } else {
-                seen_digit_before_exp = 1; // Keeping track of digits before 'e/E'
-            }
+// a decimal float such as 1.5, -2e10 or 3.25E-3, there must be a . or an exponent
+static bool parse_float(const std::string_view text, double &result) {
+    size_t i = (text[0] == '-' || text[0] == '+') ? 1 : 0;
+    size_t mantissa_digits = 0, exponent_digits = 0;
+    bool dot = false, exponent = false;
+
+    for (; i < text.size(); ++i) {
+        const char c = text[i];
+        if (c >= '0' && c <= '9') {
+            (exponent ? exponent_digits : mantissa_digits)++;
+        } else if (c == '.' && !dot && !exponent) {
+            dot = true;
+        } else if ((c == 'e' || c == 'E') && !exponent && mantissa_digits) {
+            exponent = true;
+            if (i + 1 < text.size() && (text[i + 1] == '-' || text[i + 1] == '+')) ++i;
         } else {
-            return 0; // Invalid character
+            return false;
+        }
+    }
+    if (!mantissa_digits || (exponent && !exponent_digits) || (!dot && !exponent)) return false;
+
+    // strtod wants a terminated string, numbers are short
+    char buffer[64];
+    if (text.size() >= sizeof(buffer)) return false;
+    std::memcpy(buffer, text.data(), text.size());
+    buffer[text.size()] = '\0';
+    result = std::strtod(buffer, nullptr);
+    return true;
+}
+
+// value = value * radix + digit, false when it no longer fits in a cell
+static bool accumulate(uint64_t &value, const uint64_t radix, const uint64_t digit) {
+    return !__builtin_mul_overflow(value, radix, &value) && !__builtin_add_overflow(value, digit, &value);
+}
+
+static void out_of_range(const std::string_view text) {
+    std::cerr << "Number out of range: " << text << std::endl;
+    SignalHandler::instance().raise(30);
+}
+
+// Classify and convert a token in one pass, without exceptions.
+// Integers use BASE unless they start with # $ % or 0x, 'c' is a character,
+// a trailing . makes a double cell integer, and floats are only read in decimal.
+// An integer too large for a cell is an error rather than wrapping round.
+static TokenType parse_number(const std::string_view text, const int64_t base, ForthToken &token) {
+    const size_t n = text.size();
+    if (n == 0) return TOKEN_UNKNOWN;
+
+    // fast path, plain decimal integers
+    if (base == 10) {
+        size_t i = text[0] == '-' ? 1 : 0;
+        uint64_t value = 0;
+        bool fits = true;
+        while (i < n && text[i] >= '0' && text[i] <= '9') {
+            fits = accumulate(value, 10, static_cast<uint64_t>(text[i++] - '0')) && fits;
+        }
+        if (i == n && n > (text[0] == '-' ? 1u : 0u)) {
+            if (!fits) out_of_range(text);
+            token.int_value = text[0] == '-' ? 0 - value : value;
+            return TOKEN_NUMBER;
+        }
+    }
+
+    if (n == 3 && text[0] == '\'' && text[2] == '\'') {
+        token.int_value = static_cast<unsigned char>(text[1]);
+        return TOKEN_NUMBER;
+    }
+
+    size_t i = 0;
+    bool negative = false;
+    int64_t radix = base;
+    if (text[i] == '-' || text[i] == '+') {
+        negative = text[i++] == '-';
+    }
+    if (i < n) {
+        switch (text[i]) {
+            case '#': radix = 10; ++i; break;
+            case '$': radix = 16; ++i; break;
+            case '%': radix = 2; ++i; break;
+            case '0':
+                if (i + 2 < n && (text[i + 1] == 'x' || text[i + 1] == 'X')) {
+                    radix = 16;
+                    i += 2;
+                }
+                break;
+            default: break;
+        }
+    }
+    // the sign may also follow the prefix, e.g. $-FF
+    if (!negative && radix_prefix(text[0]) && i < n && text[i] == '-') {
+        negative = true;
+        ++i;
+    }
+    if (radix < 2 || radix > 36) return TOKEN_UNKNOWN;
+
+    const size_t first_digit = i;
+    uint64_t value = 0;
+    bool fits = true;
+    for (; i < n; ++i) {
+        const int digit = digit_value(text[i]);
+        if (digit >= radix) break;
+        fits = accumulate(value, static_cast<uint64_t>(radix), static_cast<uint64_t>(digit)) && fits;
+    }
+
+    if (i > first_digit) {
+        if (!fits && (i == n || (i == n - 1 && text[i] == '.'))) out_of_range(text);
+        if (i == n) {
+            token.int_value = negative ? 0 - value : value;
+            return TOKEN_NUMBER;
+        }
+        if (i == n - 1 && text[i] == '.') {
+            token.int_value = negative ? 0 - value : value;
+            return TOKEN_DOUBLE;
+        }
+    }
+
+    if (base == 10 && parse_float(text, token.float_value)) {
+        return TOKEN_FLOAT;
+    }
+    return TOKEN_UNKNOWN;
+}
+
+void Tokenizer::classify_number(ForthToken &token, const int64_t base) {
+    token.int_value = 0;
+    token.type = parse_number(token.value, base, token);
+}
+
+int64_t Tokenizer::current_base() {
+    const auto base_word = ForthDictionary::instance().findWord("BASE");
+    baseAddress = base_word ? static_cast<int64_t *>(base_word->data) : nullptr;
+    return baseAddress ? *baseAddress : 10;
+}
+
+// the token after : CREATE VARIABLE or DEFER is a new name, even when it reads as a number, e.g. : FACE in HEX
+static bool names_new_word(const ForthToken &previous) {
+    if (previous.type == TOKEN_COMPILING) return true;
+    if (previous.type != TOKEN_WORD) return false;
+    for (const std::string_view word: {"CREATE", "VARIABLE", "DEFER"}) {
+        if (previous.value.size() == word.size() &&
+            strncasecmp(previous.value.data(), word.data(), word.size()) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Tokenizer::rebase(TokenStream &tokens) {
+    const int64_t base = baseAddress ? *baseAddress : 10;
+    if (base == tokens.base) return;
+    tokens.base = base;
+    const ForthToken *previous = nullptr;
+    for (auto &token: tokens) {
+        const bool name = previous && names_new_word(*previous);
+        previous = &token;
+        if (name) continue;
+        switch (token.type) {
+            case TOKEN_NUMBER:
+            case TOKEN_DOUBLE:
+            case TOKEN_FLOAT:
+            case TOKEN_UNKNOWN:
+                classify_number(token, base);
+                break;
+            default:
+                break;
         }
-        str++;
     }
-    return (has_dot || has_exp) && seen_digit_before_exp && (!has_exp || seen_digit_after_exp);
 }
 
 
@@ -137,73 +265,56 @@ ForthToken Tokenizer::get_next_token(const char **input) {
         return token;
     }
 
-    int i = 0;
-    char temp[MAX_TOKEN_LENGTH] = {0};
-
-    // 🔥 Improved token parsing: Allow words to end in `"`, but not start with it
-    while (**input && !isspace(**input) && i < MAX_TOKEN_LENGTH - 1) {
-        char c = *(*input)++;
+    // the token is a view of the source, nothing is copied
+    const char *start = *input;
+    while (**input && !isspace(**input)) {
+        const char c = *(*input)++;
 
         // Allow `"` **only at the end of a word**
-        if (c == '"' && i > 0) {
-            temp[i++] = c;
+        if (c == '"' && *input - start > 1) {
             break; // Stop here if we found a `"` at the end
         }
-
-        temp[i++] = c;
     }
-    temp[i] = '\0';
+    const std::string_view text(start, *input - start);
+    token.value = text;
 
     // 🔍 Check if the token is a word ending in `"`, like `S"` or `."`
-    if (i > 1 && temp[i - 1] == '"') {
+    if (text.size() > 1 && text.back() == '"') {
         token.type = TOKEN_WORD;
-        token.value = temp; // Store the full word (e.g., `."`, `S"`)
-        token.word_len = strlen(temp);
-        token.word_id = SymbolTable::instance().addSymbol(temp);
+        token.word_id = SymbolTable::instance().addSymbol(text);
         return token;
     }
 
     // ✅ Regular word lookup
-    if (auto word_id = SymbolTable::instance().definedSymbol(temp); word_id != 0) {
+    if (auto word_id = SymbolTable::instance().definedSymbol(text); word_id != 0) {
         token.type = TOKEN_WORD;
-        token.value = temp;
         token.word_id = word_id;
-        token.word_len = strlen(temp);
-        if (const auto &dict = ForthDictionary::instance(); dict.isVariable(temp)) {
+        if (const auto &dict = ForthDictionary::instance(); dict.isVariable(text)) {
             token.type = TOKEN_VARIABLE;
         }
         return token;
     }
 
     // ✅ Other token types (numbers, comments, special symbols)
-    if (strcmp(temp, ":") == 0) {
+    if (text == ":") {
         token.type = TOKEN_COMPILING;
-    } else if (strcmp(temp, ";") == 0) {
+    } else if (text == ";") {
         token.type = TOKEN_INTERPRETING;
-    } else if (strcmp(temp, "(") == 0) {
+    } else if (text == "(") {
         token.type = TOKEN_BEGINCOMMENT;
         inComment = true;
-    } else if (strcmp(temp, ")") == 0) {
+    } else if (text == ")") {
         token.type = TOKEN_ENDCOMMENT;
         inComment = false;
-    } else if (strcmp(temp, "{") == 0) {
+    } else if (text == "{") {
         token.type = TOKEN_BEGINLOCALS;
-        token.value = temp;
-    } else if (strcmp(temp, "}") == 0) {
+    } else if (text == "}") {
         token.type = TOKEN_ENDLOCALS;
-    } else if (is_float(temp)) {
-        token.type = TOKEN_FLOAT;
-        token.float_value = atof(temp);
-    } else if (is_number(temp)) {
-        token.type = TOKEN_NUMBER;
-        token.int_value = parseNumber(temp);
-    } else {
-        // and unknown word may be swallowed by CREATE, VARIABLE, CONSTANT etc
+    } else if (nameNext) {
         token.type = TOKEN_UNKNOWN;
-        token.value = temp;
-
-        //std::cerr << "Error: Unknown token: " << temp << std::endl;
-        //raise_c(5);
+    } else {
+        // an unknown word may be swallowed by CREATE, VARIABLE, CONSTANT etc
+        classify_number(token, base);
     }
 
     return token;
@@ -212,7 +323,6 @@ ForthToken Tokenizer::get_next_token(const char **input) {
 ForthToken get_string_token(const char **input) {
     ForthToken token;
     token.type = TOKEN_STRING;
-    token.value = ""; // Initialize value as empty string
 
     if (**input == '\0') return token; // 🚨 Prevent buffer overrun
 
@@ -224,10 +334,12 @@ ForthToken get_string_token(const char **input) {
     }
 
     // 🚨 Prevent infinite loops and buffer overruns
+    const char *start = *input;
     int max_length = MAX_INPUT; // Avoid unbounded loops
     while (**input && **input != '"' && max_length-- > 0) {
-        token.value += *(*input)++;
+        (*input)++;
     }
+    token.value = std::string_view(start, *input - start);
 
     // 🚨 Avoid dereferencing null pointers
     if (**input == '"') {
@@ -240,12 +352,16 @@ ForthToken get_string_token(const char **input) {
 }
 
 
-int Tokenizer::tokenize_forth(const std::string &input, std::deque<ForthToken> &tokens) {
+int Tokenizer::tokenize_forth(const std::string &input, TokenStream &tokens) {
     const char *cursor = input.c_str(); // Pointer for traversing input
-    tokens.clear(); // Clear any pre-existing tokens
+    tokens.clear(); // Clear any pre-existing tokens, keeping their storage
+    base = current_base();
+    tokens.base = base;
+    nameNext = false;
 
     while (true) {
         ForthToken token = instance().get_next_token(&cursor); // Get the next token
+        nameNext = names_new_word(token);
 
         // Stop at end of input
         if (token.type == TOKEN_END) {
@@ -256,8 +372,7 @@ int Tokenizer::tokenize_forth(const std::string &input, std::deque<ForthToken> &
         // 🔥 General case: Any word ending in `"` should collect a string
         if (token.type == TOKEN_WORD && !token.value.empty() && token.value.back() == '"') {
             tokens.push_back(token); // Push the Forth word (e.g., `S"`, `."`)
-            ForthToken string_token = get_string_token(&cursor); // Get the string
-            tokens.push_back(string_token); // Push the string as a separate token
+            tokens.push_back(get_string_token(&cursor)); // Push the string as a separate token
         } else {
             tokens.push_back(token); // Push regular tokens
         }
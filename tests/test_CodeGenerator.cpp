@@ -2,6 +2,25 @@
 #include "CodeGenerator.h"
 #include "JitContext.h"
 #include "ForthDictionary.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include "OutputBuffer.h"
+#include "FloatFormat.h"
+#include "ScriptRunner.h"
+#include "Interpreter.h"
+#include "Timing.h"
+#include "CallCounters.h"
+#include "CompileStats.h"
+#include "Tiering.h"
+#include "StackEffect.h"
+#include "DivMagic.h"
+#include "Tokenizer.h"
+#include "Settings.h"
+#include "SignalHandler.h"
+#include "DeferredWords.h"
+#include "CodeIndex.h"
 
 // Forward declarations for cpush and cpop stack helpers
 extern void cpush(int64_t value);
@@ -366,6 +385,761 @@ TEST(FloatingPointOperations, TestSquareRoot) {
 
 
 
+TEST(Primitives, TestBuiltWordsAreNamed) {
+    code_generator_initialize();
+
+    // Assert, the code of each primitive carries its own name, not the one added before it
+    for (const char *name: {"2RDROP", "RDROP", ">R"}) {
+        const ForthDictionaryEntry *entry = ForthDictionary::instance().findWord(name);
+        ASSERT_NE(entry, nullptr) << name;
+        const auto *range = CodeIndex::instance().find(reinterpret_cast<uintptr_t>(entry->executable));
+        ASSERT_NE(range, nullptr) << name;
+        EXPECT_EQ(range->name, name);
+    }
+}
+
+TEST(Primitives, TestForgetRemovesCodeIndex) {
+    code_generator_initialize();
+
+    // Arrange
+    Interpreter::instance().execute(": INDEX-GONE 1 2 + ;");
+    const auto code = reinterpret_cast<uintptr_t>(ForthDictionary::instance().findWord("INDEX-GONE")->executable);
+    ASSERT_NE(CodeIndex::instance().find(code), nullptr);
+    const size_t ranges = CodeIndex::instance().size();
+
+    // Act
+    Interpreter::instance().execute("FORGET");
+
+    // Assert, the addresses are free for the next word
+    EXPECT_EQ(CodeIndex::instance().find(code), nullptr);
+    EXPECT_EQ(CodeIndex::instance().size(), ranges - 1);
+}
+
+TEST(Primitives, TestForgetRemovesListing) {
+    code_generator_initialize();
+
+    // Arrange
+    keepListing = true;
+    Interpreter::instance().execute(": LISTING-GONE 3 4 * ;");
+    keepListing = false;
+    const void *code = reinterpret_cast<const void *>(ForthDictionary::instance().findWord("LISTING-GONE")->executable);
+    ASSERT_NE(CodeListing::instance().find(code), nullptr);
+
+    // Act
+    Interpreter::instance().execute("FORGET");
+
+    // Assert
+    EXPECT_EQ(CodeListing::instance().find(code), nullptr);
+}
+
+TEST(MemoryMappedFiles, TestMapFile) {
+    code_generator_initialize();
+
+    // Arrange
+    const std::string path = "/tmp/forthjit_map_test.txt";
+    FILE *f = fopen(path.c_str(), "w");
+    ASSERT_NE(f, nullptr);
+    fputs("MacForth", f);
+    fclose(f);
+    cpush(reinterpret_cast<int64_t>(path.c_str()));
+    cpush(static_cast<int64_t>(path.size()));
+
+    // Act
+    ForthDictionary::instance().execWord("MAP-FILE");
+
+    // Assert
+    int64_t len = cpop();
+    auto addr = reinterpret_cast<const char *>(cpop());
+    EXPECT_EQ(len, 8);
+    EXPECT_EQ(std::string(addr, len), "MacForth");
+    ASSERT_NE(WordHeap::instance().findMapping(addr, len), nullptr);
+
+    cpush(reinterpret_cast<int64_t>(addr));
+    cpush(len);
+    ForthDictionary::instance().execWord("UNMAP-FILE");
+    EXPECT_EQ(WordHeap::instance().findMapping(addr, len), nullptr);
+    std::remove(path.c_str());
+}
+
+TEST(MemoryMappedFiles, TestMapFileTwice) {
+    code_generator_initialize();
+
+    // Arrange
+    const std::string path = "/tmp/forthjit_map_twice.txt";
+    FILE *f = fopen(path.c_str(), "w");
+    ASSERT_NE(f, nullptr);
+    fputs("MacForth", f);
+    fclose(f);
+
+    // Act, the second mapping of the file leaves the first in place
+    size_t firstLen = 0;
+    size_t secondLen = 0;
+    const auto *first = static_cast<const char *>(WordHeap::instance().mapFile(path, firstLen, false));
+    const auto *second = static_cast<const char *>(WordHeap::instance().mapFile(path, secondLen, false));
+
+    // Assert
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(first, second);
+    EXPECT_NE(WordHeap::instance().findMapping(first, firstLen), nullptr);
+    EXPECT_TRUE(WordHeap::instance().unmapFile(second));
+    EXPECT_EQ(std::string(first, firstLen), "MacForth");
+    EXPECT_TRUE(WordHeap::instance().unmapFile(first));
+    EXPECT_FALSE(WordHeap::instance().unmapFile(first));
+    std::remove(path.c_str());
+}
+
+TEST(OutputBuffering, TestTypeAndEmit) {
+    code_generator_initialize();
+    auto &out = OutputBuffer::instance();
+    out.flush();
+    out.setLineFlush(false);
+
+    // Arrange
+    const char *text = "MacForth";
+    cpush(reinterpret_cast<int64_t>(text));
+    cpush(8);
+
+    // Act
+    ForthDictionary::instance().execWord("TYPE");
+    cpush('!');
+    ForthDictionary::instance().execWord("EMIT");
+
+    // Assert
+    EXPECT_EQ(std::string(out.buffer, out.pos), "MacForth!");
+    ForthDictionary::instance().execWord("FLUSH");
+    EXPECT_EQ(out.pos, 0u);
+
+    // reports written with std::cout stay in order with EMIT
+    cpush('<');
+    ForthDictionary::instance().execWord("EMIT");
+    std::cout << "report";
+    cpush('>');
+    ForthDictionary::instance().execWord("EMIT");
+    EXPECT_EQ(std::string(out.buffer, out.pos), "<report>");
+    out.flush();
+}
+
+TEST(FloatingPointOperations, TestFDotShortest) {
+    code_generator_initialize();
+    auto &out = OutputBuffer::instance();
+    out.flush();
+    out.setLineFlush(false);
+
+    // Act
+    cfpush(0.1);
+    ForthDictionary::instance().execWord("F.");
+    cfpush(1500.0);
+    ForthDictionary::instance().execWord("FS.");
+    cfpush(0.015);
+    ForthDictionary::instance().execWord("FE.");
+
+    // Assert
+    EXPECT_EQ(std::string(out.buffer, out.pos), "0.1 1.5E3 15E-3 ");
+    out.flush();
+
+    // every double reads back exactly
+    char text[FLOAT_TEXT_MAX + 1];
+    for (const double f: {3.14, -2.5e-300, 1.7976931348623157e308, 5e-324, 123456789012345678.0}) {
+        const size_t len = format_float(f, FloatStyle::GENERAL, 0, text);
+        text[len] = '\0';
+        EXPECT_EQ(std::strtod(text, nullptr), f) << text;
+    }
+    // 2.675 is stored as 2.67499999.. so it rounds down, 0.125 is exact and rounds to even
+    EXPECT_EQ(std::string(text, format_float(2.675, FloatStyle::GENERAL, 3, text)), "2.67");
+    EXPECT_EQ(std::string(text, format_float(2.665, FloatStyle::GENERAL, 3, text)), "2.67");
+    EXPECT_EQ(std::string(text, format_float(9.9996, FloatStyle::GENERAL, 4, text)), "10");
+}
+
+TEST(OutputBuffering, TestNumberOutput) {
+    code_generator_initialize();
+    auto &out = OutputBuffer::instance();
+    out.flush();
+    out.setLineFlush(false);
+    auto &dict = ForthDictionary::instance();
+
+    // Act
+    cpush(-1234567);
+    dict.execWord(".");
+    cpush(-1);
+    dict.execWord("U.");
+    cpush(0);
+    cpush(1);
+    dict.execWord("D.");
+    cpush(255);
+    dict.execWord("HEX");
+    dict.execWord(".");
+    dict.execWord("DECIMAL");
+
+    // Assert
+    EXPECT_EQ(std::string(out.buffer, out.pos), "-1234567 18446744073709551615 18446744073709551616 FF ");
+    out.flush();
+
+    // <# # # [CHAR] . HOLD #S #> prints 1234 as 12.34
+    cpush(1234);
+    cpush(0);
+    dict.execWord("<#");
+    dict.execWord("#");
+    dict.execWord("#");
+    cpush('.');
+    dict.execWord("HOLD");
+    dict.execWord("#S");
+    dict.execWord("#>");
+    const auto len = cpop();
+    const auto *text = reinterpret_cast<const char *>(cpop());
+    EXPECT_EQ(std::string(text, static_cast<size_t>(len)), "12.34");
+}
+
+TEST(FileWords, TestReadWriteAsync) {
+    code_generator_initialize();
+    auto &dict = ForthDictionary::instance();
+    const std::string path = "/tmp/forthjit_file_test.txt";
+
+    // Arrange
+    cpush(reinterpret_cast<int64_t>(path.data()));
+    cpush(static_cast<int64_t>(path.size()));
+    dict.execWord("W/O");
+    dict.execWord("CREATE-FILE");
+    EXPECT_EQ(cpop(), 0);
+    const int64_t out = cpop();
+    const char text[] = "first second";
+    cpush(reinterpret_cast<int64_t>(text));
+    cpush(12);
+    cpush(out);
+    dict.execWord("WRITE-FILE");
+    EXPECT_EQ(cpop(), 0);
+    cpush(out);
+    dict.execWord("CLOSE-FILE");
+    EXPECT_EQ(cpop(), 0);
+
+    cpush(reinterpret_cast<int64_t>(path.data()));
+    cpush(static_cast<int64_t>(path.size()));
+    dict.execWord("R/O");
+    dict.execWord("OPEN-FILE");
+    EXPECT_EQ(cpop(), 0);
+    const int64_t in = cpop();
+
+    // Act
+    char first[6];
+    char second[7];
+    cpush(reinterpret_cast<int64_t>(first));
+    cpush(6);
+    cpush(in);
+    dict.execWord("READ-FILE-ASYNC");
+    const int64_t request = cpop();
+    cpush(reinterpret_cast<int64_t>(second));
+    cpush(7);
+    cpush(in);
+    dict.execWord("READ-FILE");
+    EXPECT_EQ(cpop(), 0);
+    EXPECT_EQ(cpop(), 6);
+    cpush(request);
+    dict.execWord("AWAIT");
+    EXPECT_EQ(cpop(), 6);
+
+    // Assert
+    EXPECT_EQ(std::string(first, 6), "first ");
+    EXPECT_EQ(std::string(second, 6), "second");
+    cpush(in);
+    dict.execWord("FILE-SIZE");
+    EXPECT_EQ(cpop(), 0);
+    EXPECT_EQ(cpop(), 0);
+    EXPECT_EQ(cpop(), 12);
+
+    // a read still pending at CLOSE-FILE finishes or is cancelled first, at the end of the file it reads nothing
+    char rest[4];
+    cpush(reinterpret_cast<int64_t>(rest));
+    cpush(4);
+    cpush(in);
+    dict.execWord("READ-FILE-ASYNC");
+    const int64_t pending = cpop();
+    cpush(in);
+    dict.execWord("CLOSE-FILE");
+    EXPECT_EQ(cpop(), 0);
+    cpush(pending);
+    dict.execWord("AWAIT");
+    const int64_t n = cpop();
+    EXPECT_TRUE(n == 0 || n == -ECANCELED) << n;
+    std::remove(path.c_str());
+}
+
+TEST(BlockWords, TestBlockUpdateSave) {
+    code_generator_initialize();
+    auto &dict = ForthDictionary::instance();
+    const std::string path = "/tmp/forthjit_block_test.fb";
+    std::remove(path.c_str());
+
+    // Arrange
+    cpush(reinterpret_cast<int64_t>(path.data()));
+    cpush(static_cast<int64_t>(path.size()));
+    dict.execWord("OPEN-BLOCKS");
+    cpush(2);
+    cpush(1024);
+    dict.execWord("BLOCK-BUFFERS");
+
+    // Act, three blocks through two buffers
+    for (int n = 0; n < 3; ++n) {
+        cpush(n);
+        dict.execWord("BLOCK");
+        auto *addr = reinterpret_cast<char *>(cpop());
+        EXPECT_EQ(addr[0], ' ');
+        std::memset(addr, 'A' + n, 1024);
+        dict.execWord("UPDATE");
+    }
+    dict.execWord("SAVE-BUFFERS");
+    dict.execWord("EMPTY-BUFFERS");
+
+    // Assert
+    cpush(1);
+    dict.execWord("BLOCK");
+    const auto *addr = reinterpret_cast<const char *>(cpop());
+    EXPECT_EQ(addr[0], 'B');
+    EXPECT_EQ(addr[1023], 'B');
+    FILE *f = fopen(path.c_str(), "r");
+    ASSERT_NE(f, nullptr);
+    fseek(f, 0, SEEK_END);
+    EXPECT_EQ(ftell(f), 3 * 1024);
+    fclose(f);
+    std::remove(path.c_str());
+}
+
+TEST(BlockWords, TestBlockOutOfRange) {
+    code_generator_initialize();
+    auto &dict = ForthDictionary::instance();
+    const std::string path = "/tmp/forthjit_block_range.fb";
+    std::remove(path.c_str());
+    cpush(reinterpret_cast<int64_t>(path.data()));
+    cpush(static_cast<int64_t>(path.size()));
+    dict.execWord("OPEN-BLOCKS");
+
+    // Act, -1 is the block number no buffer holds, the other ends past the largest file offset
+    for (const int64_t n: {INT64_C(-1), INT64_MAX / 1024}) {
+        volatile bool raised = true;
+        if (setjmp(SignalHandler::instance().get_jump_buffer()) == 0) {
+            cpush(n);
+            dict.execWord("BLOCK");
+            raised = false;
+        }
+
+        // Assert
+        EXPECT_TRUE(raised) << n;
+    }
+    cpush(0);
+    dict.execWord("BLOCK");
+    EXPECT_EQ(reinterpret_cast<const char *>(cpop())[0], ' ');
+    std::remove(path.c_str());
+}
+
+TEST(Timing, TestTimeitRestoresStack) {
+    code_generator_initialize();
+
+    // Act, each run adds 2 and 3, not the result of the run before
+    Interpreter::instance().execute("2 3 50 TIMEIT +");
+
+    // Assert
+    EXPECT_EQ(cpop(), 5);
+
+    std::vector<uint64_t> samples = {50, 10, 40, 20, 30};
+    const TimingSummary summary = summarize_timings(samples);
+    EXPECT_EQ(summary.runs, 5u);
+    EXPECT_EQ(summary.min, 10.0);
+    EXPECT_EQ(summary.median, 30.0);
+    EXPECT_EQ(summary.p90, 50.0);
+    EXPECT_EQ(summary.p99, 50.0);
+    EXPECT_EQ(summary.mean, 30.0);
+
+    std::vector<uint64_t> hundred(100);
+    std::iota(hundred.begin(), hundred.end(), 1);
+    const TimingSummary ranks = summarize_timings(hundred);
+    EXPECT_EQ(ranks.median, 50.0);
+    EXPECT_EQ(ranks.p90, 90.0);
+    EXPECT_EQ(ranks.p99, 99.0);
+}
+
+TEST(Timing, TestCallCounters) {
+    code_generator_initialize();
+
+    // Arrange
+    callCounters = true;
+    Interpreter::instance().execute(": COUNTED-TEST 1 + ;");
+    callCounters = false;
+
+    // Act
+    Interpreter::instance().execute("5 COUNTED-TEST COUNTED-TEST");
+
+    // Assert
+    EXPECT_EQ(cpop(), 7);
+    const WordStats *stats = CallCounters::instance().find("COUNTED-TEST");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->calls, 2u);
+    EXPECT_EQ(stats->depth, 0u);
+    EXPECT_GE(stats->stackHigh, 8u);
+}
+
+TEST(CompilerStats, TestDefinitionRecorded) {
+    code_generator_initialize();
+
+    // Arrange
+    const bool wasOptimizing = optimizer;
+    optimizer = true;
+
+    // Act
+    Interpreter::instance().execute(": STATS-TEST 10 + DUP SWAP DROP FACT ;");
+    optimizer = wasOptimizing;
+
+    // Assert
+    const CompileStats *stats = CompilerStats::instance().find("STATS-TEST");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(ForthDictionary::instance().findWord("STATS-TEST")->compileStats, stats);
+    EXPECT_EQ(stats->rules[static_cast<size_t>(OptOp::ADD_IMM)], 1u);
+    EXPECT_EQ(stats->rules[static_cast<size_t>(OptOp::MOV_TOS_1)], 1u);
+    EXPECT_GE(stats->calls, 1u);
+    EXPECT_GE(stats->inlined, 1u);
+    EXPECT_GT(stats->codeBytes, 0u);
+}
+
+TEST(Tiering, TestHotWordRecompiled) {
+    code_generator_initialize();
+
+    // Arrange
+    tieredCompilation = true;
+    Interpreter::instance().execute(": TIER-TEST 10 + DUP SWAP DROP ;");
+    tieredCompilation = false;
+    Interpreter::instance().execute(": TIER-LOOP 0 DO TIER-TEST LOOP ;");
+    const auto *entry = ForthDictionary::instance().findWord("TIER-TEST");
+    ASSERT_NE(entry, nullptr);
+    const ForthFunction tier0 = entry->executable;
+
+    // Act
+    cpush(0);
+    cpush(static_cast<int64_t>(Tiering::HOT_CALLS - 1));
+    Interpreter::instance().execute("TIER-LOOP");
+    const ForthFunction beforeHot = entry->executable;
+    Interpreter::instance().execute("TIER-TEST 1 TIER-LOOP");
+
+    // Assert, callers compiled against tier 0 get the same answers from tier 1
+    EXPECT_EQ(cpop(), static_cast<int64_t>(Tiering::HOT_CALLS + 1) * 10);
+    EXPECT_EQ(beforeHot, tier0);
+    EXPECT_NE(entry->executable, tier0);
+    Interpreter::instance().execute("5 TIER-TEST");
+    EXPECT_EQ(cpop(), 15);
+}
+
+TEST(Tiering, TestForgetReleasesBothTiers) {
+    code_generator_initialize();
+
+    // Arrange, a tiered word made hot so it has tier 0 and tier 1 code
+    tieredCompilation = true;
+    Interpreter::instance().execute(": TIER-GONE 1 + ;");
+    tieredCompilation = false;
+    auto *entry = ForthDictionary::instance().findWord("TIER-GONE");
+    ASSERT_NE(entry, nullptr);
+    const auto tier0 = reinterpret_cast<uintptr_t>(entry->executable);
+    Interpreter::instance().execute(": TIER-GONE-LOOP 0 DO 0 TIER-GONE DROP LOOP ;");
+    cpush(static_cast<int64_t>(Tiering::HOT_CALLS + 1));
+    Interpreter::instance().execute("TIER-GONE-LOOP");
+    const auto tier1 = reinterpret_cast<uintptr_t>(entry->executable);
+    ASSERT_NE(tier1, tier0);
+
+    // Act
+    Interpreter::instance().execute("FORGET");
+    Interpreter::instance().execute("FORGET");
+
+    // Assert, no code is left for either tier and SHOW TIERS no longer reads the entry
+    EXPECT_EQ(CodeIndex::instance().find(tier0), nullptr);
+    EXPECT_EQ(CodeIndex::instance().find(tier1), nullptr);
+    EXPECT_EQ(ForthDictionary::instance().findWord("TIER-GONE"), nullptr);
+    Interpreter::instance().execute("SHOW TIERS");
+}
+
+TEST(StackEffect, TestInferredEffects) {
+    code_generator_initialize();
+
+    // Act
+    Interpreter::instance().execute(": EFFECT-TEST OVER + SWAP DROP ;");
+    Interpreter::instance().execute(": EFFECT-ABS DUP 0 < IF NEGATE THEN ;");
+    Interpreter::instance().execute(": EFFECT-SUM 0 SWAP 0 DO I + LOOP ;");
+    Interpreter::instance().execute(": EFFECT-CALL 1 EFFECT-TEST EFFECT-ABS ;");
+
+    // Assert
+    const auto &dict = ForthDictionary::instance();
+    EXPECT_EQ(dict.findWord("EFFECT-TEST")->effect, (StackEffect{2, 1}));
+    EXPECT_EQ(dict.findWord("EFFECT-ABS")->effect, (StackEffect{1, 1}));
+    EXPECT_EQ(dict.findWord("EFFECT-SUM")->effect, (StackEffect{1, 1}));
+    EXPECT_EQ(dict.findWord("EFFECT-CALL")->effect, (StackEffect{1, 1}));
+    EXPECT_EQ(dict.findWord("EFFECT-CALL")->effect.text(), "( 1 -- 1 )");
+}
+
+TEST(StackEffect, TestUnbalancedBranches) {
+    code_generator_initialize();
+
+    // Arrange
+    TokenStream tokens;
+    Tokenizer::instance().tokenize_forth(": EFFECT-BAD IF 1 ELSE 1 2 THEN ;", tokens);
+    std::string problem;
+
+    // Act
+    const StackEffect effect = StackEffects::instance().infer(tokens, problem);
+
+    // Assert
+    EXPECT_FALSE(effect.known());
+    EXPECT_FALSE(problem.empty());
+}
+
+TEST(Optimizer, TestStackShuffles) {
+    code_generator_initialize();
+
+    // Arrange
+    const bool wasOptimizing = optimizer;
+    optimizer = true;
+    auto &interpreter = Interpreter::instance();
+    interpreter.execute(": SHUFFLE-DUP-ROT DUP ROT ;");
+    interpreter.execute(": SHUFFLE-OVER-DROP OVER DROP ;");
+    interpreter.execute(": SHUFFLE-SWAP-DROP SWAP DROP ;");
+    optimizer = wasOptimizing;
+
+    // Act and Assert, 99 shows nothing extra was left or taken
+    interpreter.execute("99 1 2 SHUFFLE-DUP-ROT");
+    EXPECT_EQ(cpop(), 1);
+    EXPECT_EQ(cpop(), 2);
+    EXPECT_EQ(cpop(), 2);
+    EXPECT_EQ(cpop(), 99);
+    interpreter.execute("99 1 2 SHUFFLE-OVER-DROP");
+    EXPECT_EQ(cpop(), 2);
+    EXPECT_EQ(cpop(), 1);
+    EXPECT_EQ(cpop(), 99);
+    interpreter.execute("99 1 2 SHUFFLE-SWAP-DROP");
+    EXPECT_EQ(cpop(), 2);
+    EXPECT_EQ(cpop(), 99);
+}
+
+TEST(Optimizer, TestCompareAndBranch) {
+    code_generator_initialize();
+
+    // Arrange
+    const bool wasOptimizing = optimizer;
+    optimizer = true;
+    auto &interpreter = Interpreter::instance();
+    interpreter.execute(": BRANCH-IMM 3 < IF 1 ELSE 2 THEN ;");
+    interpreter.execute(": BRANCH-CMP < IF 1 ELSE 0 THEN ;");
+    interpreter.execute(": BRANCH-ZERO 0= IF 7 ELSE 8 THEN ;");
+    interpreter.execute(": BRANCH-UNTIL 0 BEGIN 1 + DUP 10 = UNTIL ;");
+    interpreter.execute(": BRANCH-WHILE 0 BEGIN DUP 5 < WHILE 1 + REPEAT ;");
+    interpreter.execute(": BRANCH-FLOAT f< IF 1 ELSE 0 THEN ;");
+    optimizer = wasOptimizing;
+
+    // Act and Assert, a negative number is less than 3
+    interpreter.execute("1 BRANCH-IMM 5 BRANCH-IMM -5 BRANCH-IMM");
+    EXPECT_EQ(cpop(), 1);
+    EXPECT_EQ(cpop(), 2);
+    EXPECT_EQ(cpop(), 1);
+    interpreter.execute("2 3 BRANCH-CMP 3 2 BRANCH-CMP");
+    EXPECT_EQ(cpop(), 0);
+    EXPECT_EQ(cpop(), 1);
+    interpreter.execute("0 BRANCH-ZERO 4 BRANCH-ZERO");
+    EXPECT_EQ(cpop(), 8);
+    EXPECT_EQ(cpop(), 7);
+    interpreter.execute("BRANCH-UNTIL BRANCH-WHILE");
+    EXPECT_EQ(cpop(), 5);
+    EXPECT_EQ(cpop(), 10);
+    interpreter.execute("1.5 2.5 BRANCH-FLOAT 2.5 1.5 BRANCH-FLOAT");
+    EXPECT_EQ(cpop(), 0);
+    EXPECT_EQ(cpop(), 1);
+
+    const CompileStats *stats = CompilerStats::instance().find("BRANCH-IMM");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->rules[static_cast<size_t>(OptOp::IF_CMP_IMM)], 1u);
+}
+
+TEST(Optimizer, TestDivisionByConstant) {
+    code_generator_initialize();
+
+    // Arrange, the magic numbers match idiv and div
+    for (const int64_t d: std::initializer_list<int64_t>{3, 7, 10, 641, -3, -8, 1000000007, INT64_MAX, INT64_MIN}) {
+        for (const int64_t n: std::initializer_list<int64_t>{0, 1, -1, 99, -99, 123456789012, INT64_MAX, INT64_MIN + 1}) {
+            EXPECT_EQ(signed_quotient(n, d), n / d) << n << " / " << d;
+            EXPECT_EQ(unsigned_quotient(n, d), static_cast<uint64_t>(n) / static_cast<uint64_t>(d));
+        }
+    }
+
+    const bool wasOptimizing = optimizer;
+    optimizer = true;
+    auto &interpreter = Interpreter::instance();
+    interpreter.execute(": DIV-7 7 / ; : DIV-8 8 / ; : MOD-10 10 MOD ; : DIVMOD-3 3 /MOD ;");
+    interpreter.execute(": UDIV-10 10 U/ ; : UMOD-16 16 UMOD ; : SCALE-3 3 */ ;");
+    interpreter.execute(": UMOD-TOP 9223372036854775808 UMOD ;");
+    optimizer = wasOptimizing;
+
+    // Act and Assert, negative dividends round toward zero as / does
+    interpreter.execute("100 DIV-7 -100 DIV-7 -9 DIV-8");
+    EXPECT_EQ(cpop(), -1);
+    EXPECT_EQ(cpop(), -14);
+    EXPECT_EQ(cpop(), 14);
+    interpreter.execute("-47 MOD-10 17 DIVMOD-3");
+    EXPECT_EQ(cpop(), 2);
+    EXPECT_EQ(cpop(), 5);
+    EXPECT_EQ(cpop(), -7);
+    interpreter.execute("-1 UDIV-10 37 UMOD-16 10 4 SCALE-3");
+    EXPECT_EQ(cpop(), 13);
+    EXPECT_EQ(cpop(), 5);
+    EXPECT_EQ(cpop(), static_cast<int64_t>(UINT64_MAX / 10));
+    interpreter.execute("-1 UMOD-TOP");
+    EXPECT_EQ(cpop(), INT64_MAX);
+
+    const CompileStats *stats = CompilerStats::instance().find("MOD-10");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->rules[static_cast<size_t>(OptOp::MOD_IMM)], 1u);
+}
+
+TEST(Optimizer, TestVariablesInMemory) {
+    code_generator_initialize();
+
+    // Arrange
+    const bool wasOptimizing = optimizer;
+    optimizer = true;
+    auto &interpreter = Interpreter::instance();
+    interpreter.execute("VARIABLE COUNTER 0 COUNTER !");
+    interpreter.execute(": BUMP COUNTER @ 1 + COUNTER ! ; : LOWER COUNTER @ 2 - COUNTER ! ;");
+    interpreter.execute(": ADD-TEN 10 COUNTER +! ; : ADD-N COUNTER +! ; : ACCUMULATE COUNTER @ + COUNTER ! ;");
+    interpreter.execute(": PLUS-COUNTER COUNTER @ + ; : COUNTER? COUNTER @ IF 1 ELSE 0 THEN ;");
+    optimizer = wasOptimizing;
+
+    // Act and Assert
+    interpreter.execute("COUNTER? BUMP BUMP LOWER COUNTER?");
+    EXPECT_EQ(cpop(), 0);
+    EXPECT_EQ(cpop(), 0);
+    interpreter.execute("BUMP ADD-TEN 5 ADD-N 3 ACCUMULATE COUNTER @");
+    EXPECT_EQ(cpop(), 19);
+    interpreter.execute("1 PLUS-COUNTER COUNTER?");
+    EXPECT_EQ(cpop(), 1);
+    EXPECT_EQ(cpop(), 20);
+    interpreter.execute("-19 COUNTER +! COUNTER @");
+    EXPECT_EQ(cpop(), 0);
+
+    const CompileStats *stats = CompilerStats::instance().find("BUMP");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->rules[static_cast<size_t>(OptOp::LIT_VAR_PLUS_STORE)], 1u);
+}
+
+TEST(Optimizer, TestSelectWithoutBranches) {
+    code_generator_initialize();
+
+    // Arrange
+    const bool wasOptimizing = optimizer;
+    optimizer = true;
+    auto &interpreter = Interpreter::instance();
+    interpreter.execute(": SIGN-OF 0 < IF -1 ELSE 1 THEN ;");
+    interpreter.execute(": BIGGER 2DUP < IF NIP ELSE DROP THEN ;");
+    interpreter.execute(": COPY-ONE IF DUP ELSE OVER THEN ;");
+    optimizer = wasOptimizing;
+
+    // Act and Assert
+    interpreter.execute("-5 SIGN-OF 5 SIGN-OF");
+    EXPECT_EQ(cpop(), 1);
+    EXPECT_EQ(cpop(), -1);
+    interpreter.execute("3 9 BIGGER 9 3 BIGGER");
+    EXPECT_EQ(cpop(), 9);
+    EXPECT_EQ(cpop(), 9);
+    interpreter.execute("1 2 -1 COPY-ONE");
+    EXPECT_EQ(cpop(), 2);
+    EXPECT_EQ(cpop(), 2);
+    EXPECT_EQ(cpop(), 1);
+    interpreter.execute("1 2 0 COPY-ONE");
+    EXPECT_EQ(cpop(), 1);
+    EXPECT_EQ(cpop(), 2);
+    EXPECT_EQ(cpop(), 1);
+
+    interpreter.execute("3 7 MIN -3 7 MAX 15 0 10 CLAMP -5 0 10 CLAMP");
+    EXPECT_EQ(cpop(), 0);
+    EXPECT_EQ(cpop(), 10);
+    EXPECT_EQ(cpop(), 7);
+    EXPECT_EQ(cpop(), 3);
+    interpreter.execute("5 0 10 WITHIN 10 0 10 WITHIN -1 0 10 WITHIN");
+    EXPECT_EQ(cpop(), 0);
+    EXPECT_EQ(cpop(), 0);
+    EXPECT_EQ(cpop(), -1);
+
+    const CompileStats *stats = CompilerStats::instance().find("SIGN-OF");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->rules[static_cast<size_t>(OptOp::SELECT)], 1u);
+}
+
+TEST(Deferred, TestCallSitesFollowIS) {
+    code_generator_initialize();
+
+    // Arrange
+    auto &interpreter = Interpreter::instance();
+    interpreter.execute("DEFER HOOK");
+    interpreter.execute(": HOOK-ONE 1 ;");
+    interpreter.execute(": HOOK-TWO 2 ;");
+    interpreter.execute(": CALL-HOOK HOOK 10 + ;");
+    interpreter.execute(": SET-HOOK-ONE ['] HOOK-ONE IS HOOK ;");
+    const bool wasOptimizing = optimizer;
+    optimizer = true;
+    interpreter.execute(": RUN-TWO ['] HOOK-TWO EXEC ;");
+    interpreter.execute(": RUN-HOOK ['] HOOK EXEC ;");
+    optimizer = wasOptimizing;
+
+    // Act and Assert
+    interpreter.execute("' HOOK-TWO IS HOOK CALL-HOOK");
+    EXPECT_EQ(cpop(), 12);
+    interpreter.execute("SET-HOOK-ONE CALL-HOOK RUN-HOOK");
+    EXPECT_EQ(cpop(), 1);
+    EXPECT_EQ(cpop(), 11);
+    interpreter.execute("' HOOK EXEC RUN-TWO");
+    EXPECT_EQ(cpop(), 2);
+    EXPECT_EQ(cpop(), 1);
+
+    const CompileStats *stats = CompilerStats::instance().find("RUN-TWO");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->rules[static_cast<size_t>(OptOp::CALL_XT)], 1u);
+}
+
+TEST(Deferred, TestForgetDropsOwnSites) {
+    code_generator_initialize();
+
+    // Arrange
+    auto &interpreter = Interpreter::instance();
+    interpreter.execute("DEFER HOOK2");
+    interpreter.execute(": HOOK2-SEVEN 7 ;");
+    interpreter.execute(": KEEP-HOOK2 HOOK2 ;");
+    interpreter.execute(": A HOOK2 ;");
+    auto &dict = ForthDictionary::instance();
+    const DeferredWord *hook = DeferredWords::instance().deferred(dict.findWord("HOOK2"));
+    ASSERT_NE(hook, nullptr);
+    ASSERT_EQ(hook->sites.size(), 2u);
+    EXPECT_EQ(hook->sites[0].owner, dict.findWord("KEEP-HOOK2"));
+    EXPECT_EQ(hook->sites[1].owner, dict.findWord("A"));
+
+    // Act, the site in A goes with it, the one in KEEP-HOOK2 stays
+    interpreter.execute("FORGET");
+    interpreter.execute("' HOOK2-SEVEN IS HOOK2 KEEP-HOOK2");
+
+    // Assert
+    EXPECT_EQ(cpop(), 7);
+    ASSERT_EQ(hook->sites.size(), 1u);
+    EXPECT_EQ(hook->sites[0].owner, dict.findWord("KEEP-HOOK2"));
+}
+
+TEST(ScriptMode, TestIncludeFile) {
+    code_generator_initialize();
+
+    // Arrange
+    const std::string path = "/tmp/forthjit_include_test.fs";
+    FILE *f = fopen(path.c_str(), "w");
+    ASSERT_NE(f, nullptr);
+    fputs("\\ squares\n: sq ( n -- n*n )\n  dup * ;\n7 sq", f);
+    fclose(f);
+
+    // Act
+    ASSERT_TRUE(ScriptRunner::instance().includeFile(path));
+
+    // Assert
+    int64_t result = cpop();
+    EXPECT_EQ(result, 49);
+    std::remove(path.c_str());
+}
+
 
 
 // Main function for Google Test
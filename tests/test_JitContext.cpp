@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include "JitContext.h"
+#include <fstream>
+#include <unistd.h>
 
 // Test if JitContext initializes correctly
 TEST(JitContextTest, Initialization) {
@@ -14,6 +16,64 @@ TEST(JitContextTest, CodeHolderInitialization) {
     EXPECT_TRUE(codeHolder.isInitialized());
 }
 
+// Test that finalized functions are named in the perf map
+TEST(JitContextTest, PerfMapNamesFunctions) {
+    auto &jit = JitContext::instance();
+    ASSERT_TRUE(PerfMap::instance().setMap(true));
+    jit.initialize();
+    jit.setFunctionName("PERF-MAP-TEST");
+    jit.getAssembler().ret();
+    const auto fn = jit.finalize();
+    ASSERT_NE(fn, nullptr);
+    PerfMap::instance().setMap(false);
+
+    const std::string path = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+    std::ifstream map(path);
+    std::string line;
+    bool found = false;
+    while (std::getline(map, line)) {
+        found = found || line.find(" PERF-MAP-TEST") != std::string::npos;
+    }
+    EXPECT_TRUE(found);
+    std::remove(path.c_str());
+}
+
+// Test that addresses inside a finalized function map back to its name
+TEST(JitContextTest, CodeIndexFindsFunction) {
+    auto &jit = JitContext::instance();
+    jit.initialize();
+    jit.setFunctionName("CODE-INDEX-TEST");
+    jit.getAssembler().nop();
+    jit.getAssembler().ret();
+    const auto fn = jit.finalize();
+    ASSERT_NE(fn, nullptr);
+
+    const auto start = reinterpret_cast<uintptr_t>(fn);
+    const auto *range = CodeIndex::instance().find(start + 1);
+    ASSERT_NE(range, nullptr);
+    EXPECT_EQ(range->name, "CODE-INDEX-TEST");
+    EXPECT_EQ(range->start, start);
+}
+
+TEST(JitContextTest, ListingKeepsOffsets) {
+    auto &jit = JitContext::instance();
+    jit.initialize();
+    jit.enableListing(false);
+    jit.getAssembler().comment("; listing test");
+    jit.getAssembler().nop();
+    jit.getAssembler().ret();
+    const auto fn = jit.finalize();
+    jit.disableLogging();
+    ASSERT_NE(fn, nullptr);
+
+    const auto *lines = CodeListing::instance().find(reinterpret_cast<const void *>(fn));
+    ASSERT_NE(lines, nullptr);
+    ASSERT_EQ(lines->size(), 3u);
+    EXPECT_EQ((*lines)[0].text, "; listing test");
+    EXPECT_EQ((*lines)[1].offset, 0u);
+    EXPECT_EQ((*lines)[2].offset, 1u); // after the one byte nop
+}
+
 
 
 // Main function for Google Test
@@ -8,10 +8,12 @@
 #include <cmath>
 #include "CodeGenerator.h"
 #include "Optimizer.h"
+#include "ForthDictionary.h"
+#include "SignalHandler.h"
 
 // Helper to create a tokenizer and tokenize input
-std::deque<ForthToken> tokenizeInput(const std::string &input) {
-    std::deque<ForthToken> tokens;
+TokenStream tokenizeInput(const std::string &input) {
+    TokenStream tokens;
     Tokenizer::instance().tokenize_forth(input, tokens);
     return tokens;
 }
@@ -65,6 +67,57 @@ TEST(TokenizerTests, TokenizeFloats) {
     EXPECT_EQ(tokens[3].type, TOKEN_END);
 }
 
+// Number prefixes, character literals, doubles and BASE
+TEST(TokenizerTests, TokenizeNumberForms) {
+    code_generator_initialize();
+    std::string input = "$FF #99 %101 'a' 123. -7. $-10 12AB";
+    auto tokens = tokenizeInput(input);
+    ASSERT_EQ(tokens.size(), 9);
+    EXPECT_EQ(tokens[0].int_value, 255);
+    EXPECT_EQ(tokens[1].int_value, 99);
+    EXPECT_EQ(tokens[2].int_value, 5);
+    EXPECT_EQ(tokens[3].type, TOKEN_NUMBER);
+    EXPECT_EQ(tokens[3].int_value, 'a');
+    EXPECT_EQ(tokens[4].type, TOKEN_DOUBLE);
+    EXPECT_EQ(tokens[4].int_value, 123);
+    EXPECT_EQ(tokens[5].type, TOKEN_DOUBLE);
+    EXPECT_EQ(static_cast<int64_t>(tokens[5].int_value), -7);
+    EXPECT_EQ(static_cast<int64_t>(tokens[6].int_value), -16);
+    EXPECT_EQ(tokens[7].type, TOKEN_UNKNOWN);
+
+    // the same text read in hex
+    Tokenizer::classify_number(tokens[7], 16);
+    EXPECT_EQ(tokens[7].type, TOKEN_NUMBER);
+    EXPECT_EQ(tokens[7].int_value, 0x12AB);
+    ForthToken exponent(TOKEN_UNKNOWN, "1E5");
+    Tokenizer::classify_number(exponent, 16);
+    EXPECT_EQ(exponent.int_value, 0x1E5);
+}
+
+// a new word's name is never a number, and numbers too large for a cell are an error
+TEST(TokenizerTests, TokenizeNamesAndRange) {
+    code_generator_initialize();
+    auto *base = static_cast<int64_t *>(ForthDictionary::instance().findWord("BASE")->data);
+    *base = 16;
+    auto tokens = tokenizeInput(": FACE VARIABLE ABC FACE");
+    *base = 10;
+    ASSERT_EQ(tokens.size(), 6);
+    EXPECT_EQ(tokens[1].type, TOKEN_UNKNOWN);
+    EXPECT_EQ(tokens[3].type, TOKEN_UNKNOWN);
+    EXPECT_EQ(tokens[4].type, TOKEN_NUMBER);
+    EXPECT_EQ(tokens[4].int_value, 0xFACE);
+
+    tokens = tokenizeInput("18446744073709551615 10.");
+    EXPECT_EQ(tokens[0].int_value, UINT64_MAX);
+    EXPECT_EQ(tokens[1].type, TOKEN_DOUBLE);
+    volatile bool raised = true;
+    if (setjmp(SignalHandler::instance().get_jump_buffer()) == 0) {
+        tokenizeInput("18446744073709551616");
+        raised = false;
+    }
+    EXPECT_TRUE(raised);
+}
+
 // Test 4: Code constructs
 TEST(TokenizerTests, TokenizeProgrammingConstructs) {
     code_generator_initialize();
@@ -101,6 +154,26 @@ TEST(TokenizerTests, TokenizeStringLiterals) {
     EXPECT_EQ(tokens[4].type, TOKEN_END);
 }
 
+// Tokens are views of the source, and a cleared stream keeps its storage
+TEST(TokenizerTests, TokensViewTheSource) {
+    code_generator_initialize();
+    std::string input = "DUP .\" hello\" 42";
+    TokenStream tokens;
+    Tokenizer::instance().tokenize_forth(input, tokens);
+    ASSERT_EQ(tokens.size(), 5);
+    EXPECT_EQ(tokens[0].value.data(), input.data());
+    EXPECT_EQ(tokens[2].value, "hello");
+    EXPECT_EQ(tokens[2].value.data(), input.data() + 7);
+    EXPECT_EQ(tokens[3].int_value, 42);
+
+    tokens.pop_front();
+    EXPECT_EQ(tokens.front().value, ".\"");
+    const ForthToken *storage = &tokens.front();
+    Tokenizer::instance().tokenize_forth(input, tokens);
+    EXPECT_EQ(tokens.size(), 5);
+    EXPECT_EQ(&tokens[1], storage);
+}
+
 // Test 7: Handle empty input
 TEST(TokenizerTests, HandleEmptyInput) {
     code_generator_initialize();
@@ -129,48 +202,48 @@ TEST(TokenizerTests, HandleWhitespaces) {
 // Test constant folding optimization
 TEST(OptimizerTest, ConstantFolding_Addition) {
     code_generator_initialize();
-    std::deque<ForthToken> tokens = {
+    TokenStream tokens = {
         ForthToken{TOKEN_NUMBER, 10},
         ForthToken{TOKEN_WORD, "+", 0}
     };
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream optimized_tokens;
 
     Optimizer::instance().optimize(tokens, optimized_tokens);
     std::cout << "Tokens size: " << tokens.size() << std::endl;
     std::cout << "Optimized Tokens size: " << optimized_tokens.size() << std::endl;
     ASSERT_EQ(optimized_tokens.size(), 2);
     EXPECT_EQ(optimized_tokens[0].type, TOKEN_OPTIMIZED);
-    EXPECT_EQ(optimized_tokens[0].optimized_op, "ADD_IMM");
+    EXPECT_EQ(optimized_tokens[0].op, OptOp::ADD_IMM);
     EXPECT_EQ(optimized_tokens[0].int_value, 10);
 }
 
 // Test strength reduction for multiplication by power of 2
 TEST(OptimizerTest, StrengthReduction_Multiplication) {
     code_generator_initialize();
-    std::deque<ForthToken> tokens = {
+    TokenStream tokens = {
         ForthToken(TOKEN_NUMBER, 4),
         ForthToken(TOKEN_WORD, "*", 0)
     };
     std::cout << "Tokens size: " << tokens.size() << std::endl;
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream optimized_tokens;
     Tokenizer::instance().print_token_list(tokens);
     Optimizer::instance().optimize(tokens, optimized_tokens);
     Tokenizer::instance().print_token_list(optimized_tokens);
     std::cout << "Optimized Tokens size: " << optimized_tokens.size() << std::endl;
     ASSERT_EQ(optimized_tokens.size(), 2);
     EXPECT_EQ(optimized_tokens[0].type, TOKEN_OPTIMIZED);
-    EXPECT_EQ(optimized_tokens[0].optimized_op, "SHL_IMM");
-    EXPECT_EQ(optimized_tokens[0].opt_value, 2);
+    EXPECT_EQ(optimized_tokens[0].op, OptOp::SHL_IMM);
+    EXPECT_EQ(optimized_tokens[0].int_value, 2);
 }
 
 TEST(OptimizerTest, StrengthReduction_Division) {
     code_generator_initialize();
-    std::deque<ForthToken> tokens = {
+    TokenStream tokens = {
         ForthToken(TOKEN_NUMBER, 8),
         ForthToken(TOKEN_WORD, "/", 0)
     };
 
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream optimized_tokens;
 
     Tokenizer::instance().print_token_list(tokens);
     Optimizer::instance().optimize(tokens, optimized_tokens);
@@ -178,18 +251,18 @@ TEST(OptimizerTest, StrengthReduction_Division) {
     std::cout << "Optimized Tokens size: " << optimized_tokens.size() << std::endl;
     ASSERT_EQ(optimized_tokens.size(), 2);
     EXPECT_EQ(optimized_tokens[0].type, TOKEN_OPTIMIZED);
-    EXPECT_EQ(optimized_tokens[0].optimized_op, "SHR_IMM");
-    EXPECT_EQ(optimized_tokens[0].opt_value, 3); // 8 is 2^3
+    EXPECT_EQ(optimized_tokens[0].op, OptOp::SHR_IMM);
+    EXPECT_EQ(optimized_tokens[0].int_value, 3); // 8 is 2^3
 }
 
 TEST(OptimizerTest, Multiplication_ByNonPowerOf2) {
     code_generator_initialize();
-    std::deque<ForthToken> tokens = {
+    TokenStream tokens = {
         ForthToken(TOKEN_NUMBER, 6),
         ForthToken(TOKEN_WORD, "*", 0)
     };
 
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream optimized_tokens;
 
     Tokenizer::instance().print_token_list(tokens);
     Optimizer::instance().optimize(tokens, optimized_tokens);
@@ -197,30 +270,30 @@ TEST(OptimizerTest, Multiplication_ByNonPowerOf2) {
     std::cout << "Optimized Tokens size: " << optimized_tokens.size() << std::endl;
     ASSERT_EQ(optimized_tokens.size(), 2);
     EXPECT_EQ(optimized_tokens[0].type, TOKEN_OPTIMIZED);
-    EXPECT_EQ(optimized_tokens[0].optimized_op, "MUL_IMM");
-    EXPECT_EQ(optimized_tokens[0].opt_value, 6);
+    EXPECT_EQ(optimized_tokens[0].op, OptOp::MUL_IMM);
+    EXPECT_EQ(optimized_tokens[0].int_value, 6);
 }
 
 TEST(OptimizerTest, DivisionByZero) {
     code_generator_initialize();
-    std::deque<ForthToken> tokens = {
+    TokenStream tokens = {
         ForthToken(TOKEN_NUMBER, 0),
         ForthToken(TOKEN_WORD, "/", 0)
     };
 
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream optimized_tokens;
 
     EXPECT_THROW(Optimizer::instance().optimize(tokens, optimized_tokens);, std::runtime_error);
 }
 
 TEST(OptimizerTest, Addition_WithZero) {
     code_generator_initialize();
-    std::deque<ForthToken> tokens = {
+    TokenStream tokens = {
         ForthToken(TOKEN_NUMBER, 0),
         ForthToken(TOKEN_WORD, "+", 0)
     };
 
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream optimized_tokens;
 
     Tokenizer::instance().print_token_list(tokens);
     Optimizer::instance().optimize(tokens, optimized_tokens);
@@ -228,18 +301,18 @@ TEST(OptimizerTest, Addition_WithZero) {
     std::cout << "Optimized Tokens size: " << optimized_tokens.size() << std::endl;
     ASSERT_EQ(optimized_tokens.size(), 2);
     EXPECT_EQ(optimized_tokens[0].type, TOKEN_OPTIMIZED);
-    EXPECT_EQ(optimized_tokens[0].optimized_op, "ADD_IMM");
-    EXPECT_EQ(optimized_tokens[0].opt_value, 0);
+    EXPECT_EQ(optimized_tokens[0].op, OptOp::ADD_IMM);
+    EXPECT_EQ(optimized_tokens[0].int_value, 0);
 }
 
 
 TEST(OptimizerTest, PeepholeOptimization_DupPlus) {
-    std::deque<ForthToken> tokens = {
+    TokenStream tokens = {
         ForthToken(TOKEN_WORD, "DUP", 0),
         ForthToken(TOKEN_WORD, "+", 0)
     };
 
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream optimized_tokens;
 
     Tokenizer::instance().print_token_list(tokens);
     Optimizer::instance().optimize(tokens, optimized_tokens);
@@ -247,14 +320,14 @@ TEST(OptimizerTest, PeepholeOptimization_DupPlus) {
     std::cout << "Optimized Tokens size: " << optimized_tokens.size() << std::endl;
     ASSERT_EQ(optimized_tokens.size(), 2);
     EXPECT_EQ(optimized_tokens[0].type, TOKEN_OPTIMIZED);
-    EXPECT_EQ(optimized_tokens[0].optimized_op, "LEA_TOS");
-    EXPECT_EQ(optimized_tokens[0].opt_value, 0);
+    EXPECT_EQ(optimized_tokens[0].op, OptOp::LEA_TOS);
+    EXPECT_EQ(optimized_tokens[0].int_value, 0);
 }
 
 
 TEST(OptimizerTest, EmptyInput) {
-    std::deque<ForthToken> tokens = {};
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream tokens = {};
+    TokenStream optimized_tokens;
 
     Tokenizer::instance().print_token_list(tokens);
     Optimizer::instance().optimize(tokens, optimized_tokens);
@@ -265,12 +338,12 @@ TEST(OptimizerTest, EmptyInput) {
 }
 
 TEST(OptimizerTest, Division_ByNonPowerOf2) {
-    std::deque<ForthToken> tokens = {
+    TokenStream tokens = {
         ForthToken(TOKEN_NUMBER, 7),
         ForthToken(TOKEN_WORD, "/", 0)
     };
 
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream optimized_tokens;
 
     Tokenizer::instance().instance().print_token_list(tokens);
     Optimizer::instance().optimize(tokens, optimized_tokens);
@@ -278,18 +351,18 @@ TEST(OptimizerTest, Division_ByNonPowerOf2) {
     std::cout << "Optimized Tokens size: " << optimized_tokens.size() << std::endl;
     ASSERT_EQ(optimized_tokens.size(), 2);
     EXPECT_EQ(optimized_tokens[0].type, TOKEN_OPTIMIZED);
-    EXPECT_EQ(optimized_tokens[0].optimized_op, "DIV_IMM");
-    EXPECT_EQ(optimized_tokens[0].opt_value, 7);
+    EXPECT_EQ(optimized_tokens[0].op, OptOp::DIV_IMM);
+    EXPECT_EQ(optimized_tokens[0].int_value, 7);
 }
 
 
 TEST(OptimizerTest, NoPeepholeMatched) {
-    std::deque<ForthToken> tokens = {
+    TokenStream tokens = {
         ForthToken(TOKEN_WORD, "ROT", 0),
         ForthToken(TOKEN_WORD, "NIP", 0)
     };
 
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream optimized_tokens;
 
     Tokenizer::instance().print_token_list(tokens);
     Optimizer::instance().optimize(tokens, optimized_tokens);
@@ -303,11 +376,11 @@ TEST(OptimizerTest, NoPeepholeMatched) {
 
 // Test redundant operations like SWAP DROP
 TEST(OptimizerTest, PeepholeOptimization_SwapDrop) {
-    std::deque<ForthToken> tokens = {
+    TokenStream tokens = {
         ForthToken(TOKEN_WORD, "SWAP", 0),
         ForthToken(TOKEN_WORD, "DROP", 0)
     };
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream optimized_tokens;
 
     Tokenizer::instance().print_token_list(tokens);
     Optimizer::instance().optimize(tokens, optimized_tokens);
@@ -315,16 +388,16 @@ TEST(OptimizerTest, PeepholeOptimization_SwapDrop) {
     std::cout << "Optimized Tokens size: " << optimized_tokens.size() << std::endl;
     ASSERT_EQ(optimized_tokens.size(), 2);
     EXPECT_EQ(optimized_tokens[0].type, TOKEN_OPTIMIZED);
-    EXPECT_EQ(optimized_tokens[0].optimized_op, "MOV_TOS_1");
+    EXPECT_EQ(optimized_tokens[0].op, OptOp::MOV_TOS_1);
 }
 
 // Test that unrelated tokens are left unchanged
 TEST(OptimizerTest, NoOptimizationNeeded) {
-    std::deque<ForthToken> tokens = {
+    TokenStream tokens = {
         {TOKEN_WORD, "DUP", 0},
         {TOKEN_WORD, "!", 0}
     };
-    std::deque<ForthToken> optimized_tokens;
+    TokenStream optimized_tokens;
 
     Tokenizer::instance().print_token_list(tokens);
     Optimizer::instance().optimize(tokens, optimized_tokens);